@@ -14,6 +14,8 @@ namespace General {
   std::filesystem::path outputDirectory;
   bool anonymizeOutput;
   std::vector<std::shared_ptr<IInputFile>> inputFiles;
+  bool optimizePexFiles{ false };
+  bool disassemblePexFiles{ false };
   }
 
   namespace PCompiler {
@@ -28,6 +30,8 @@ namespace CodeGeneration {
   bool disableDebugCode{ false };
   bool enableCKOptimizations{ false };
   bool enableOptimizations{ false };
+  bool enableInlining{ false };
+  bool enableCollectionCountHoisting{ false };
   bool emitDebugInfo{ false };
 }
 
@@ -75,8 +79,10 @@ namespace Performance {
   bool asyncFileRead{ false };
   bool asyncFileWrite{ false };
   bool dumpTiming{ false };
+  size_t memoryBudget{ 0 };
   bool performanceTestMode{ false };
   bool resolveSymlinks{ false };
+  bool useLargePages{ false };
 }
 
 namespace Warnings {
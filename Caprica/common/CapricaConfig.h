@@ -28,6 +28,12 @@ namespace General {
   extern bool anonymizeOutput;
   // input files
   extern std::vector<std::shared_ptr<IInputFile>> inputFiles;
+  // If true, the input files are compiled Pex files that get optimized and
+  // written back out, rather than scripts to compile.
+  extern bool optimizePexFiles;
+  // If true, the input files are compiled Pex files that get disassembled,
+  // rather than scripts to compile.
+  extern bool disassemblePexFiles;
 }
 
 // options related to compatibility with PCompiler's CLI parsing and name resolution
@@ -50,6 +56,14 @@ namespace CodeGeneration {
   // Enable optimizations normally enabled by the -optimize switch to the
   // CK compiler.
   extern bool enableOptimizations;
+  // Inline calls to small global functions of the same script. Only takes
+  // effect when optimizations are enabled.
+  extern bool enableInlining;
+  // Hoist the GetCount/GetSize call out of loops over a collection that the
+  // loop itself never passes anywhere. Only takes effect when optimizations
+  // are enabled, and isn't safe if something else the loop calls changes
+  // the collection.
+  extern bool enableCollectionCountHoisting;
   // If true, emit debug info for the papyrus script.
   extern bool emitDebugInfo;
 }
@@ -145,6 +159,9 @@ namespace Performance {
   extern bool asyncFileWrite;
   // If true, output timing stats.
   extern bool dumpTiming;
+  // If not 0, the number of megabytes the files being compiled at once
+  // should roughly stay under.
+  extern size_t memoryBudget;
   // If true, we pause and wait for all files to be read in before
   // compiling them, and we also don't write them out to disk.
   // This is done to increase the consistency of the test runs.
@@ -152,6 +169,8 @@ namespace Performance {
   // If true, resolve symlinks while building canonical
   // paths.
   extern bool resolveSymlinks;
+  // If true, try to back the biggest heaps with large pages.
+  extern bool useLargePages;
 }
 
 // Options related to warnings.
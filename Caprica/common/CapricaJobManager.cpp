@@ -1,9 +1,42 @@
 #include <common/CapricaJobManager.h>
 
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include <common/allocators/AtomicChainedPool.h>
 #include <common/CapricaReportingContext.h>
 
 namespace caprica {
 
+static allocators::AtomicChainedPool functionJobAllocator { 1024 * 64 };
+
+CapricaFunctionJob* CapricaFunctionJob::make(std::function<void()>&& func) {
+  // The pool doesn't align anything, so every job takes up a multiple of
+  // the alignment it needs.
+  constexpr size_t JobSize = (sizeof(CapricaFunctionJob) + alignof(std::max_align_t) - 1) &
+                             ~(alignof(std::max_align_t) - 1);
+  auto buf = functionJobAllocator.allocate(JobSize);
+  return new (buf) CapricaFunctionJob(std::move(func));
+}
+
+void CapricaFunctionJob::awaitResult() {
+  await();
+  if (exception)
+    std::rethrow_exception(std::exchange(exception, nullptr));
+}
+
+void CapricaFunctionJob::run() {
+  // Let go of whatever the function captured as soon as it's done.
+  auto f = std::move(func);
+  func = nullptr;
+  try {
+    f();
+  } catch (...) {
+    exception = std::current_exception();
+  }
+}
+
 void CapricaJob::await() {
   if (!tryRun()) {
     std::unique_lock<std::mutex> ranLock { ranMutex };
@@ -49,33 +82,39 @@ void CapricaJobManager::awaitShutdown() {
 }
 
 bool CapricaJobManager::tryDeque(CapricaJob** retJob) {
-  auto fron = front.load(std::memory_order_consume);
-  if (!fron)
-    return false;
-  auto next = fron->next.load(std::memory_order_acquire);
-  if (next != nullptr) {
-    while (!front.compare_exchange_weak(fron, next)) {
-      if (fron == nullptr) {
-        // We weren't the ones to put the nullptr there,
-        // exit early so that the thread that did put it
-        // there can safely put it back.
-        return false;
+  while (true) {
+    auto fron = front.load(std::memory_order_consume);
+    if (!fron)
+      return false;
+    auto next = fron->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      while (!front.compare_exchange_weak(fron, next)) {
+        if (fron == nullptr) {
+          // We weren't the ones to put the nullptr there,
+          // exit early so that the thread that did put it
+          // there can safely put it back.
+          return false;
+        }
+        next = fron->next.load(std::memory_order_acquire);
+      }
+      if (next == nullptr) {
+        // We can only have managed to do this ourselves, nothing else will write
+        // while front is still nullptr.
+        front.compare_exchange_strong(next, fron);
+      } else {
+        queuedItemCount--;
       }
-      next = fron->next.load(std::memory_order_acquire);
     }
-    if (next == nullptr) {
-      // We can only have managed to do this ourselves, nothing else will write
-      // while front is still nullptr.
-      front.compare_exchange_strong(next, fron);
-    } else {
-      queuedItemCount--;
+    if (!fron->hasRan.load(std::memory_order_consume)) {
+      *retJob = fron;
+      return true;
     }
+    // The job we stepped past was already run by something awaiting it.
+    // Keep going, otherwise the rest of the queue would be left stranded
+    // once queuedItemCount reaches zero.
+    if (next == nullptr)
+      return false;
   }
-  if (!fron->hasRan.load(std::memory_order_consume)) {
-    *retJob = fron;
-    return true;
-  }
-  return false;
 }
 
 void CapricaJobManager::queueJob(CapricaJob* job) {
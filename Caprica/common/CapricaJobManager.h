@@ -4,6 +4,8 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <exception>
+#include <functional>
 #include <mutex>
 #include <thread>
 
@@ -35,6 +37,25 @@ private:
   bool tryRun();
 };
 
+// Runs a function, so that a job can split its own work up between the
+// workers. The queue can still refer to a job after it has run, so these are
+// never freed.
+struct CapricaFunctionJob final : public CapricaJob {
+  static CapricaFunctionJob* make(std::function<void()>&& func);
+
+  // Waits for the function to have run, and rethrows anything it threw.
+  void awaitResult();
+
+protected:
+  virtual void run() override;
+
+private:
+  std::function<void()> func;
+  std::exception_ptr exception {};
+
+  explicit CapricaFunctionJob(std::function<void()>&& f) : func(std::move(f)) { }
+};
+
 struct CapricaJobManager final {
   void startup(size_t workerCount);
   // Wait for all workers to shutdown
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <atomic>
+
 namespace caprica {
 
+// Function bodies can be resolved in parallel, and they all mark what they
+// reference.
 struct CapricaReferenceState final {
-  bool isInitialized { false };
-  bool isRead { false };
-  bool isWritten { false };
+  std::atomic<bool> isInitialized { false };
+  std::atomic<bool> isRead { false };
+  std::atomic<bool> isWritten { false };
 };
 
 }
@@ -10,7 +10,21 @@
 
 namespace caprica {
 
+thread_local CapricaReportingContext::DeferredMessages* CapricaReportingContext::currentDeferredMessages {
+  nullptr
+};
+
+void CapricaReportingContext::DeferredMessages::report() {
+  for (auto& m : messages)
+    pushToErrorStream(std::move(m.first), m.second);
+  messages.clear();
+}
+
 void CapricaReportingContext::pushToErrorStream(std::string&& msg, bool isError) {
+  if (currentDeferredMessages) {
+    currentDeferredMessages->messages.emplace_back(std::move(msg), isError);
+    return;
+  }
   if (!conf::Performance::performanceTestMode || isError) {
     std::cout.flush();
     std::cerr << msg << std::endl;
@@ -24,7 +38,7 @@ void CapricaReportingContext::breakIfDebugging() {
 
 void CapricaReportingContext::exitIfErrors() {
   if (errorCount > 0) {
-    pushToErrorStream(fmt::format("Compilation of '{}' failed; {} warnings and {} errors were encountered.", filename, warningCount, errorCount));
+    pushToErrorStream(fmt::format("Compilation of '{}' failed; {} warnings and {} errors were encountered.", filename, warningCount.load(), errorCount.load()));
     throw std::runtime_error("");
   }
 }
@@ -2,10 +2,12 @@
 
 #include <cstdint>
 
+#include <atomic>
 #include <memory>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <fmt/format.h>
@@ -21,8 +23,33 @@ struct CapricaReportingContext final {
   std::string filename;
   // TODO: fix Imports hack
   bool m_QuietWarnings { false };
-  size_t warningCount { 0 };
-  size_t errorCount { 0 };
+  std::atomic<size_t> warningCount { 0 };
+  std::atomic<size_t> errorCount { 0 };
+
+  // Holds back what gets reported on a thread, so that work split up between
+  // threads can still be reported in the order it would have been done in.
+  struct DeferredMessages final {
+    // Runs func, holding back everything it reports on this thread.
+    template <typename F>
+    void capture(F&& func) {
+      auto prev = currentDeferredMessages;
+      currentDeferredMessages = this;
+      try {
+        func();
+      } catch (...) {
+        currentDeferredMessages = prev;
+        throw;
+      }
+      currentDeferredMessages = prev;
+    }
+
+    // Reports everything held back so far, in the order it was reported.
+    void report();
+
+  private:
+    friend CapricaReportingContext;
+    std::vector<std::pair<std::string, bool>> messages {};
+  };
 
   CapricaReportingContext() = delete;
   CapricaReportingContext(const CapricaReportingContext& other) = delete;
@@ -318,6 +345,7 @@ struct CapricaReportingContext final {
 
 private:
   allocators::FileOffsetPool lineOffsets {};
+  static thread_local DeferredMessages* currentDeferredMessages;
 
   NEVER_INLINE
   static void pushToErrorStream(std::string&& msg, bool isError = false);
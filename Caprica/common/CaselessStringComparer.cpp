@@ -37,6 +37,14 @@ bool caselessEq(std::string_view a, std::string_view b) {
   return true;
 }
 
+bool isPrintableAscii(std::string_view str) {
+  for (auto c : str) {
+    if (c < 0x20 || c > 0x7E)
+      return false;
+  }
+  return true;
+}
+
 bool pathEq(std::string_view a, std::string_view b) {
   // TODO: Ensure in lower-ascii range.
   return caselessEq(a, b);
@@ -18,6 +18,9 @@ void identifierToLower(char* data, size_t size);
 void identifierToLower(std::string& str);
 
 bool caselessEq(std::string_view a, std::string_view b);
+// caselessEq only has a case mapping for the printable ascii range, so
+// anything outside of it is up to the VM.
+bool isPrintableAscii(std::string_view str);
 bool pathEq(std::string_view a, std::string_view b);
 bool pathEq(std::string_view a, const identifier_ref& b);
 bool pathEq(const identifier_ref& a, const identifier_ref& b);
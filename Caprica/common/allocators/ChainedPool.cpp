@@ -1,5 +1,6 @@
 #include <common/allocators/ChainedPool.h>
 
+#include <common/allocators/HeapCache.h>
 #include <common/CapricaReportingContext.h>
 #include <common/CapricaStats.h>
 
@@ -15,7 +16,7 @@ ChainedPool::~ChainedPool() {
 
 ChainedPool::Heap::Heap(size_t heapSize) : allocedHeapSize(heapSize), freeBytes(heapSize) {
   CapricaStats::allocatedHeapCount++;
-  baseAlloc = malloc(heapSize);
+  baseAlloc = HeapCache::allocate(heapSize);
   if (!baseAlloc)
     CapricaReportingContext::logicalFatal("Failed to allocate a Heap!");
 }
@@ -23,7 +24,7 @@ ChainedPool::Heap::Heap(size_t heapSize) : allocedHeapSize(heapSize), freeBytes(
 ChainedPool::Heap::~Heap() {
   if (baseAlloc) {
     CapricaStats::freedHeapCount++;
-    free(baseAlloc);
+    HeapCache::free(baseAlloc, allocedHeapSize);
     baseAlloc = nullptr;
   }
 
@@ -60,9 +61,20 @@ ChainedPool::HeapIterator& ChainedPool::HeapIterator::operator++() {
   return *this;
 }
 
+size_t ChainedPool::nextHeapSize() const {
+  // Pools that grow big move on to the size classes, which means fewer heaps,
+  // that get reused once the pool is done with them.
+  if (totalSize > HeapCache::LargeHeapSize && heapSize < HeapCache::LargeHeapSize)
+    return HeapCache::LargeHeapSize;
+  if (totalSize > HeapCache::MediumHeapSize && heapSize < HeapCache::MediumHeapSize)
+    return HeapCache::MediumHeapSize;
+  return heapSize;
+}
+
 char* ChainedPool::allocate(size_t size) {
   totalSize += size;
-  if (size > heapSize)
+  auto newHeapSize = nextHeapSize();
+  if (size > newHeapSize)
     return (char*)allocHeap(size, size);
 Again:
   void* ret = nullptr;
@@ -71,7 +83,7 @@ Again:
       current = current->next;
       goto Again;
     }
-    auto alloced = allocHeap(heapSize, size);
+    auto alloced = allocHeap(newHeapSize, size);
     if (current->next != nullptr)
       current = current->next;
     return (char*)alloced;
@@ -117,6 +129,7 @@ void ChainedPool::reset() {
     rootDestructorChain = nullptr;
     currentDestructorNode = nullptr;
   }
+  totalSize = 0;
 
   current = &base;
   auto c = current;
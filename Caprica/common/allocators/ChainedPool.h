@@ -91,6 +91,7 @@ protected:
   DestructionNode* rootDestructorChain { nullptr };
   DestructionNode* currentDestructorNode { nullptr };
 
+  size_t nextHeapSize() const;
   void* allocHeap(size_t newHeapSize, size_t firstAllocSize);
 
 public:
@@ -0,0 +1,113 @@
+#include <common/allocators/HeapCache.h>
+
+#include <atomic>
+
+#include <Windows.h>
+
+#include <common/CapricaConfig.h>
+
+namespace caprica { namespace allocators {
+
+namespace {
+// How much of each size class a thread holds on to at most.
+static constexpr size_t MaxCachedBytesPerSizeClass = 32 * 1024 * 1024;
+
+struct FreeHeap final {
+  FreeHeap* next;
+};
+
+struct SizeClassCache final {
+  FreeHeap* freeList;
+  size_t count;
+
+  void* tryPop() {
+    auto hp = freeList;
+    if (hp) {
+      freeList = hp->next;
+      count--;
+    }
+    return hp;
+  }
+
+  bool tryPush(void* buf, size_t heapSize) {
+    if (count * heapSize >= MaxCachedBytesPerSizeClass)
+      return false;
+    auto hp = (FreeHeap*)buf;
+    hp->next = freeList;
+    freeList = hp;
+    count++;
+    return true;
+  }
+};
+}
+
+// These are never destroyed, so that pools freed during shutdown don't
+// touch a cache that's already gone. Whatever is cached when a thread exits
+// goes with the process.
+static thread_local SizeClassCache mediumHeaps {};
+static thread_local SizeClassCache largeHeaps {};
+static std::atomic<bool> largePagesUnavailable { false };
+
+// The large heaps always come straight from the OS, so that they can be
+// backed by large pages when allowed to.
+static void* allocateLargeHeap() {
+  if (conf::Performance::useLargePages && !largePagesUnavailable.load(std::memory_order_relaxed)) {
+    auto minSize = GetLargePageMinimum();
+    if (minSize != 0 && HeapCache::LargeHeapSize % minSize == 0) {
+      auto buf = VirtualAlloc(nullptr,
+                              HeapCache::LargeHeapSize,
+                              MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                              PAGE_READWRITE);
+      if (buf)
+        return buf;
+    }
+    // Memory has gotten too fragmented to find enough contiguous physical
+    // pages, which isn't likely to get any better.
+    largePagesUnavailable.store(true, std::memory_order_relaxed);
+  }
+  return VirtualAlloc(nullptr, HeapCache::LargeHeapSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+bool HeapCache::enableLargePages() {
+  if (GetLargePageMinimum() == 0)
+    return false;
+  HANDLE token;
+  if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+    return false;
+  TOKEN_PRIVILEGES privileges {};
+  privileges.PrivilegeCount = 1;
+  privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+  // AdjustTokenPrivileges succeeds even when the account doesn't hold the
+  // privilege, and only says so through the last error.
+  bool enabled = LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+                 AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+                 GetLastError() == ERROR_SUCCESS;
+  CloseHandle(token);
+  return enabled;
+}
+
+void* HeapCache::allocate(size_t size) {
+  if (size == MediumHeapSize) {
+    if (auto buf = mediumHeaps.tryPop())
+      return buf;
+  } else if (size == LargeHeapSize) {
+    if (auto buf = largeHeaps.tryPop())
+      return buf;
+    return allocateLargeHeap();
+  }
+  return malloc(size);
+}
+
+void HeapCache::free(void* buf, size_t size) {
+  if (size == MediumHeapSize) {
+    if (mediumHeaps.tryPush(buf, size))
+      return;
+  } else if (size == LargeHeapSize) {
+    if (!largeHeaps.tryPush(buf, size))
+      VirtualFree(buf, 0, MEM_RELEASE);
+    return;
+  }
+  ::free(buf);
+}
+
+}}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdlib.h>
+
+namespace caprica { namespace allocators {
+
+// Where the heaps of the pools come from. Heaps of one of the size classes
+// are kept by the thread that freed them, so that the pools of the next file
+// compiled on it reuse them rather than going back to the system allocator.
+struct HeapCache final {
+  static constexpr size_t MediumHeapSize = 64 * 1024;
+  static constexpr size_t LargeHeapSize = 2 * 1024 * 1024;
+
+  // Large pages can only be allocated once the process has been granted the
+  // privilege to lock pages in memory. Returns false if it wasn't.
+  static bool enableLargePages();
+
+  static void* allocate(size_t size);
+  static void free(void* buf, size_t size);
+};
+
+}}
@@ -13,6 +13,13 @@ size_t ReffyStringPool::lookup(const identifier_ref& str) {
   return push_back_with_hash(str, h, entry);
 }
 
+size_t ReffyStringPool::tryLookup(const identifier_ref& str) {
+  auto entry = find(str, hash(str));
+  if (entry->generationNum == generationNumber)
+    return entry->stringIndex;
+  return npos;
+}
+
 identifier_ref ReffyStringPool::byIndex(size_t v) const {
   assert(v < count);
   auto h = strings[v];
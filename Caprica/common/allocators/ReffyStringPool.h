@@ -10,10 +10,13 @@ namespace caprica { namespace allocators {
 
 struct ReffyStringPool final {
   static constexpr size_t MaxCapacity = std::numeric_limits<uint16_t>::max();
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
 
   ReffyStringPool() = default;
 
   size_t lookup(const identifier_ref& str);
+  // Like lookup, but returns npos rather than adding the string.
+  size_t tryLookup(const identifier_ref& str);
   identifier_ref byIndex(size_t v) const;
   void push_back(const identifier_ref& str);
   void reset();
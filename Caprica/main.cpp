@@ -186,6 +186,7 @@ bool addFilesFromDirectory(const IInputFile& input,
               break;
             case PapyrusCompilationNode::NodeType::PexReflection:
             case PapyrusCompilationNode::NodeType::PexDissassembly:
+            case PapyrusCompilationNode::NodeType::PexOptimize:
               if (!pathEq(ext, ".pex"))
                 skip = true;
               break;
@@ -398,9 +399,6 @@ int main(int argc, char *argv[]) {
     caprica::CapricaReportingContext::breakIfDebugging();
     return -1;
   }
-  if (conf::General::compileInParallel)
-    jobManager.startup((uint32_t) std::thread::hardware_concurrency());
-
   caprica::papyrus::PapyrusCompilationContext::RenameImports(&jobManager);
   caprica::CapricaStats::outputImportedCount();
 
@@ -4,6 +4,7 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <common/allocators/HeapCache.h>
 #include <common/CapricaConfig.h>
 #include <common/FSUtils.h>
 #include <common/parser/CapricaPPJParser.h>
@@ -13,6 +14,7 @@
 #include <iostream>
 #include <papyrus/PapyrusCompilationContext.h>
 #include <string>
+#include <thread>
 #include <utility>
 namespace conf = caprica::conf;
 namespace po = boost::program_options;
@@ -162,6 +164,16 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
         "Set the directory to save compiler output to.")
       ("optimize,op,O",
         "Enable optimizations.")
+      ("optimize-with", po::value<std::vector<std::string>>()->composing(),
+        "Enable optimizations, along with one that is off by default. 'inline' inlines calls to small global "
+        "functions of the same script, and 'hoist-counts' hoists GetCount calls out of loops over collections "
+        "the loop doesn't modify.")
+      ("optimize-pex", po::bool_switch(&conf::General::optimizePexFiles)->default_value(false),
+        "Optimize already compiled Pex files (*.pex) and write them to the output directory, rather than compiling "
+        "scripts. Implies -O.")
+      ("disassemble-pex", po::bool_switch(&conf::General::disassemblePexFiles)->default_value(false),
+        "Disassemble already compiled Pex files (*.pex) into Pex assembly (*.pas) in the output directory, rather "
+        "than compiling scripts.")
       ("parallel-compile,p", po::bool_switch(&conf::General::compileInParallel)->default_value(false),
         "Compile files in parallel.")
       ("release,r",
@@ -239,6 +251,12 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
         "Creation Kit for the compiled script. This also removes the line number and struct order information.")
       ("enable-language-extensions", po::value<bool>(&conf::Papyrus::enableLanguageExtensions)->default_value(false),
         "Enable Caprica's extensions to the Papyrus language.")
+      ("memory-budget", po::value<size_t>(&conf::Performance::memoryBudget)->default_value(0),
+        "Limit how many files are compiled at once, so that the memory they take stays roughly under this many "
+        "megabytes. 0 means no limit.")
+      ("large-pages", po::value<bool>(&conf::Performance::useLargePages)->default_value(false),
+        "Back the biggest heaps with large pages. This needs the account to be allowed to lock pages in memory, "
+        "and is skipped with a warning when it isn't.")
       ("resolve-symlinks", po::value<bool>(&conf::Performance::resolveSymlinks)->default_value(false),
         "Fully resolve symlinks when determining file paths.");
 
@@ -359,7 +377,8 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
       std::cout << "Caprica Papyrus Compiler v0.3.0" << std::endl;
       std::cout << "Usage: Caprica <sourceFile / directory>" << std::endl;
       std::cout << "Note that when passing a directory, only Papyrus script files (*.psc) in it will be compiled. Pex "
-                   "(*.pex) and Pex assembly (*.pas) files will be ignored."
+                   "(*.pex) and Pex assembly (*.pas) files will be ignored, unless --optimize-pex or --disassemble-pex "
+                   "is passed, in which case only the Pex files will be used."
                 << std::endl;
       std::cout << visibleDesc << std::endl;
       return false;
@@ -403,6 +422,17 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
         filesPassed.erase(it);
     }
 
+    // Whether the inputs are compiled Pex files that are only being rewritten.
+    const bool pexFilesOnly = conf::General::optimizePexFiles || conf::General::disassemblePexFiles;
+    if (conf::General::optimizePexFiles && conf::General::disassemblePexFiles) {
+      std::cout << "Only one of --optimize-pex and --disassemble-pex can be passed!" << std::endl;
+      return false;
+    }
+    if (pexFilesOnly && !ppjPath.empty()) {
+      std::cout << "A project file can't be used with --optimize-pex or --disassemble-pex!" << std::endl;
+      return false;
+    }
+
     if (vm.count("pcompiler")) {
       conf::PCompiler::pCompilerCompatibilityMode = vm["pcompiler"].as<bool>();
       conf::PCompiler::all = vm["all"].as<bool>();
@@ -446,7 +476,7 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
         setPPJBool(ppj.release, conf::CodeGeneration::disableDebugCode);
       if (!vm.count("final"))
         setPPJBool(ppj.finalAttr, conf::CodeGeneration::disableBetaCode);
-      if (!vm.count("optimize"))
+      if (!vm.count("optimize") && !vm.count("optimize-with"))
         setPPJBool(ppj.optimize, conf::CodeGeneration::enableOptimizations);
       if (!vm.count("dump-asm") && !vm.count("keep-asm") && !vm.count("noasm")) {
         switch (ppj.asmAttr) {
@@ -475,8 +505,8 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
         conf::General::inputFiles.emplace_back(std::make_shared<PCompInputFile>(f, true, false, baseDir));
       flags = ppj.flags;
     } else { // if we're not doing a project file...
-      // ensure cwd is placed first
-      if (!vm["ignorecwd"].as<bool>()) {
+      // ensure cwd is placed first; rewritten Pex files never import anything
+      if (!vm["ignorecwd"].as<bool>() && !pexFilesOnly) {
         conf::Papyrus::importDirectories.reserve(conf::Papyrus::importDirectories.size() + 1);
         conf::Papyrus::importDirectories.emplace_back(filesystem::current_path(), false);
         if (!conf::General::quietCompile) {
@@ -499,8 +529,21 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
       conf::CodeGeneration::disableDebugCode = true;
     if (vm.count("final"))
       conf::CodeGeneration::disableBetaCode = true;
-    if (vm.count("optimize"))
+    if (vm.count("optimize") || conf::General::optimizePexFiles)
+      conf::CodeGeneration::enableOptimizations = true;
+    if (vm.count("optimize-with")) {
       conf::CodeGeneration::enableOptimizations = true;
+      for (auto& o : vm["optimize-with"].as<std::vector<std::string>>()) {
+        if (o == "inline") {
+          conf::CodeGeneration::enableInlining = true;
+        } else if (o == "hoist-counts") {
+          conf::CodeGeneration::enableCollectionCountHoisting = true;
+        } else {
+          std::cout << "Unrecognized optimization '" << o << "'!" << std::endl;
+          return false;
+        }
+      }
+    }
     if (vm.count("dump-asm") || vm.count("keepasm"))
       conf::Debug::dumpPexAsm = true;
     if (vm.count("pcompiler") && vm.count("noasm"))
@@ -516,9 +559,14 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
     }
 
     // TODO: enable this eventually
-    if (conf::CodeGeneration::enableOptimizations && conf::Papyrus::game != GameID::Fallout4) {
+    // Already compiled Pex files keep the game they were written for, and the
+    // passes only emit opcodes that every game has.
+    if (conf::CodeGeneration::enableOptimizations && conf::Papyrus::game != GameID::Fallout4 &&
+        !conf::General::optimizePexFiles) {
       if (!vm["force-enable-optimizations"].as<bool>()) {
         conf::CodeGeneration::enableOptimizations = false;
+        conf::CodeGeneration::enableInlining = false;
+        conf::CodeGeneration::enableCollectionCountHoisting = false;
         std::cout << "Warning: Optimization is currently only supported for Fallout 4, disabling..." << std::endl;
       } else {
         std::cout << "Warning: Optimization force enabled, optimization is currently only supported for Fallout 4 and "
@@ -532,6 +580,13 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
       conf::Papyrus::allowDecompiledStructNameRefs = true;
     }
 
+    if (conf::Performance::useLargePages && !allocators::HeapCache::enableLargePages()) {
+      conf::Performance::useLargePages = false;
+      std::cout << "Warning: Unable to use large pages, as this account isn't allowed to lock pages in memory. "
+                   "Continuing without them."
+                << std::endl;
+    }
+
     if (vm["performance-test-mode"].as<bool>()) {
       conf::Performance::dumpTiming = true;
       conf::Performance::asyncFileRead = true;
@@ -620,7 +675,9 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
       flagsPath = "fake://Starfield/Starfield_Papyrus_Flags.flg";
     }
 
-    if (flagsPath.empty()) {
+    // A Pex file carries its own user flags table, so rewriting one doesn't
+    // need a flags file unless it was asked for.
+    if (flagsPath.empty() && (!pexFilesOnly || !flags.empty())) {
       if (conf::Papyrus::game != GameID::Starfield) {
         std::cout << "Unable to locate flags file '" << flags << "'." << std::endl;
         return false;
@@ -628,9 +685,21 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
       std::cout << "Could not find flags file, using default Starfield flags..." << std::endl;
       flagsPath = "fake://Starfield/Starfield_Papyrus_Flags.flg";
     }
-    parseUserFlags(std::move(flagsPath));
+    if (!flagsPath.empty())
+      parseUserFlags(std::move(flagsPath));
+
+    // Every Pex file is rewritten on its own, so there's never a reason not to
+    // do them in parallel.
+    if (pexFilesOnly)
+      conf::General::compileInParallel = true;
 
-    if (!handleImports(conf::Papyrus::importDirectories, jobManager)) {
+    // Start the workers before scanning any directories, so that files get
+    // read and parsed while the rest of the tree is still being walked.
+    if (conf::General::compileInParallel)
+      jobManager->startup((uint32_t)std::thread::hardware_concurrency());
+
+    // Nothing gets resolved when only rewriting Pex files.
+    if (!pexFilesOnly && !handleImports(conf::Papyrus::importDirectories, jobManager)) {
       std::cout << "Import failed!" << std::endl;
       return false;
     }
@@ -661,6 +730,11 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
       for (auto& f : filesPassed) {
         if (!filesystem::is_directory(f)) {
           std::string_view ext = FSUtils::extensionAsRef(f);
+          if (pexFilesOnly && !pathEq(ext, ".pex")) {
+            std::cout << "Don't know how to handle input file '" << f << "'!" << std::endl;
+            std::cout << "Only Pex files (*.pex) can be passed with --optimize-pex or --disassemble-pex!" << std::endl;
+            return false;
+          }
           if (!pathEq(ext, ".psc") && !pathEq(ext, ".pas") && !pathEq(ext, ".pex") && !pathEq(ext, ".ppj")) {
             std::cout << "Don't know how to handle input file '" << f << "'!" << std::endl;
             std::cout << "Expected either a Papyrus file (*.psc), Pex assembly file (*.pas), or a Pex file (*.pex)!"
@@ -672,6 +746,11 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
       }
     }
 
+    auto nodeType = papyrus::PapyrusCompilationNode::NodeType::PapyrusCompile;
+    if (conf::General::optimizePexFiles)
+      nodeType = papyrus::PapyrusCompilationNode::NodeType::PexOptimize;
+    else if (conf::General::disassemblePexFiles)
+      nodeType = papyrus::PapyrusCompilationNode::NodeType::PexDissassembly;
     for (auto& input : conf::General::inputFiles) {
       if (!input){
         throw std::runtime_error("Input file is null!");
@@ -681,20 +760,22 @@ bool parseCommandLineArguments(int argc, char* argv[], caprica::CapricaJobManage
         return false;
       }
       if (std::filesystem::is_directory(input->resolved_absolute())) {
-        if (!addFilesFromDirectory(*input,
-                                   baseOutputDir,
-                                   jobManager,
-                                   papyrus::PapyrusCompilationNode::NodeType::PapyrusCompile,
-                                   "")) {
+        if (!addFilesFromDirectory(*input, baseOutputDir, jobManager, nodeType, "")) {
           std::cout << "Unable to add input directory '" << input->get_unresolved_path() << "'." << std::endl;
           return false;
         }
-      } else if (!addSingleFile(*input,
-                                baseOutputDir,
-                                jobManager,
-                                papyrus::PapyrusCompilationNode::NodeType::PapyrusCompile)) {
-        std::cout << "Unable to add input file '" << input->get_unresolved_path() << "'." << std::endl;
-        return false;
+      } else {
+        // Pex assembly gets assembled, rather than only reflected.
+        auto fileNodeType = nodeType;
+        auto path = input->resolved_absolute().string();
+        if (nodeType == papyrus::PapyrusCompilationNode::NodeType::PapyrusCompile &&
+            pathEq(FSUtils::extensionAsRef(path), ".pas")) {
+          fileNodeType = papyrus::PapyrusCompilationNode::NodeType::PasCompile;
+        }
+        if (!addSingleFile(*input, baseOutputDir, jobManager, fileNodeType)) {
+          std::cout << "Unable to add input file '" << input->get_unresolved_path() << "'." << std::endl;
+          return false;
+        }
       }
     }
   } catch (const std::exception& ex) {
@@ -6,20 +6,7 @@
 
 #include <papyrus/statements/PapyrusStatementVisitor.h>
 
-#include <papyrus/expressions/PapyrusArrayIndexExpression.h>
-#include <papyrus/expressions/PapyrusArrayLengthExpression.h>
-#include <papyrus/expressions/PapyrusBinaryOpExpression.h>
-#include <papyrus/expressions/PapyrusCastExpression.h>
-#include <papyrus/expressions/PapyrusFunctionCallExpression.h>
-#include <papyrus/expressions/PapyrusIdentifierExpression.h>
-#include <papyrus/expressions/PapyrusIsExpression.h>
-#include <papyrus/expressions/PapyrusLiteralExpression.h>
-#include <papyrus/expressions/PapyrusMemberAccessExpression.h>
-#include <papyrus/expressions/PapyrusNewArrayExpression.h>
-#include <papyrus/expressions/PapyrusNewStructExpression.h>
-#include <papyrus/expressions/PapyrusParentExpression.h>
-#include <papyrus/expressions/PapyrusSelfExpression.h>
-#include <papyrus/expressions/PapyrusUnaryOpExpression.h>
+#include <papyrus/expressions/PapyrusExpression.h>
 
 #include <papyrus/statements/PapyrusAssignStatement.h>
 #include <papyrus/statements/PapyrusBreakStatement.h>
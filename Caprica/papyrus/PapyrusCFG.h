@@ -9,9 +9,6 @@
 
 namespace caprica { namespace papyrus {
 
-namespace expressions {
-struct PapyrusExpression;
-}
 namespace statements {
 struct PapyrusStatement;
 }
@@ -1,11 +1,14 @@
 #include <papyrus/PapyrusCompilationContext.h>
 
+#include <algorithm>
+#include <deque>
 #include <fcntl.h>
 #include <filesystem>
 #include <io.h>
 #include <iostream>
+#include <mutex>
+#include <shared_mutex>
 
-#include <common/allocators/AtomicChainedPool.h>
 #include <common/CapricaConfig.h>
 #include <common/FakeScripts.h>
 
@@ -17,6 +20,10 @@
 
 namespace caprica { namespace papyrus {
 
+// Set once the imports have been renamed, after which no more namespaces may
+// be pushed. Until then, type resolution would give incomplete answers.
+static std::atomic<bool> namespaceTreeSealed { false };
+
 void PapyrusCompilationNode::awaitRead() {
   readJob.await();
 }
@@ -41,6 +48,14 @@ PapyrusObject* PapyrusCompilationNode::awaitSemantic() {
   return resolvedObject;
 }
 
+namespace {
+// The nodes waiting for room under the memory budget, in the order they were
+// queued, and how much of it the nodes being compiled are thought to take.
+static std::mutex memoryBudgetMutex {};
+static std::deque<PapyrusCompilationNode*> nodesAwaitingBudget {};
+static size_t memoryBudgetInUse { 0 };
+}
+
 void PapyrusCompilationNode::queueCompile() {
   switch (type) {
     case NodeType::PapyrusImport:
@@ -48,17 +63,60 @@ void PapyrusCompilationNode::queueCompile() {
     case NodeType::PexReflection:
       return;
   }
-  jobManager->queueJob(&writeJob);
+  if (conf::Performance::memoryBudget == 0) {
+    jobManager->queueJob(&writeJob);
+    return;
+  }
+  std::unique_lock<std::mutex> lock { memoryBudgetMutex };
+  nodesAwaitingBudget.push_back(this);
+  queueNodesWithinBudget();
+}
+
+// Must be called with memoryBudgetMutex held. A single node is always let
+// through, however big it is.
+void PapyrusCompilationNode::queueNodesWithinBudget() {
+  const size_t budget = conf::Performance::memoryBudget * 1024 * 1024;
+  while (!nodesAwaitingBudget.empty()) {
+    auto node = nodesAwaitingBudget.front();
+    if (memoryBudgetInUse != 0 && memoryBudgetInUse + node->estimatedMemoryUse() > budget)
+      return;
+    memoryBudgetInUse += node->estimatedMemoryUse();
+    nodesAwaitingBudget.pop_front();
+    node->jobManager->queueJob(&node->writeJob);
+  }
+}
+
+void PapyrusCompilationNode::releaseBudget() {
+  if (conf::Performance::memoryBudget == 0)
+    return;
+  std::unique_lock<std::mutex> lock { memoryBudgetMutex };
+  memoryBudgetInUse -= estimatedMemoryUse();
+  queueNodesWithinBudget();
+}
+
+void PapyrusCompilationNode::discard() {
+  discarded.store(true, std::memory_order_release);
+  // Anything compiled is parsed as soon as it's read, which may well still be
+  // underway. The parse job lets go of the source instead.
+  if (isCompiled())
+    return;
+  readJob.await();
+  releaseSource();
+}
+
+void PapyrusCompilationNode::queuePreParse() {
+  jobManager->queueJob(&preParseJob);
 }
 
 void PapyrusCompilationNode::awaitWrite() {
   switch (type) {
     case NodeType::PapyrusImport:
-    case NodeType::PexDissassembly: // NOTE: Pex disassembly gets written during Compile, not during Write?
     case NodeType::PasReflection:
     case NodeType::PexReflection:
       return;
   }
+  // Pex disassembly gets written during Compile, which the write job waits
+  // for.
   writeJob.await();
 }
 
@@ -67,29 +125,36 @@ PapyrusCompilationNode::NodeType PapyrusCompilationNode::getType() const {
   return type;
 }
 
-allocators::AtomicChainedPool readAllocator { 1024 * 1024 * 4 };
 void PapyrusCompilationNode::FileReadJob::run() {
-  if (parent->type == NodeType::PapyrusCompile || parent->type == NodeType::PasCompile ||
-      parent->type == NodeType::PexDissassembly) {
+  if (parent->isDiscarded())
+    return;
+  if (parent->type == NodeType::PapyrusCompile || parent->type == NodeType::PasCompile) {
     if (!conf::General::quietCompile)
       std::cout << "Compiling " + parent->reportedName + "\n";
+  } else if (parent->type == NodeType::PexDissassembly) {
+    if (!conf::General::quietCompile)
+      std::cout << "Disassembling " + parent->reportedName + "\n";
+  } else if (parent->type == NodeType::PexOptimize) {
+    if (!conf::General::quietCompile)
+      std::cout << "Optimizing " + parent->reportedName + "\n";
   }
   // TODO: remove this hack when imports are working
   if (parent->sourceFilePath.starts_with("fake://")) {
-    parent->ownedReadFileData = FakeScripts::getFakeScript(parent->sourceFilePath, conf::Papyrus::game).to_string();
-    parent->readFileData = parent->ownedReadFileData;
+    parent->takeSource(FakeScripts::getFakeScript(parent->sourceFilePath, conf::Papyrus::game).to_string());
     return;
   }
+  // Pex files are read by the PexReader when they're preparsed.
+  if (pathEq(FSUtils::extensionAsRef(parent->sourceFilePath), ".pex"))
+    return;
+  // Each node owns what it read, so that it can be let go of once parsed.
   if (parent->filesize < std::numeric_limits<uint32_t>::max()) {
-    auto buf = readAllocator.allocate(parent->filesize + 1);
     auto fd = _open(parent->sourceFilePath.c_str(), _O_BINARY | _O_RDONLY | _O_SEQUENTIAL);
     if (fd != -1) {
-      auto len = _read(fd, (void*)buf, (uint32_t)parent->filesize);
-      parent->readFileData = std::string_view(buf, len);
-      if (_eof(fd) == 1) {
+      parent->ownedReadFileData.resize(parent->filesize + SourcePadding);
+      auto len = _read(fd, parent->ownedReadFileData.data(), (uint32_t)parent->filesize);
+      if (len >= 0 && _eof(fd) == 1) {
         _close(fd);
-        // Need this to be null terminated.
-        buf[parent->filesize] = '\0';
+        parent->readFileData = std::string_view(parent->ownedReadFileData.data(), len);
         return;
       }
       _close(fd);
@@ -113,8 +178,7 @@ void PapyrusCompilationNode::FileReadJob::run() {
       str += strStream.str();
     }
     str += '\0';
-    parent->ownedReadFileData = std::move(str);
-    parent->readFileData = parent->ownedReadFileData;
+    parent->takeSource(std::move(str));
   }
 }
 
@@ -137,6 +201,9 @@ std::string_view findScriptName(const std::string_view& data, const std::string_
 
 void PapyrusCompilationNode::FilePreParseJob::run() {
   parent->readJob.await();
+  // Nothing may have been read.
+  if (parent->isDiscarded())
+    return;
   auto ext = FSUtils::extensionAsRef(parent->sourceFilePath);
   if (pathEq(ext, ".psc")) {
     parent->objectName = findScriptName(parent->readFileData, "scriptname");
@@ -161,11 +228,16 @@ void PapyrusCompilationNode::FilePreParseJob::run() {
 
 void PapyrusCompilationNode::FileParseJob::run() {
   parent->preParseJob.await();
+  if (parent->isDiscarded()) {
+    parent->releaseSource();
+    return;
+  }
   // Check if we have the correct namespace
 
   switch (parent->type) {
     case NodeType::PapyrusCompile: // only check for this on compile nodes
     case NodeType::PexDissassembly:
+    case NodeType::PexOptimize:
     case NodeType::PasCompile: {
       // check the object name with the reportedname
       auto nsName = FSUtils::pathToObjectName(parent->reportedName);
@@ -202,11 +274,13 @@ void PapyrusCompilationNode::FileParseJob::run() {
     if (parent->type != NodeType::PapyrusImport)
       parent->reportingContext.exitIfErrors();
     delete parser;
+    // Everything the script needs has been copied out of the source.
+    parent->releaseSource();
   } else if (pathEq(ext, ".pex")) {
-    if (parent->type == NodeType::PexDissassembly)
+    if (parent->type == NodeType::PexDissassembly || parent->type == NodeType::PexOptimize)
       return;
   } else if (pathEq(ext, ".pas")) {
-    auto parser = new pex::parser::PexAsmParser(parent->reportingContext, parent->sourceFilePath);
+    auto parser = new pex::parser::PexAsmParser(parent->reportingContext, parent->sourceFilePath, parent->readFileData);
     parent->pexFile = parser->parseFile();
     parent->reportingContext.exitIfErrors();
     delete parser;
@@ -231,6 +305,9 @@ void PapyrusCompilationNode::FileParseJob::run() {
 }
 
 void PapyrusCompilationNode::FilePreSemanticJob::run() {
+  if (!namespaceTreeSealed.load(std::memory_order_acquire))
+    CapricaReportingContext::logicalFatal("Attempted to resolve '{}' before the namespace tree was sealed!",
+                                          parent->reportedName);
   parent->parseJob.await();
   for (auto o : parent->loadedScript->objects)
     o->compilationNode = parent;
@@ -251,62 +328,73 @@ void PapyrusCompilationNode::FileSemanticJob::run() {
 
 static constexpr bool disablePexBuild = false;
 
+static void writePexAsm(const std::string& outputDirectory,
+                        const std::string_view& baseName,
+                        const pex::PexFile* file) {
+  auto containingDir = std::filesystem::path(outputDirectory);
+  if (!std::filesystem::exists(containingDir))
+    std::filesystem::create_directories(containingDir);
+  std::ofstream asmStrm(outputDirectory + FSUtils::SEP + std::string(baseName) + ".pas", std::ofstream::binary);
+  asmStrm.exceptions(std::ifstream::badbit | std::ifstream::failbit);
+  pex::PexAsmWriter asmWtr(asmStrm);
+  file->writeAsm(asmWtr);
+  asmWtr.flush();
+}
+
 void PapyrusCompilationNode::FileCompileJob::run() {
-  parent->semanticJob.await();
+  if (parent->isDiscarded())
+    return;
+  // Pex files and assembly that are only being rewritten are never resolved.
+  if (parent->type == NodeType::PexDissassembly || parent->type == NodeType::PexOptimize ||
+      parent->type == NodeType::PasCompile)
+    parent->parseJob.await();
+  else
+    parent->semanticJob.await();
+  // Big scripts are split up between the workers too.
+  auto functionJobManager = conf::General::compileInParallel ? parent->jobManager : nullptr;
   switch (parent->type) {
     case NodeType::PapyrusCompile: {
+      parent->resolutionContext->jobManager = functionJobManager;
       parent->loadedScript->semantic2(parent->resolutionContext);
       parent->reportingContext.exitIfErrors();
       delete parent->resolutionContext;
       parent->resolutionContext = nullptr;
 
       if (!disablePexBuild) {
-        parent->pexFile = parent->loadedScript->buildPex(parent->reportingContext);
+        parent->pexFile = parent->loadedScript->buildPex(parent->reportingContext, functionJobManager);
         parent->reportingContext.exitIfErrors();
 
         if (conf::CodeGeneration::enableOptimizations)
-          pex::PexOptimizer::optimize(parent->pexFile);
+          pex::PexOptimizer::optimize(parent->pexFile, functionJobManager);
 
         parent->pexWriter = new pex::PexWriter();
         parent->pexFile->write(*parent->pexWriter);
 
-        if (conf::Debug::dumpPexAsm) {
-          auto baseFileName = std::string(FSUtils::basenameAsRef(parent->sourceFilePath));
-          auto containingDir = std::filesystem::path(parent->outputDirectory);
-          if (!std::filesystem::exists(containingDir))
-            std::filesystem::create_directories(containingDir);
-          std::ofstream asmStrm(parent->outputDirectory + FSUtils::SEP + std::string(parent->baseName) + ".pas",
-                                std::ofstream::binary);
-          asmStrm.exceptions(std::ifstream::badbit | std::ifstream::failbit);
-          pex::PexAsmWriter asmWtr(asmStrm);
-          parent->pexFile->writeAsm(asmWtr);
-        }
+        if (conf::Debug::dumpPexAsm)
+          writePexAsm(parent->outputDirectory, parent->baseName, parent->pexFile);
 
         delete parent->pexFile->alloc;
         parent->pexFile = nullptr;
+        // Other scripts only ever look at the rest of it.
+        parent->loadedScript->releaseFunctionBodies();
       }
       return;
     }
     case NodeType::PexDissassembly: {
-      auto baseFileName = std::string(FSUtils::basenameAsRef(parent->sourceFilePath));
-      auto containingDir = std::filesystem::path(parent->outputDirectory);
-      if (!std::filesystem::exists(containingDir))
-        std::filesystem::create_directories(containingDir);
-      std::ofstream asmStrm(parent->outputDirectory + FSUtils::SEP + std::string(parent->baseName) + ".pas",
-                            std::ofstream::binary);
-      asmStrm.exceptions(std::ifstream::badbit | std::ifstream::failbit);
-      caprica::pex::PexAsmWriter asmWtr(asmStrm);
-      parent->pexFile->writeAsm(asmWtr);
+      writePexAsm(parent->outputDirectory, parent->baseName, parent->pexFile);
       delete parent->pexFile->alloc;
       parent->pexFile = nullptr;
       return;
     }
-    case NodeType::PasCompile: {
+    case NodeType::PasCompile:
+    case NodeType::PexOptimize: {
       if (conf::CodeGeneration::enableOptimizations)
-        pex::PexOptimizer::optimize(parent->pexFile);
+        pex::PexOptimizer::optimize(parent->pexFile, functionJobManager);
 
       parent->pexWriter = new pex::PexWriter();
       parent->pexFile->write(*parent->pexWriter);
+      if (parent->type == NodeType::PexOptimize && conf::Debug::dumpPexAsm)
+        writePexAsm(parent->outputDirectory, parent->baseName, parent->pexFile);
       delete parent->pexFile->alloc;
       parent->pexFile = nullptr;
       return;
@@ -325,10 +413,18 @@ void PapyrusCompilationNode::FileCompileJob::run() {
 }
 
 void PapyrusCompilationNode::FileWriteJob::run() {
+  // Never queued under the memory budget.
+  if (parent->isDiscarded())
+    return;
+  struct BudgetReleaser final {
+    PapyrusCompilationNode* node;
+    ~BudgetReleaser() { node->releaseBudget(); }
+  } budgetReleaser { parent };
   parent->compileJob.await();
   switch (parent->type) {
     case NodeType::PasCompile:
-    case NodeType::PapyrusCompile: {
+    case NodeType::PapyrusCompile:
+    case NodeType::PexOptimize: {
       if (!conf::Performance::performanceTestMode) {
         auto baseFileName = std::string(FSUtils::basenameAsRef(parent->sourceFilePath));
         auto containingDir = std::filesystem::path(parent->outputDirectory);
@@ -357,9 +453,40 @@ void PapyrusCompilationNode::FileWriteJob::run() {
 }
 
 namespace {
+// Guards the namespace tree, the indexes mirroring it, and nodesToCleanUp.
+// Lookups only take a shared lock, so the workers can resolve types
+// concurrently while new files are still being pushed.
+static std::shared_mutex namespaceMutex {};
 static std::vector<PapyrusCompilationNode*> nodesToCleanUp {};
+// The fully qualified names of every namespace and every object in the tree,
+// so that resolving a type doesn't have to walk it. The temporary import
+// namespaces are never indexed, as nothing is resolved until they have been
+// renamed.
+static caseless_unordered_identifier_set namespaceIndex {};
+static caseless_unordered_identifier_map<PapyrusCompilationNode*> typeIndex {};
+// Incremented for every namespace created, so the temporary import
+// namespaces can be renamed in the order they were imported.
+static size_t namespaceCreationCount { 0 };
+
+typedef caprica::caseless_unordered_identifier_map<
+    caprica::caseless_unordered_identifier_ref_map<PapyrusCompilationNode*>>
+    TempRenameMap;
+
+static std::string qualifyName(const std::string& namespaceName, const identifier_ref& name) {
+  if (namespaceName.empty())
+    return name.to_string();
+  std::string ret;
+  ret.reserve(namespaceName.size() + 1 + name.size());
+  ret.append(namespaceName);
+  ret.push_back(':');
+  ret.append(name.data(), name.size());
+  return ret;
+}
+
 struct PapyrusNamespace final {
   std::string name { "" };
+  std::string fullName { "" };
+  size_t creationOrder { 0 };
   PapyrusNamespace* parent { nullptr };
   caseless_unordered_identifier_ref_map<PapyrusNamespace*> children {};
   // Key is unqualified name, value is full path to file.
@@ -393,6 +520,41 @@ struct PapyrusNamespace final {
       c.second->awaitPreSemantic();
   }
 
+  void queuePreParse() {
+    for (auto o : objects)
+      o.second->queuePreParse();
+    for (auto c : children)
+      c.second->queuePreParse();
+  }
+
+  // Groups the objects of this temporary import namespace, and of its
+  // children, by the namespace their script name actually declares.
+  void collectRenames(TempRenameMap& tempRenameMap) const {
+    for (auto& object : objects) {
+      auto objectName = object.second->awaitPreParse();
+      auto pos = objectName.find_last_of(':');
+      auto namespaceName = pos == identifier_ref::npos ? "" : objectName.substr(0, pos);
+      if (tempRenameMap.count(namespaceName) == 0) {
+        tempRenameMap[namespaceName] = caseless_unordered_identifier_ref_map<PapyrusCompilationNode*>();
+        tempRenameMap[namespaceName].reserve(objects.size());
+      }
+      tempRenameMap[namespaceName].emplace(object.first, object.second);
+    }
+    for (auto& child : children)
+      child.second->collectRenames(tempRenameMap);
+  }
+
+  struct RenameJob final : public CapricaJob {
+    explicit RenameJob(const PapyrusNamespace* par) : parent(par) { }
+
+    TempRenameMap renames {};
+
+    virtual void run() override { parent->collectRenames(renames); }
+
+  private:
+    const PapyrusNamespace* parent;
+  } renameJob { this };
+
   void queueCompile() {
     for (auto o : objects)
       o.second->queueCompile();
@@ -429,31 +591,35 @@ struct PapyrusNamespace final {
                   case PapyrusCompilationNode::NodeType::PapyrusCompile:
                   case PapyrusCompilationNode::NodeType::PasCompile:
                   case PapyrusCompilationNode::NodeType::PexDissassembly:
+                  case PapyrusCompilationNode::NodeType::PexOptimize:
                     nodesToCleanUp.push_back(f->second);
+                    f->second->discard();
                     f->second = obj.second;
+                    indexObject(f->first, f->second);
                     break;
                   default:
                     nodesToCleanUp.push_back(obj.second);
+                    obj.second->discard();
                     break;
                 }
                 break;
               default:
                 nodesToCleanUp.push_back(obj.second);
+                obj.second->discard();
                 break;
             }
           } else {
             // we don't have a duplicate, so we can just add it
+            indexObject(obj.first, obj.second);
             objects.emplace(std::move(obj.first), std::move(obj.second));
           }
         }
-        // TODO: make this thread-safe
-        // TODO: Orvid, calling `delete` on this node causes a crash, so I'm just leaking it for now
-        // for (auto &node : nodesToCleanUp){
-        //   delete node;
-        // }
-        // nodesToCleanUp.clear();
+        // The nodes in nodesToCleanUp can't be deleted, as the job queue can
+        // still refer to their jobs, but they've let go of what they read.
       } else {
         // we don't have any objects, so we can just move the map
+        for (auto& obj : map)
+          indexObject(obj.first, obj.second);
         objects = std::move(map);
       }
       return;
@@ -471,41 +637,94 @@ struct PapyrusNamespace final {
     if (f == children.end()) {
       auto n = new PapyrusNamespace();
       n->name = curSearchPiece.to_string();
+      n->fullName = qualifyName(fullName, n->name);
+      n->creationOrder = namespaceCreationCount++;
       n->parent = this;
+      if (!n->isTemporary())
+        namespaceIndex.insert(n->fullName);
       children.emplace(n->name, n);
       f = children.find(curSearchPiece);
     }
     f->second->createNamespace(nextSearchPiece, std::move(map));
   }
 
-  bool tryFindNamespace(const identifier_ref& curPiece, PapyrusNamespace const** ret) const {
-    if (curPiece == "") {
-      *ret = this;
-      return true;
-    }
+  // If this is a namespace beginning with `!`, this is a temporary import namespace
+  bool isTemporary() const { return fullName.size() && fullName[0] == '!'; }
 
-    identifier_ref curSearchPiece = curPiece;
-    identifier_ref nextSearchPiece = "";
-    auto loc = curPiece.find(':');
-    if (loc != identifier_ref::npos) {
-      curSearchPiece = curPiece.substr(0, loc);
-      nextSearchPiece = curPiece.substr(loc + 1);
-    }
+private:
+  void indexObject(const identifier_ref& objName, PapyrusCompilationNode* node) const {
+    if (!isTemporary())
+      typeIndex.insert_or_assign(qualifyName(fullName, objName), node);
+  }
+};
+}
 
-    auto f = children.find(curSearchPiece);
-    if (f != children.end())
-      return f->second->tryFindNamespace(nextSearchPiece, ret);
+static PapyrusNamespace rootNamespace {};
+void PapyrusCompilationContext::pushNamespaceFullContents(
+    const std::string& namespaceName, caseless_unordered_identifier_ref_map<PapyrusCompilationNode*>&& map) {
+  std::unique_lock<std::shared_mutex> lock { namespaceMutex };
+  if (namespaceTreeSealed.load(std::memory_order_relaxed))
+    CapricaReportingContext::logicalFatal("Attempted to add the namespace '{}' after the tree was sealed!",
+                                          namespaceName);
+  rootNamespace.createNamespace(namespaceName, std::move(map));
+}
 
-    return false;
+void PapyrusCompilationContext::awaitRead() {
+  std::shared_lock<std::shared_mutex> lock { namespaceMutex };
+  rootNamespace.awaitRead();
+}
+
+void PapyrusCompilationContext::doCompile(CapricaJobManager* jobManager) {
+  {
+    std::shared_lock<std::shared_mutex> lock { namespaceMutex };
+    rootNamespace.queueCompile();
+  }
+  jobManager->setQueueInitialized();
+  jobManager->enjoin();
+}
+
+void PapyrusCompilationContext::RenameImports(CapricaJobManager* jobManager) {
+  std::unique_lock<std::shared_mutex> lock { namespaceMutex };
+  std::vector<PapyrusNamespace*> tempNamespaces {};
+  for (auto& child : rootNamespace.children) {
+    if (child.second->isTemporary())
+      tempNamespaces.push_back(child.second);
+  }
+  // this has to be done in the same import order; earlier overrides later
+  std::sort(tempNamespaces.begin(), tempNamespaces.end(), [](auto a, auto b) {
+    return a->creationOrder < b->creationOrder;
+  });
+
+  // Finding the script name means reading the file, and all of it for pex
+  // files, so let the workers do it for every import at once, then have them
+  // group the results for each import directory.
+  for (auto ns : tempNamespaces)
+    ns->queuePreParse();
+  for (auto ns : tempNamespaces)
+    jobManager->queueJob(&ns->renameJob);
+
+  for (auto ns : tempNamespaces) {
+    ns->renameJob.await();
+    for (auto& newChildMap : ns->renameJob.renames)
+      rootNamespace.createNamespace(newChildMap.first, std::move(newChildMap.second));
+    ns->renameJob.renames.clear();
   }
 
-  bool
-  tryFindType(const identifier_ref& typeName, PapyrusCompilationNode** retNode, identifier_ref* retStructName) const {
+  // remove the children
+  std::erase_if(rootNamespace.children, [](const auto& child) { return child.second->isTemporary(); });
+  namespaceTreeSealed.store(true, std::memory_order_release);
+}
+
+static bool tryFindTypeInNamespace(std::string namespaceName,
+                                   identifier_ref typeName,
+                                   PapyrusCompilationNode** retNode,
+                                   identifier_ref* retStructName) {
+  while (true) {
     auto loc = typeName.find(':');
     if (loc == identifier_ref::npos) {
-      auto f2 = objects.find(typeName);
-      if (f2 != objects.end()) {
-        *retNode = f2->second;
+      auto f = typeIndex.find(qualifyName(namespaceName, typeName));
+      if (f != typeIndex.end()) {
+        *retNode = f->second;
         return true;
       }
       return false;
@@ -517,9 +736,12 @@ struct PapyrusNamespace final {
     auto subName = typeName.substr(loc + 1);
 
     // It's a partially qualified name.
-    auto f = children.find(baseName);
-    if (f != children.end())
-      return f->second->tryFindType(subName, retNode, retStructName);
+    auto childName = qualifyName(namespaceName, baseName);
+    if (namespaceIndex.find(childName) != namespaceIndex.end()) {
+      namespaceName = std::move(childName);
+      typeName = subName;
+      continue;
+    }
 
     // subName is still partially qualified, so it can't
     // be referencing a struct in this namespace.
@@ -527,100 +749,34 @@ struct PapyrusNamespace final {
       return false;
 
     // It is a struct reference.
-    auto f2 = objects.find(baseName);
-    if (f2 != objects.end()) {
-      *retNode = f2->second;
+    auto f = typeIndex.find(childName);
+    if (f != typeIndex.end()) {
+      *retNode = f->second;
       *retStructName = subName;
       return true;
     }
-
     return false;
   }
-};
-}
-
-static PapyrusNamespace rootNamespace {};
-void PapyrusCompilationContext::pushNamespaceFullContents(
-    const std::string& namespaceName, caseless_unordered_identifier_ref_map<PapyrusCompilationNode*>&& map) {
-  rootNamespace.createNamespace(namespaceName, std::move(map));
-}
-
-void PapyrusCompilationContext::awaitRead() {
-  rootNamespace.awaitRead();
-}
-
-void PapyrusCompilationContext::doCompile(CapricaJobManager* jobManager) {
-  rootNamespace.queueCompile();
-  jobManager->setQueueInitialized();
-  jobManager->enjoin();
-}
-
-typedef caprica::caseless_unordered_identifier_map<
-    caprica::caseless_unordered_identifier_ref_map<PapyrusCompilationNode*>>
-    TempRenameMap;
-
-static void renameMap(const PapyrusNamespace* child, TempRenameMap& tempRenameMap) {
-  for (auto& object : child->objects) {
-    auto objectName = object.second->awaitPreParse();
-    auto pos = objectName.find_last_of(':');
-    auto namespaceName = pos == identifier_ref::npos ? "" : objectName.substr(0, pos);
-    if (tempRenameMap.count(namespaceName) == 0) {
-      tempRenameMap[namespaceName] = caseless_unordered_identifier_ref_map<PapyrusCompilationNode*>();
-      tempRenameMap[namespaceName].reserve(child->objects.size());
-    }
-    tempRenameMap[namespaceName].emplace(std::move(object.first), std::move(object.second));
-  }
-  for (auto& child2 : child->children)
-    renameMap(child2.second, tempRenameMap);
-}
-
-void PapyrusCompilationContext::RenameImports(CapricaJobManager* jobManager) {
-  if (conf::General::compileInParallel)
-    jobManager->startup((uint32_t)std::thread::hardware_concurrency());
-
-  for (auto& child : rootNamespace.children) {
-    // If this is a child beginning with `!`, this is a temporary import namespace
-    if (child.first[0] == '!') {
-      // await parsing
-      child.second->awaitPreParse();
-    }
-  }
-  TempRenameMap tempRenameMap;
-  for (auto& child : rootNamespace.children) {
-    if (child.first[0] != '!')
-      continue;
-    renameMap(child.second, tempRenameMap);
-    // this has to be done in the same import order; earlier overrides later
-    for (auto& newChildMap : tempRenameMap)
-      pushNamespaceFullContents(newChildMap.first, std::move(newChildMap.second));
-    tempRenameMap.clear();
-  }
-
-  // remove the children
-  for (auto it = rootNamespace.children.begin(); it != rootNamespace.children.end(); ++it) {
-    if ((*it).first[0] != '!')
-      continue;
-    rootNamespace.children.erase(it);
-    it = rootNamespace.children.begin();
-    if (it == rootNamespace.children.end())
-      break;
-  }
 }
 
 bool PapyrusCompilationContext::tryFindType(const identifier_ref& baseNamespace,
                                             const identifier_ref& typeName,
                                             PapyrusCompilationNode** retNode,
                                             identifier_ref* retStructName) {
-  const PapyrusNamespace* curNamespace = nullptr;
-  if (!rootNamespace.tryFindNamespace(baseNamespace, &curNamespace))
+  std::shared_lock<std::shared_mutex> lock { namespaceMutex };
+  auto curNamespace = baseNamespace.to_string();
+  if (!curNamespace.empty() && namespaceIndex.find(curNamespace) == namespaceIndex.end())
     return false;
 
-  while (curNamespace != nullptr) {
-    if (curNamespace->tryFindType(typeName, retNode, retStructName))
+  // Search the base namespace, then each of its parents in turn.
+  while (true) {
+    if (tryFindTypeInNamespace(curNamespace, typeName, retNode, retStructName))
       return true;
-    curNamespace = curNamespace->parent;
+    if (curNamespace.empty())
+      return false;
+    auto pos = curNamespace.find_last_of(':');
+    curNamespace.resize(pos == std::string::npos ? 0 : pos);
   }
-  return false;
 }
 
 }}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 
+#include <common/CapricaConfig.h>
 #include <common/CapricaJobManager.h>
 #include <common/CaselessStringComparer.h>
 #include <common/FSUtils.h>
@@ -20,6 +23,7 @@ struct PapyrusCompilationNode final {
 
     PasCompile,
     PexDissassembly,
+    PexOptimize,
 
     PasReflection,
     PexReflection,
@@ -56,7 +60,15 @@ struct PapyrusCompilationNode final {
     // TODO: fix Imports hack
     if (type == NodeType::PapyrusImport)
       reportingContext.m_QuietWarnings = true;
+    // With a memory budget, what gets compiled is only read once there's
+    // room for it.
+    if (conf::Performance::memoryBudget != 0 && isCompiled())
+      return;
     jobManager->queueJob(&readJob);
+    // Anything we compile will always get parsed, so there's no reason to
+    // wait for the rest of the tree to be scanned before doing so.
+    if (isCompiled())
+      jobManager->queueJob(&parseJob);
   }
 
   ~PapyrusCompilationNode() {
@@ -73,6 +85,9 @@ struct PapyrusCompilationNode final {
   void awaitRead();
 
   std::string awaitPreParse();
+  // Hand the preparse job to the job manager, rather than leaving it to
+  // whoever first awaits it. May only be called once per node.
+  void queuePreParse();
 
   PapyrusScript *awaitParse();
 
@@ -83,6 +98,11 @@ struct PapyrusCompilationNode final {
   void queueCompile();
   void awaitWrite();
 
+  // Called on a node that lost out to another one for the same object.
+  // Queued jobs still point at it, so it can't be deleted, but what it read
+  // can be let go of, and its jobs do nothing once they get to run.
+  void discard();
+
   NodeType getType() const;
 
 private:
@@ -93,6 +113,10 @@ private:
     PapyrusCompilationNode* parent;
   };
 
+  // A rough guess at how much memory compiling a file takes for every byte
+  // of it, for the memory budget.
+  static constexpr size_t EstimatedMemoryPerSourceByte = 16;
+
   NodeType type;
   size_t filesize;
   time_t lastModTime;
@@ -112,6 +136,40 @@ private:
   CapricaReportingContext reportingContext;
   PapyrusResolutionContext* resolutionContext { nullptr };
   CapricaJobManager* jobManager;
+  std::atomic<bool> discarded { false };
+
+  bool isDiscarded() const { return discarded.load(std::memory_order_acquire); }
+
+  bool isCompiled() const {
+    switch (type) {
+      case NodeType::PapyrusCompile:
+      case NodeType::PasCompile:
+      case NodeType::PexDissassembly:
+      case NodeType::PexOptimize:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  size_t estimatedMemoryUse() const { return std::max<size_t>(filesize, 1) * EstimatedMemoryPerSourceByte; }
+  static void queueNodesWithinBudget();
+  void releaseBudget();
+
+  // Need the source to be null terminated, and the lexer reads 16 bytes at a
+  // time.
+  static constexpr size_t SourcePadding = 16;
+  void takeSource(std::string&& str) {
+    auto len = str.size();
+    ownedReadFileData = std::move(str);
+    ownedReadFileData.resize(len + SourcePadding);
+    readFileData = std::string_view(ownedReadFileData.data(), len);
+  }
+  // The source is only needed until it has been parsed.
+  void releaseSource() {
+    readFileData = {};
+    std::string().swap(ownedReadFileData);
+  }
 
   struct FileReadJob final : public BaseJob {
     using BaseJob::BaseJob;
@@ -161,6 +219,9 @@ struct PapyrusCompilationContext final {
                           PapyrusCompilationNode **retNode,
                           identifier_ref *retStructName);
 
+  // Moves the imports into the namespaces their scripts declare, then seals
+  // the namespace tree. Nothing can be pushed after this, and the semantic
+  // passes can't start before it.
   static void RenameImports(CapricaJobManager *jobManager);
 };
 
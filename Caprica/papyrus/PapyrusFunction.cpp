@@ -62,7 +62,7 @@ pex::PexFunction* PapyrusFunction::buildPex(CapricaReportingContext& repCtx,
 
   pex::PexFunctionBuilder bldr { repCtx, location, file };
   for (auto s : statements)
-    s->buildPex(file, bldr);
+    s->buildPex(file, bldr, *expressionStore);
   bldr.populateFunction(func, fDebInfo);
 
   if (file->debugInfo)
@@ -96,6 +96,7 @@ void PapyrusFunction::semantic2(PapyrusResolutionContext* ctx) {
   ctx->ensureNamesAreUnique(parameters, "parameter");
 
   ctx->function = this;
+  ctx->expressionStore = expressionStore;
   ctx->pushLocalVariableScope();
   // skyrim first pass
   if (conf::Papyrus::game == GameID::Skyrim)
@@ -105,6 +106,7 @@ void PapyrusFunction::semantic2(PapyrusResolutionContext* ctx) {
     s->semantic(ctx);
   ctx->popLocalVariableScope();
   ctx->function = nullptr;
+  ctx->expressionStore = nullptr;
 
   // Don't build the CFG for the special functions.
   if (!isNative()) {
@@ -40,6 +40,8 @@ struct PapyrusFunction final {
   PapyrusUserFlags userFlags {};
   IntrusiveLinkedList<PapyrusFunctionParameter> parameters {};
   IntrusiveLinkedList<statements::PapyrusStatement> statements {};
+  // The expressions of the statements, null for native functions.
+  expressions::PapyrusExpressionStore* expressionStore { nullptr };
   PapyrusObject* parentObject { nullptr };
   PapyrusFunctionType functionType { PapyrusFunctionType::Unknown };
   identifier_ref remoteEventParent { "" };
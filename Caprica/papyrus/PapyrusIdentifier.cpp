@@ -64,7 +64,7 @@ pex::PexValue PapyrusIdentifier::generateLoad(pex::PexFile* file,
   switch (type) {
     case PapyrusIdentifierType::Property:
       if (conf::CodeGeneration::enableCKOptimizations && res.prop->isAuto() && !res.prop->isAutoReadOnly() &&
-          !base.tmpVar && file->getStringValue(base.name) == "self") {
+          !base.isTmpVar() && file->getStringValue(base.name) == "self") {
         // We can only do this for properties on ourselves. (CK does this even on parents)
         return pex::PexValue::Identifier(file->getString(res.prop->autoVarName));
       } else {
@@ -107,7 +107,7 @@ void PapyrusIdentifier::generateStore(pex::PexFile* file,
       if (res.prop->isAutoReadOnly())
         bldr.reportingContext.error(location, "Attempted to generate a store to a read-only property!");
       if (conf::CodeGeneration::enableCKOptimizations && res.prop->isAuto() && !res.prop->isAutoReadOnly() &&
-          !base.tmpVar && file->getStringValue(base.name) == "self") {
+          !base.isTmpVar() && file->getStringValue(base.name) == "self") {
         // We can only do this for properties on ourselves. (CK does this even on parents)
         bldr << op::assign { pex::PexValue::Identifier(file->getString(res.prop->autoVarName)), val };
       } else {
@@ -25,9 +25,6 @@ struct PapyrusResolutionContext;
 struct PapyrusStructMember;
 struct PapyrusVariable;
 
-namespace expressions {
-struct PapyrusMemberAccessExpression;
-}
 namespace statements {
 struct PapyrusDeclareStatement;
 }
@@ -168,7 +165,6 @@ struct PapyrusIdentifier final {
   PapyrusType resultType() const;
 
 private:
-  friend expressions::PapyrusMemberAccessExpression;
   friend PapyrusResolutionContext;
 
   PapyrusIdentifier(PapyrusIdentifierType k, CapricaFileLocation loc) : type(k), location(loc) { }
@@ -25,7 +25,54 @@ const PapyrusObject* PapyrusObject::tryGetParentClass() const {
   return nullptr;
 }
 
-void PapyrusObject::buildPex(CapricaReportingContext& repCtx, pex::PexFile* file) const {
+void PapyrusObject::buildSymbolTables() {
+  memberSymbols.clear();
+  for (auto pg : propertyGroups) {
+    for (auto p : pg->properties)
+      memberSymbols[p->name].properties.push_back(p);
+  }
+  for (auto v : variables)
+    memberSymbols[v->name].variables.push_back(v);
+  for (auto g : guards)
+    memberSymbols[g->name].guards.push_back(g);
+
+  for (auto s : structs)
+    s->buildSymbolTable();
+}
+
+void PapyrusObject::buildInheritedSymbols() {
+  // Our own members go in first, so emplace leaves them in place when the
+  // parent's flattened table is merged in afterwards.
+  for (auto pg : propertyGroups) {
+    for (auto p : pg->properties)
+      inheritedSymbols.properties.emplace(p->name, p);
+  }
+  for (auto& f : rootState->functions) {
+    inheritedSymbols.functions.emplace(f.first, f.second);
+    if (f.second->functionType == PapyrusFunctionType::Event)
+      inheritedSymbols.events.emplace(f.first, f.second);
+  }
+  for (auto c : customEvents)
+    inheritedSymbols.customEvents.emplace(c->name, c);
+  for (auto s : states)
+    inheritedSymbols.states.emplace(s->name, s);
+
+  if (auto parent = tryGetParentClass()) {
+    auto parentSymbols = parent->tryGetInheritedSymbols();
+    if (!parentSymbols)
+      CapricaReportingContext::logicalFatal("The semantic pass of '{}' has not completed yet!", parent->name);
+    inheritedSymbols.properties.insert(parentSymbols->properties.begin(), parentSymbols->properties.end());
+    inheritedSymbols.functions.insert(parentSymbols->functions.begin(), parentSymbols->functions.end());
+    inheritedSymbols.events.insert(parentSymbols->events.begin(), parentSymbols->events.end());
+    inheritedSymbols.customEvents.insert(parentSymbols->customEvents.begin(), parentSymbols->customEvents.end());
+    inheritedSymbols.states.insert(parentSymbols->states.begin(), parentSymbols->states.end());
+  }
+  inheritedSymbolsBuilt.store(true, std::memory_order_release);
+}
+
+void PapyrusObject::buildPex(CapricaReportingContext& repCtx,
+                             pex::PexFile* file,
+                             CapricaJobManager* jobManager) const {
   auto obj = file->alloc->make<pex::PexObject>();
   obj->name = file->getString(name);
   if (auto parClass = tryGetParentClass())
@@ -61,7 +108,7 @@ void PapyrusObject::buildPex(CapricaReportingContext& repCtx, pex::PexFile* file
   for (auto s : states) {
     if (s->name != "")
       namedStateCount++;
-    s->buildPex(repCtx, file, obj);
+    s->buildPex(repCtx, file, obj, jobManager);
   }
 
   size_t initialValueCount = 0;
@@ -94,6 +141,7 @@ void PapyrusObject::semantic(PapyrusResolutionContext* ctx) {
     s->semantic(ctx);
   ctx->clearImports();
   ctx->object = nullptr;
+  buildInheritedSymbols();
   resolutionState = PapyrusResoultionState::SemanticCompleted;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,27 @@ enum class PapyrusResoultionState {
   Semantic2Completed,
 };
 
+// Every member declared directly on an object under a single name, in
+// declaration order. There is normally only one, but duplicates have to be
+// kept around so the semantic pass can report them.
+struct PapyrusObjectMemberSymbols final {
+  std::vector<const PapyrusProperty*> properties {};
+  std::vector<const PapyrusVariable*> variables {};
+  std::vector<const PapyrusGuard*> guards {};
+};
+
+// Everything visible on an object through its extends chain, flattened so
+// that a lookup is a single probe. Each entry is the nearest definition, so
+// members on a child hide those of the same name on its parents.
+struct PapyrusObjectInheritedSymbols final {
+  caseless_unordered_identifier_ref_map<const PapyrusProperty*> properties {};
+  // Functions of the root (empty) state.
+  caseless_unordered_identifier_ref_map<const PapyrusFunction*> functions {};
+  caseless_unordered_identifier_ref_map<const PapyrusFunction*> events {};
+  caseless_unordered_identifier_ref_map<const PapyrusCustomEvent*> customEvents {};
+  caseless_unordered_identifier_ref_map<const PapyrusState*> states {};
+};
+
 struct PapyrusObject final {
   identifier_ref name { "" };
   identifier_ref documentationString { "" };
@@ -90,16 +112,32 @@ struct PapyrusObject final {
   }
 
   const PapyrusObject* tryGetParentClass() const;
-  void buildPex(CapricaReportingContext& repCtx, pex::PexFile* file) const;
+  void buildPex(CapricaReportingContext& repCtx, pex::PexFile* file, CapricaJobManager* jobManager) const;
   void semantic(PapyrusResolutionContext* ctx);
   void semantic2(PapyrusResolutionContext* ctx);
 
   void preSemantic(PapyrusResolutionContext* ctx) {
     resolutionState = PapyrusResoultionState::PreSemanticInProgress;
     parentClass = ctx->resolveType(parentClass, true);
+    buildSymbolTables();
     resolutionState = PapyrusResoultionState::PreSemanticCompleted;
   }
 
+  // Only valid once the pre-semantic pass has completed.
+  const PapyrusObjectMemberSymbols* tryFindMemberSymbols(const identifier_ref& name) const {
+    auto f = memberSymbols.find(name);
+    if (f != memberSymbols.end())
+      return &f->second;
+    return nullptr;
+  }
+
+  // Returns nullptr until the semantic pass of this object has completed.
+  const PapyrusObjectInheritedSymbols* tryGetInheritedSymbols() const {
+    if (inheritedSymbolsBuilt.load(std::memory_order_acquire))
+      return &inheritedSymbols;
+    return nullptr;
+  }
+
   PapyrusObject* awaitSemantic() const;
 
 private:
@@ -112,7 +150,12 @@ private:
   PapyrusState* rootState { nullptr };
   PapyrusPropertyGroup* rootPropertyGroup { nullptr };
   std::string lowerName {};
+  caseless_unordered_identifier_ref_map<PapyrusObjectMemberSymbols> memberSymbols {};
+  PapyrusObjectInheritedSymbols inheritedSymbols {};
+  std::atomic<bool> inheritedSymbolsBuilt { false };
 
+  void buildSymbolTables();
+  void buildInheritedSymbols();
   void
   checkForInheritedIdentifierConflicts(CapricaReportingContext& repCtx,
                                        caseless_unordered_identifier_ref_map<std::pair<bool, identifier_ref>>& identMap,
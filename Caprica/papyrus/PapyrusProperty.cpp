@@ -21,7 +21,7 @@ void PapyrusProperty::buildPex(CapricaReportingContext& repCtx, pex::PexFile* fi
     func->returnTypeName = prop->typeName;
     func->documentationString = file->getString("");
     func->instructions.push_back(
-        file->alloc->make<pex::PexInstruction>(pex::PexOpCode::Return, defaultValue.buildPex(file)));
+        pex::PexInstruction(func->operands, pex::PexOpCode::Return, { defaultValue.buildPex(file) }));
     prop->readFunction = func;
 
     if (file->debugInfo) {
@@ -9,9 +9,7 @@
 #include <common/CapricaReportingContext.h>
 #include <common/FSUtils.h>
 
-#include <papyrus/expressions/PapyrusCastExpression.h>
 #include <papyrus/expressions/PapyrusExpression.h>
-#include <papyrus/expressions/PapyrusLiteralExpression.h>
 #include <papyrus/PapyrusCompilationContext.h>
 #include <papyrus/PapyrusCustomEvent.h>
 #include <papyrus/PapyrusFunction.h>
@@ -37,6 +35,9 @@ void PapyrusResolutionContext::addImport(const CapricaFileLocation& location, id
     if (o == retNode)
       reportingContext.error(location, "Duplicate import of '{}'.", import);
   importedNodes.push_back(retNode);
+  importedGlobalFunctions.clear();
+  importedGlobalFunctionsBuilt = false;
+  resolvedTypeMemo.clear();
 }
 
 bool PapyrusResolutionContext::isObjectSomeParentOf(const PapyrusObject* child, const PapyrusObject* parent) {
@@ -156,17 +157,19 @@ bool PapyrusResolutionContext::canImplicitlyCoerce(CapricaFileLocation loc,
   CapricaReportingContext::logicalFatal("Unknown PapyrusTypeKind!");
 }
 
-bool PapyrusResolutionContext::canImplicitlyCoerceExpression(expressions::PapyrusExpression* expr,
+bool PapyrusResolutionContext::canImplicitlyCoerceExpression(expressions::PapyrusExpressionId expr,
                                                              const PapyrusType& target) const {
+  auto& exprs = *expressionStore;
   switch (target.type) {
     case PapyrusType::Kind::Var:
     case PapyrusType::Kind::Array:
     case PapyrusType::Kind::ResolvedObject:
     case PapyrusType::Kind::ResolvedStruct:
       // Implicit conversion from None to each of these is allowed, but only for a literal None
-      if (expr->resultType().type == PapyrusType::Kind::None && expr->asLiteralExpression())
+      if (exprs.resultType(expr).type == PapyrusType::Kind::None &&
+          exprs.kind(expr) == expressions::PapyrusExpressionKind::Literal)
         return true;
-      return canImplicitlyCoerce(expr->location, expr->resultType(), target);
+      return canImplicitlyCoerce(exprs.location(expr), exprs.resultType(expr), target);
 
     case PapyrusType::Kind::Bool:
     case PapyrusType::Kind::Int:
@@ -176,33 +179,31 @@ bool PapyrusResolutionContext::canImplicitlyCoerceExpression(expressions::Papyru
     case PapyrusType::Kind::ScriptEventName:
     case PapyrusType::Kind::Unresolved:
     case PapyrusType::Kind::None:
-      return canImplicitlyCoerce(expr->location, expr->resultType(), target);
+      return canImplicitlyCoerce(exprs.location(expr), exprs.resultType(expr), target);
   }
   CapricaReportingContext::logicalFatal("Unknown PapyrusTypeKind!");
 }
 
-expressions::PapyrusExpression* PapyrusResolutionContext::coerceExpression(expressions::PapyrusExpression* expr,
-                                                                           const PapyrusType& target) const {
-  if (expr->resultType() != target) {
+expressions::PapyrusExpressionId PapyrusResolutionContext::coerceExpression(expressions::PapyrusExpressionId expr,
+                                                                            const PapyrusType& target) const {
+  auto& exprs = *expressionStore;
+  auto exprType = exprs.resultType(expr);
+  if (exprType != target) {
     bool canCast = canImplicitlyCoerceExpression(expr, target);
 
-    if (canCast && expr->resultType().type == PapyrusType::Kind::Int && target.type == PapyrusType::Kind::Float) {
-      if (auto le = expr->asLiteralExpression()) {
-        le->value = PapyrusValue::Float(le->value.location, (float)le->value.val.i);
+    if (canCast && exprType.type == PapyrusType::Kind::Int && target.type == PapyrusType::Kind::Float) {
+      if (exprs.kind(expr) == expressions::PapyrusExpressionKind::Literal) {
+        auto& val = exprs.value(expr);
+        val = PapyrusValue::Float(val.location, (float)val.val.i);
         return expr;
       }
     }
 
     if (!canCast) {
-      reportingContext.error(expr->location,
-                             "No implicit conversion from '{}' to '{}' exists!",
-                             expr->resultType(),
-                             target);
+      reportingContext.error(exprs.location(expr), "No implicit conversion from '{}' to '{}' exists!", exprType, target);
       return expr;
     }
-    auto ce = allocator->make<expressions::PapyrusCastExpression>(expr->location, target);
-    ce->innerExpression = expr;
-    return ce;
+    return exprs.makeCast(exprs.location(expr), expr, target);
   }
   return expr;
 }
@@ -232,10 +233,6 @@ PapyrusValue PapyrusResolutionContext::coerceDefaultValue(const PapyrusValue& va
   return val;
 }
 
-void PapyrusResolutionContext::checkForPoison(const expressions::PapyrusExpression* expr) const {
-  checkForPoison(expr->resultType());
-}
-
 void PapyrusResolutionContext::checkForPoison(const PapyrusType& type) const {
   if (type.isPoisoned(PapyrusType::PoisonKind::Beta)) {
     if (function != nullptr && function->isBetaOnly())
@@ -258,6 +255,11 @@ CheckDebug:
 
 const PapyrusFunction* PapyrusResolutionContext::tryResolveEvent(const PapyrusObject* parentObj,
                                                                  const identifier_ref& name) const {
+  if (auto symbols = parentObj->tryGetInheritedSymbols()) {
+    auto f = symbols->events.find(name);
+    return f != symbols->events.end() ? f->second : nullptr;
+  }
+
   auto func = parentObj->getRootState()->functions.find(name);
   if (func != parentObj->getRootState()->functions.end() && func->second->functionType == PapyrusFunctionType::Event)
     return func->second;
@@ -270,6 +272,11 @@ const PapyrusFunction* PapyrusResolutionContext::tryResolveEvent(const PapyrusOb
 
 const PapyrusCustomEvent* PapyrusResolutionContext::tryResolveCustomEvent(const PapyrusObject* parentObj,
                                                                           const identifier_ref& name) const {
+  if (auto symbols = parentObj->tryGetInheritedSymbols()) {
+    auto f = symbols->customEvents.find(name);
+    return f != symbols->customEvents.end() ? f->second : nullptr;
+  }
+
   for (auto c : parentObj->customEvents)
     if (idEq(c->name, name))
       return c;
@@ -285,6 +292,11 @@ const PapyrusState* PapyrusResolutionContext::tryResolveState(const identifier_r
   if (!parentObj)
     parentObj = object;
 
+  if (auto symbols = parentObj->tryGetInheritedSymbols()) {
+    auto f = symbols->states.find(name);
+    return f != symbols->states.end() ? f->second : nullptr;
+  }
+
   for (auto s : parentObj->states)
     if (idEq(s->name, name))
       return s;
@@ -354,11 +366,27 @@ PapyrusType PapyrusResolutionContext::resolveType(PapyrusType tp, bool lazy) {
       return PapyrusType::ResolvedObject(tp.location, object);
   }
 
+  if (resolvedTypeMemoObject != object) {
+    resolvedTypeMemo.clear();
+    resolvedTypeMemoObject = object;
+  }
+  auto memo = resolvedTypeMemo.find(tp.name);
+  if (memo != resolvedTypeMemo.end()) {
+    // We still have to wait for the same pass as the original lookup did.
+    auto obj = lazy ? memo->second.node->awaitPreSemantic() : memo->second.node->awaitSemantic();
+    if (memo->second.struc)
+      return PapyrusType::ResolvedStruct(tp.location, memo->second.struc);
+    return PapyrusType::ResolvedObject(tp.location, obj);
+  }
+
   for (auto node : importedNodes) {
     auto obj = lazy ? node->awaitPreSemantic() : node->awaitSemantic();
-    for (auto struc : obj->structs)
-      if (idEq(struc->name, tp.name))
+    for (auto struc : obj->structs) {
+      if (idEq(struc->name, tp.name)) {
+        resolvedTypeMemo.emplace(tp.name, ResolvedTypeMemoEntry { node, struc });
         return PapyrusType::ResolvedStruct(tp.location, struc);
+      }
+    }
   }
 
   PapyrusCompilationNode* retNode { nullptr };
@@ -371,30 +399,49 @@ PapyrusType PapyrusResolutionContext::resolveType(PapyrusType tp, bool lazy) {
   }
 
   PapyrusObject* foundObj = lazy ? retNode->awaitPreSemantic() : retNode->awaitSemantic();
-  if (retStructName.size() == 0)
+  if (retStructName.size() == 0) {
+    resolvedTypeMemo.emplace(tp.name, ResolvedTypeMemoEntry { retNode, nullptr });
     return PapyrusType::ResolvedObject(tp.location, foundObj);
+  }
 
   const PapyrusStruct* resStruct = nullptr;
-  if (tryResolveStruct(foundObj, retStructName, &resStruct))
+  if (tryResolveStruct(foundObj, retStructName, &resStruct)) {
+    resolvedTypeMemo.emplace(tp.name, ResolvedTypeMemoEntry { retNode, resStruct });
     return PapyrusType::ResolvedStruct(tp.location, resStruct);
+  }
   reportingContext.fatal(tp.location,
                          "Unable to resolve a struct named '{}' in script '{}'!",
                          retStructName,
                          foundObj->name);
 }
 
-void PapyrusResolutionContext::addLocalVariable(statements::PapyrusDeclareStatement* local) {
-  for (auto is : localVariableScopeStack) {
-    for (auto n : is->locals) {
-      if (idEq(n->name, local->name)) {
-        reportingContext.error(local->location,
-                               "Attempted to redefined '{}' which was already defined in a parent scope!",
-                               local->name);
-        return;
+const caseless_unordered_identifier_ref_map<const PapyrusFunction*>&
+PapyrusResolutionContext::getImportedGlobalFunctions() const {
+  if (!importedGlobalFunctionsBuilt) {
+    // The first import that defines a global function of a given name wins.
+    for (auto node : importedNodes) {
+      if (auto rootState = node->awaitSemantic()->getRootState()) {
+        for (auto& f : rootState->functions) {
+          if (f.second->isGlobal())
+            importedGlobalFunctions.emplace(f.first, f.second);
+        }
       }
     }
+    importedGlobalFunctionsBuilt = true;
   }
-  localVariableScopeStack.top()->locals.push_back(allocator->make<LocalScopeVariableNode>(local->name, local));
+  return importedGlobalFunctions;
+}
+
+void PapyrusResolutionContext::addLocalVariable(statements::PapyrusDeclareStatement* local) {
+  if (visibleLocals.find(local->name) != visibleLocals.end()) {
+    reportingContext.error(local->location,
+                           "Attempted to redefined '{}' which was already defined in a parent scope!",
+                           local->name);
+    return;
+  }
+  auto node = allocator->make<LocalScopeVariableNode>(local->name, local);
+  localVariableScopeStack.top()->locals.push_back(node);
+  visibleLocals.emplace(node->name, node);
   // we discard the result, we just need to check to see if it conflicts with anything
   tryResolveIdentifier(PapyrusIdentifier::Unresolved(local->location, local->name));
 }
@@ -422,6 +469,7 @@ PapyrusIdentifier PapyrusResolutionContext::tryResolveIdentifier(const PapyrusId
     return ident;
   bool ignoreConflicts = conf::Papyrus::ignorePropertyNameLocalConflicts;
   std::vector<PapyrusIdentifier> resolvedIds;
+  auto members = object->tryFindMemberSymbols(ident.res.name);
 
   if (function) {
     if ((idEq(function->name, "getstate") || idEq(function->name, "gotostate")) && idEq(ident.res.name, "__state")) {
@@ -431,12 +479,9 @@ PapyrusIdentifier PapyrusResolutionContext::tryResolveIdentifier(const PapyrusId
     }
 
     // Parameters are allowed to have the same name as properties, and properties override them
-    if (!function->isGlobal()) {
-      for (auto pg : object->propertyGroups) {
-        for (auto p : pg->properties)
-          if (idEq(p->name, ident.res.name))
-            resolvedIds.push_back(PapyrusIdentifier::Property(ident.location, p));
-      }
+    if (!function->isGlobal() && members) {
+      for (auto p : members->properties)
+        resolvedIds.push_back(PapyrusIdentifier::Property(ident.location, p));
     }
 
     for (auto p : function->parameters)
@@ -444,29 +489,24 @@ PapyrusIdentifier PapyrusResolutionContext::tryResolveIdentifier(const PapyrusId
         resolvedIds.push_back(PapyrusIdentifier::FunctionParameter(ident.location, p));
   }
 
-  if (!function || !function->isGlobal()) {
-    for (auto v : object->variables)
-      if (idEq(v->name, ident.res.name))
-        resolvedIds.push_back(PapyrusIdentifier::Variable(ident.location, v));
+  if ((!function || !function->isGlobal()) && members) {
+    for (auto v : members->variables)
+      resolvedIds.push_back(PapyrusIdentifier::Variable(ident.location, v));
 
-    for (auto g : object->guards)
-      if (idEq(g->name, ident.res.name))
-        resolvedIds.push_back(PapyrusIdentifier::Guard(ident.location, g));
+    for (auto g : members->guards)
+      resolvedIds.push_back(PapyrusIdentifier::Guard(ident.location, g));
   }
   // locals get resolved dead last
   // This handles local var resolution.
   if (function) {
-    for (auto stack : localVariableScopeStack) {
-      for (auto n : stack->locals) {
-        if (idEq(n->name, ident.res.name)) {
-          if (conf::Papyrus::game == GameID::Skyrim && conf::Skyrim::skyrimAllowLocalUseBeforeDeclaration &&
-              ident.location.startOffset < n->declareStatement->location.startOffset) {
-            reportingContext.warning_W7003_Skyrim_Local_Use_Before_Declaration(ident.location,
-                                                                               ident.res.name);
-          }
-          resolvedIds.push_back(PapyrusIdentifier::DeclStatement(ident.location, n->declareStatement));
-        }
+    auto f = visibleLocals.find(ident.res.name);
+    if (f != visibleLocals.end()) {
+      auto n = f->second;
+      if (conf::Papyrus::game == GameID::Skyrim && conf::Skyrim::skyrimAllowLocalUseBeforeDeclaration &&
+          ident.location.startOffset < n->declareStatement->location.startOffset) {
+        reportingContext.warning_W7003_Skyrim_Local_Use_Before_Declaration(ident.location, ident.res.name);
       }
+      resolvedIds.push_back(PapyrusIdentifier::DeclStatement(ident.location, n->declareStatement));
     }
   }
 
@@ -588,15 +628,20 @@ PapyrusIdentifier PapyrusResolutionContext::tryResolveMemberIdentifier(const Pap
 
   if (baseType.type == PapyrusType::Kind::ResolvedStruct) {
     baseType.resolved.struc->parentObject->awaitSemantic();
-    for (auto& sm : baseType.resolved.struc->members)
-      if (idEq(sm->name, ident.res.name))
-        return PapyrusIdentifier::StructMember(ident.location, sm);
+    if (auto sm = baseType.resolved.struc->tryFindMember(ident.res.name))
+      return PapyrusIdentifier::StructMember(ident.location, sm);
   } else if (baseType.type == PapyrusType::Kind::ResolvedObject) {
-    for (auto& propGroup : baseType.resolved.obj->awaitSemantic()->propertyGroups) {
-      for (auto& prop : propGroup->properties)
-        if (idEq(prop->name, ident.res.name))
-          return PapyrusIdentifier::Property(ident.location, prop);
+    auto obj = baseType.resolved.obj->awaitSemantic();
+    if (auto symbols = obj->tryGetInheritedSymbols()) {
+      auto f = symbols->properties.find(ident.res.name);
+      if (f != symbols->properties.end())
+        return PapyrusIdentifier::Property(ident.location, f->second);
+      return ident;
     }
+
+    auto members = obj->tryFindMemberSymbols(ident.res.name);
+    if (members && !members->properties.empty())
+      return PapyrusIdentifier::Property(ident.location, members->properties.front());
     // TODO: Starfield: Verify that child classes cannot use guards inherited from parent classes.
 
     if (auto parentClass = baseType.resolved.obj->tryGetParentClass())
@@ -636,15 +681,9 @@ PapyrusIdentifier PapyrusResolutionContext::tryResolveFunctionIdentifier(const P
       }
     }
 
-    for (auto node : importedNodes) {
-      if (auto rootState = node->awaitSemantic()->getRootState()) {
-        auto func = rootState->functions.find(ident.res.name);
-        if (func != rootState->functions.end()) {
-          if (func->second->isGlobal() && idEq(func->second->name, ident.res.name))
-            return PapyrusIdentifier::Function(ident.location, func->second);
-        }
-      }
-    }
+    auto func = getImportedGlobalFunctions().find(ident.res.name);
+    if (func != importedGlobalFunctions.end())
+      return PapyrusIdentifier::Function(ident.location, func->second);
 
     return tryResolveFunctionIdentifier(PapyrusType::ResolvedObject(ident.location, object), ident, wantGlobal);
   } else if (baseType.type == PapyrusType::Kind::Array) {
@@ -685,7 +724,21 @@ PapyrusIdentifier PapyrusResolutionContext::tryResolveFunctionIdentifier(const P
                                             fk,
                                             allocator->make<PapyrusType>(baseType.getElementType()));
   } else if (baseType.type == PapyrusType::Kind::ResolvedObject) {
-    if (auto rootState = baseType.resolved.obj->awaitSemantic()->getRootState()) {
+    auto obj = baseType.resolved.obj->awaitSemantic();
+    if (auto symbols = obj->tryGetInheritedSymbols()) {
+      auto func = symbols->functions.find(ident.res.name);
+      if (func != symbols->functions.end()) {
+        if (!wantGlobal && func->second->isGlobal()) {
+          reportingContext.error(ident.location,
+                                 "You cannot call the global function '{}' on an object.",
+                                 func->second->name);
+        }
+        return PapyrusIdentifier::Function(ident.location, func->second);
+      }
+      return ident;
+    }
+
+    if (auto rootState = obj->getRootState()) {
       auto func = rootState->functions.find(ident.res.name);
       if (func != rootState->functions.end()) {
         if (!wantGlobal && func->second->isGlobal()) {
@@ -6,6 +6,7 @@
 
 #include <common/allocators/ChainedPool.h>
 #include <common/CapricaFileLocation.h>
+#include <common/CapricaJobManager.h>
 #include <common/CaselessStringComparer.h>
 #include <common/identifier_ref.h>
 #include <common/IntrusiveLinkedList.h>
@@ -24,9 +25,11 @@ struct PapyrusFunction;
 struct PapyrusObject;
 struct PapyrusScript;
 struct PapyrusState;
+struct PapyrusStruct;
 
 namespace expressions {
-struct PapyrusExpression;
+struct PapyrusExpressionId;
+struct PapyrusExpressionStore;
 }
 namespace statements {
 struct PapyrusDeclareStatement;
@@ -42,26 +45,38 @@ struct PapyrusResolutionContext final {
   const PapyrusObject* object { nullptr };
   const PapyrusState* state { nullptr };
   const PapyrusFunction* function { nullptr };
+  // The expressions of the function being resolved.
+  expressions::PapyrusExpressionStore* expressionStore { nullptr };
   // If true, we're resolving a tree generated from
   // a pex file.
   bool isPexResolution { false };
+  // When set, the function bodies of big states are resolved in parallel.
+  CapricaJobManager* jobManager { nullptr };
 
   void addImport(const CapricaFileLocation& location, identifier_ref import);
-  void clearImports() { importedNodes.clear(); }
+  void clearImports() {
+    importedNodes.clear();
+    importedGlobalFunctions.clear();
+    importedGlobalFunctionsBuilt = false;
+    resolvedTypeMemo.clear();
+  }
 
   static bool isObjectSomeParentOf(const PapyrusObject* child, const PapyrusObject* parent);
   bool canExplicitlyCast(CapricaFileLocation loc, const PapyrusType& src, const PapyrusType& dest) const;
   bool canImplicitlyCoerce(CapricaFileLocation loc, const PapyrusType& src, const PapyrusType& dest) const;
-  bool canImplicitlyCoerceExpression(expressions::PapyrusExpression* expr, const PapyrusType& target) const;
-  expressions::PapyrusExpression* coerceExpression(expressions::PapyrusExpression* expr,
-                                                   const PapyrusType& target) const;
+  bool canImplicitlyCoerceExpression(expressions::PapyrusExpressionId expr, const PapyrusType& target) const;
+  expressions::PapyrusExpressionId coerceExpression(expressions::PapyrusExpressionId expr,
+                                                    const PapyrusType& target) const;
   PapyrusValue coerceDefaultValue(const PapyrusValue& val, const PapyrusType& target) const;
 
-  void checkForPoison(const expressions::PapyrusExpression* expr) const;
   void checkForPoison(const PapyrusType& type) const;
 
   void pushLocalVariableScope() { localVariableScopeStack.push(allocator->make<LocalScopeStackNode>()); }
-  void popLocalVariableScope() { localVariableScopeStack.pop(); }
+  void popLocalVariableScope() {
+    for (auto n : localVariableScopeStack.top()->locals)
+      visibleLocals.erase(n->name);
+    localVariableScopeStack.pop();
+  }
 
   bool canBreak() const { return currentBreakScopeDepth > 0; }
   void pushBreakScope() { currentBreakScopeDepth++; }
@@ -123,6 +138,16 @@ struct PapyrusResolutionContext final {
   }
 
   explicit PapyrusResolutionContext(CapricaReportingContext& repCtx) : reportingContext(repCtx) { }
+  // A context for resolving function bodies on another thread, in the same
+  // script, object, state and imports as parent.
+  explicit PapyrusResolutionContext(const PapyrusResolutionContext& parent, allocators::ChainedPool* alloc)
+      : reportingContext(parent.reportingContext),
+        allocator(alloc),
+        script(parent.script),
+        object(parent.object),
+        state(parent.state),
+        isPexResolution(parent.isPexResolution),
+        importedNodes(parent.importedNodes) { }
   PapyrusResolutionContext(const PapyrusResolutionContext&) = delete;
   ~PapyrusResolutionContext() = default;
 
@@ -146,9 +171,27 @@ private:
     LocalScopeStackNode* nextInStack { nullptr };
   };
   IntrusiveStack<LocalScopeStackNode> localVariableScopeStack {};
+  // Every local in the scope stack, keyed by name. A local can't redefine one
+  // from a parent scope, so there is never more than one visible per name.
+  caseless_unordered_identifier_ref_map<LocalScopeVariableNode*> visibleLocals {};
   std::vector<PapyrusCompilationNode*> importedNodes {};
+  // The global functions visible through importedNodes, built on first use
+  // because it requires the semantic pass of every import to have completed.
+  mutable caseless_unordered_identifier_ref_map<const PapyrusFunction*> importedGlobalFunctions {};
+  mutable bool importedGlobalFunctionsBuilt { false };
+  struct ResolvedTypeMemoEntry final {
+    PapyrusCompilationNode* node { nullptr };
+    const PapyrusStruct* struc { nullptr };
+  };
+  // Types that resolveType found through the imports or the namespace tree,
+  // keyed by the name they were referenced by. The result depends on the
+  // current object and its imports, so it's cleared whenever those change.
+  caseless_unordered_identifier_ref_map<ResolvedTypeMemoEntry> resolvedTypeMemo {};
+  const PapyrusObject* resolvedTypeMemoObject { nullptr };
   size_t currentBreakScopeDepth { 0 };
   size_t currentContinueScopeDepth { 0 };
+
+  const caseless_unordered_identifier_ref_map<const PapyrusFunction*>& getImportedGlobalFunctions() const;
 };
 
 }}
@@ -8,7 +8,7 @@
 
 namespace caprica { namespace papyrus {
 
-pex::PexFile* PapyrusScript::buildPex(CapricaReportingContext& repCtx) const {
+pex::PexFile* PapyrusScript::buildPex(CapricaReportingContext& repCtx, CapricaJobManager* jobManager) const {
   auto alloc = new allocators::ChainedPool(1024 * 4);
   auto pex = alloc->make<pex::PexFile>(alloc);
   pex->setGameAndVersion(conf::Papyrus::game);
@@ -40,7 +40,7 @@ pex::PexFile* PapyrusScript::buildPex(CapricaReportingContext& repCtx) const {
   pex->userName = userName;
 
   for (auto o : objects)
-    o->buildPex(repCtx, pex);
+    o->buildPex(repCtx, pex, jobManager);
 
   if (objects.size()) {
     EngineLimits::checkLimit(repCtx,
@@ -51,4 +51,29 @@ pex::PexFile* PapyrusScript::buildPex(CapricaReportingContext& repCtx) const {
   return pex;
 }
 
+void PapyrusScript::releaseFunctionBodies() {
+  for (auto o : objects) {
+    for (auto s : o->states) {
+      for (auto& f : s->functions) {
+        f.second->statements = {};
+        f.second->expressionStore = nullptr;
+      }
+    }
+    for (auto pg : o->propertyGroups) {
+      for (auto p : pg->properties) {
+        if (p->readFunction) {
+          p->readFunction->statements = {};
+          p->readFunction->expressionStore = nullptr;
+        }
+        if (p->writeFunction) {
+          p->writeFunction->statements = {};
+          p->writeFunction->expressionStore = nullptr;
+        }
+      }
+    }
+  }
+  delete bodyAllocator;
+  bodyAllocator = nullptr;
+}
+
 }}
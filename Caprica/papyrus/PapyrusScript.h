@@ -22,12 +22,20 @@ struct PapyrusScript final {
   std::string sourceFileName { "" };
   IntrusiveLinkedList<PapyrusObject> objects {};
   allocators::ChainedPool* allocator { nullptr };
+  // The statements of the function bodies, which nothing outside the script
+  // ever looks at.
+  allocators::ChainedPool* bodyAllocator { nullptr };
 
   explicit PapyrusScript() = default;
   PapyrusScript(const PapyrusScript&) = delete;
-  ~PapyrusScript() = default;
-
-  pex::PexFile* buildPex(CapricaReportingContext& repCtx) const;
+  ~PapyrusScript() { delete bodyAllocator; }
+
+  // Building is split up between the workers of jobManager when one is
+  // given.
+  pex::PexFile* buildPex(CapricaReportingContext& repCtx, CapricaJobManager* jobManager) const;
+  // Frees the function bodies once the pex has been built, leaving what
+  // the scripts depending on this one resolve against.
+  void releaseFunctionBodies();
 
   void preSemantic(PapyrusResolutionContext* ctx) {
     ctx->script = this;
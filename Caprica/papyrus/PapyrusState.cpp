@@ -1,9 +1,133 @@
 #include <papyrus/PapyrusState.h>
 
+#include <vector>
+
+#include <common/allocators/ChainedPool.h>
+
 #include <papyrus/PapyrusObject.h>
 
 namespace caprica { namespace papyrus {
 
+void PapyrusState::buildPex(CapricaReportingContext& repCtx,
+                            pex::PexFile* file,
+                            pex::PexObject* obj,
+                            CapricaJobManager* jobManager) const {
+  auto state = file->alloc->make<pex::PexState>();
+  state->name = file->getString(name);
+
+  // Every skyrim script has these exact same functions
+  if (file->gameID == GameID::Skyrim && name == "") {
+    state->functions.push_back(makeGetState(repCtx, file, obj));
+    state->functions.push_back(makeGotoState(repCtx, file, obj));
+  }
+
+  size_t staticFunctionCount = 0;
+  for (auto& f : functions) {
+    if (f.second->isGlobal())
+      staticFunctionCount++;
+  }
+  if (jobManager && functions.size() > FunctionsPerJob) {
+    buildFunctionsInParallel(repCtx, file, obj, state, jobManager);
+  } else {
+    for (auto& f : functions)
+      state->functions.push_back(f.second->buildPex(repCtx, file, obj, state, pex::PexString()));
+  }
+
+  if (name == "") {
+    EngineLimits::checkLimit(repCtx,
+                             location,
+                             EngineLimits::Type::PexObject_EmptyStateFunctionCount,
+                             functions.size(),
+                             name);
+    EngineLimits::checkLimit(repCtx,
+                             location,
+                             EngineLimits::Type::PexObject_StaticFunctionCount,
+                             staticFunctionCount);
+  } else {
+    EngineLimits::checkLimit(repCtx, location, EngineLimits::Type::PexState_FunctionCount, functions.size(), name);
+  }
+
+  obj->states.push_back(state);
+}
+
+namespace {
+
+struct FunctionBuildJob final {
+  std::vector<const PapyrusFunction*> functions {};
+  allocators::ChainedPool* alloc { nullptr };
+  pex::PexFile* file { nullptr };
+  std::vector<pex::PexFunction*> built {};
+  CapricaReportingContext::DeferredMessages messages {};
+  CapricaFunctionJob* job { nullptr };
+};
+
+}
+
+// Each job builds its functions into a file of its own, which are then
+// copied into the real one in order. Merging the strings and user flags of
+// each of those files in the order they were added gives exactly the file
+// building them one after the other would have.
+void PapyrusState::buildFunctionsInParallel(CapricaReportingContext& repCtx,
+                                            pex::PexFile* file,
+                                            pex::PexObject* obj,
+                                            pex::PexState* state,
+                                            CapricaJobManager* jobManager) const {
+  std::vector<FunctionBuildJob> jobs((functions.size() + FunctionsPerJob - 1) / FunctionsPerJob);
+  size_t i = 0;
+  for (auto& f : functions)
+    jobs[i++ / FunctionsPerJob].functions.push_back(f.second);
+
+  const auto gameID = file->gameID;
+  const bool emitDebugInfo = file->debugInfo != nullptr;
+  for (auto& j : jobs) {
+    j.job = CapricaFunctionJob::make([&repCtx, &j, obj, state, gameID] {
+      j.alloc = new allocators::ChainedPool(1024 * 16);
+      j.file = j.alloc->make<pex::PexFile>(j.alloc);
+      j.file->setGameAndVersion(gameID);
+      // Only to find the line maps again afterwards.
+      j.file->ensureDebugInfo();
+      j.messages.capture([&] {
+        for (auto f : j.functions)
+          j.built.push_back(f->buildPex(repCtx, j.file, obj, state, pex::PexString()));
+      });
+    });
+    jobManager->queueJob(j.job);
+  }
+
+  for (auto& j : jobs) {
+    try {
+      j.job->awaitResult();
+    } catch (...) {
+      // The rest still refer to the jobs, so they have to be done first.
+      for (auto& other : jobs)
+        other.job->await();
+      j.messages.report();
+      throw;
+    }
+    j.messages.report();
+
+    auto stringMap = file->mergeStringsFrom(j.file);
+    const auto mapString = [&](const pex::PexString& str) { return stringMap[str.index]; };
+    auto builtDebInfo = j.file->debugInfo->functions.begin();
+    for (auto f : j.built) {
+      auto func = f->copy(file->alloc, mapString);
+      state->functions.push_back(func);
+      if (emitDebugInfo) {
+        auto fDebInfo = file->alloc->make<pex::PexDebugFunctionInfo>();
+        fDebInfo->objectName = obj->name;
+        fDebInfo->stateName = state->name;
+        fDebInfo->functionName = func->name;
+        fDebInfo->functionType = builtDebInfo->functionType;
+        fDebInfo->instructionLineMap = std::move(builtDebInfo->instructionLineMap);
+        file->debugInfo->functions.push_back(fDebInfo);
+      }
+      ++builtDebInfo;
+    }
+    delete j.alloc;
+    j.alloc = nullptr;
+  }
+}
+
 static const PapyrusFunction* searchRootStateForFunction(const identifier_ref& name, const PapyrusObject* obj) {
   auto f = obj->getRootState()->functions.find(name);
   if (f != obj->getRootState()->functions.end())
@@ -75,9 +199,60 @@ void PapyrusState::semantic2(PapyrusResolutionContext* ctx) {
     }
   }
 
-  for (auto f : functions)
-    f.second->semantic2(ctx);
+  if (ctx->jobManager && functions.size() > FunctionsPerJob) {
+    semantic2FunctionsInParallel(ctx);
+  } else {
+    for (auto f : functions)
+      f.second->semantic2(ctx);
+  }
   ctx->state = nullptr;
 }
 
+namespace {
+
+struct FunctionSemanticJob final {
+  std::vector<PapyrusFunction*> functions {};
+  allocators::ChainedPool* alloc { nullptr };
+  CapricaReportingContext::DeferredMessages messages {};
+  CapricaFunctionJob* job { nullptr };
+};
+
+}
+
+// A function body only reads the rest of the script, so each job resolves
+// its functions with a context of its own. What they report is held back and
+// reported in the order resolving them one after the other would have.
+void PapyrusState::semantic2FunctionsInParallel(PapyrusResolutionContext* ctx) {
+  std::vector<FunctionSemanticJob> jobs((functions.size() + FunctionsPerJob - 1) / FunctionsPerJob);
+  size_t i = 0;
+  for (auto& f : functions)
+    jobs[i++ / FunctionsPerJob].functions.push_back(f.second);
+
+  for (auto& j : jobs) {
+    // What the jobs allocate has to live as long as the script does.
+    j.alloc = ctx->allocator->make<allocators::ChainedPool>(1024 * 4);
+    j.job = CapricaFunctionJob::make([ctx, &j] {
+      PapyrusResolutionContext jobCtx { *ctx, j.alloc };
+      j.messages.capture([&] {
+        for (auto f : j.functions)
+          f->semantic2(&jobCtx);
+      });
+    });
+    ctx->jobManager->queueJob(j.job);
+  }
+
+  for (auto& j : jobs) {
+    try {
+      j.job->awaitResult();
+    } catch (...) {
+      // The rest still refer to the jobs, so they have to be done first.
+      for (auto& other : jobs)
+        other.job->await();
+      j.messages.report();
+      throw;
+    }
+    j.messages.report();
+  }
+}
+
 }}
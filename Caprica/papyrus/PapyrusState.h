@@ -1,5 +1,6 @@
 #pragma once
 
+#include <common/CapricaJobManager.h>
 #include <common/CaselessStringComparer.h>
 #include <common/EngineLimits.h>
 #include <common/identifier_ref.h>
@@ -25,39 +26,12 @@ struct PapyrusState final {
   PapyrusState(const PapyrusState&) = delete;
   ~PapyrusState() = default;
 
-  void buildPex(CapricaReportingContext& repCtx, pex::PexFile* file, pex::PexObject* obj) const {
-    auto state = file->alloc->make<pex::PexState>();
-    state->name = file->getString(name);
-
-    // Every skyrim script has these exact same functions
-    if (file->gameID == GameID::Skyrim && name == "") {
-      state->functions.push_back(makeGetState(repCtx, file, obj));
-      state->functions.push_back(makeGotoState(repCtx, file, obj));
-    }
-
-    size_t staticFunctionCount = 0;
-    for (auto& f : functions) {
-      if (f.second->isGlobal())
-        staticFunctionCount++;
-      state->functions.push_back(f.second->buildPex(repCtx, file, obj, state, pex::PexString()));
-    }
-
-    if (name == "") {
-      EngineLimits::checkLimit(repCtx,
-                               location,
-                               EngineLimits::Type::PexObject_EmptyStateFunctionCount,
-                               functions.size(),
-                               name);
-      EngineLimits::checkLimit(repCtx,
-                               location,
-                               EngineLimits::Type::PexObject_StaticFunctionCount,
-                               staticFunctionCount);
-    } else {
-      EngineLimits::checkLimit(repCtx, location, EngineLimits::Type::PexState_FunctionCount, functions.size(), name);
-    }
-
-    obj->states.push_back(state);
-  }
+  // The functions of a big state are built in parallel when a job manager
+  // is given.
+  void buildPex(CapricaReportingContext& repCtx,
+                pex::PexFile* file,
+                pex::PexObject* obj,
+                CapricaJobManager* jobManager) const;
 
   void semantic(PapyrusResolutionContext* ctx);
   void semantic2(PapyrusResolutionContext* ctx);
@@ -65,7 +39,18 @@ struct PapyrusState final {
 private:
   friend IntrusiveLinkedList<PapyrusState>;
   PapyrusState* next { nullptr };
-  
+
+  // How many functions each job handles when a state is split up between
+  // the workers.
+  static constexpr size_t FunctionsPerJob = 32;
+
+  void buildFunctionsInParallel(CapricaReportingContext& repCtx,
+                                pex::PexFile* file,
+                                pex::PexObject* obj,
+                                pex::PexState* state,
+                                CapricaJobManager* jobManager) const;
+  void semantic2FunctionsInParallel(PapyrusResolutionContext* ctx);
+
   // Generates GetState, which every Skyrim script has
   static pex::PexFunction* makeGetState(CapricaReportingContext& repCtx, pex::PexFile* file, pex::PexObject* obj) {
     auto fDebInfo = file->alloc->make<pex::PexDebugFunctionInfo>();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <common/CaselessStringComparer.h>
 #include <common/identifier_ref.h>
 #include <common/IntrusiveLinkedList.h>
 
@@ -50,9 +51,25 @@ struct PapyrusStruct final {
       m->semantic(ctx);
   }
 
+  void buildSymbolTable() {
+    memberTable.clear();
+    memberTable.reserve(members.size());
+    // The first declaration wins, duplicates are reported by the semantic pass.
+    for (auto m : members)
+      memberTable.emplace(m->name, m);
+  }
+
+  const PapyrusStructMember* tryFindMember(const identifier_ref& name) const {
+    auto f = memberTable.find(name);
+    if (f != memberTable.end())
+      return f->second;
+    return nullptr;
+  }
+
 private:
   friend IntrusiveLinkedList<PapyrusStruct>;
   PapyrusStruct* next { nullptr };
+  caseless_unordered_identifier_ref_map<const PapyrusStructMember*> memberTable {};
 };
 
 }}
@@ -0,0 +1,230 @@
+#include <papyrus/expressions/PapyrusExpression.h>
+
+#include <algorithm>
+
+#include <papyrus/PapyrusFunction.h>
+
+namespace caprica { namespace papyrus { namespace expressions {
+
+PapyrusExpressionId PapyrusExpressionStore::push(PapyrusExpressionNode&& n) {
+  PapyrusExpressionId id {};
+  id.index = (uint32_t)nodes.size();
+  nodes.push_back(std::move(n));
+  return id;
+}
+
+PapyrusExpressionId
+PapyrusExpressionStore::makeArrayIndex(CapricaFileLocation loc, PapyrusExpressionId base, PapyrusExpressionId index) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::ArrayIndex };
+  n.first = base;
+  n.second = index;
+  return push(std::move(n));
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeArrayLength(CapricaFileLocation loc) {
+  return push(PapyrusExpressionNode { loc, PapyrusExpressionKind::ArrayLength });
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeBinaryOp(CapricaFileLocation loc,
+                                                         PapyrusBinaryOperatorType operation,
+                                                         PapyrusExpressionId left,
+                                                         PapyrusExpressionId right) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::BinaryOp };
+  n.binaryOperation = operation;
+  n.first = left;
+  n.second = right;
+  return push(std::move(n));
+}
+
+PapyrusExpressionId
+PapyrusExpressionStore::makeCast(CapricaFileLocation loc, PapyrusExpressionId inner, PapyrusType targetType) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::Cast };
+  n.first = inner;
+  n.data = (uint32_t)types.size();
+  types.push_back(std::move(targetType));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeFunctionCall(CapricaFileLocation loc,
+                                                             PapyrusIdentifier function,
+                                                             const std::vector<PapyrusFunctionCallArgument>& args) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::FunctionCall };
+  n.data = (uint32_t)calls.size();
+  PapyrusFunctionCall c { std::move(function) };
+  c.firstArgument = (uint32_t)arguments.size();
+  c.argumentCount = (uint32_t)args.size();
+  arguments.insert(arguments.end(), args.begin(), args.end());
+  calls.push_back(std::move(c));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeIdentifier(CapricaFileLocation loc, PapyrusIdentifier identifier) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::Identifier };
+  n.data = (uint32_t)identifiers.size();
+  identifiers.push_back(std::move(identifier));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId
+PapyrusExpressionStore::makeIs(CapricaFileLocation loc, PapyrusExpressionId inner, PapyrusType targetType) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::Is };
+  n.first = inner;
+  n.data = (uint32_t)types.size();
+  types.push_back(std::move(targetType));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeLiteral(CapricaFileLocation loc, PapyrusValue value) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::Literal };
+  n.data = (uint32_t)values.size();
+  values.push_back(std::move(value));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId
+PapyrusExpressionStore::makeMemberAccess(CapricaFileLocation loc, PapyrusExpressionId base, PapyrusExpressionId access) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::MemberAccess };
+  n.first = base;
+  n.second = access;
+  return push(std::move(n));
+}
+
+PapyrusExpressionId
+PapyrusExpressionStore::makeNewArray(CapricaFileLocation loc, PapyrusType elementType, PapyrusExpressionId length) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::NewArray };
+  n.first = length;
+  n.data = (uint32_t)types.size();
+  types.push_back(std::move(elementType));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeNewStruct(CapricaFileLocation loc, PapyrusType type) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::NewStruct };
+  n.data = (uint32_t)types.size();
+  types.push_back(std::move(type));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeParent(CapricaFileLocation loc, PapyrusType type) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::Parent };
+  n.data = (uint32_t)types.size();
+  types.push_back(std::move(type));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeSelf(CapricaFileLocation loc, PapyrusType type) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::Self };
+  n.data = (uint32_t)types.size();
+  types.push_back(std::move(type));
+  return push(std::move(n));
+}
+
+PapyrusExpressionId PapyrusExpressionStore::makeUnaryOp(CapricaFileLocation loc,
+                                                        PapyrusUnaryOperatorType operation,
+                                                        PapyrusExpressionId inner) {
+  PapyrusExpressionNode n { loc, PapyrusExpressionKind::UnaryOp };
+  n.unaryOperation = operation;
+  n.first = inner;
+  return push(std::move(n));
+}
+
+std::vector<PapyrusFunctionCallArgument> PapyrusExpressionStore::copyArguments(PapyrusExpressionId id) const {
+  auto& c = call(id);
+  return std::vector<PapyrusFunctionCallArgument>(arguments.begin() + c.firstArgument,
+                                                  arguments.begin() + c.firstArgument + c.argumentCount);
+}
+
+// Rewrites the arguments in place when they fit, and otherwise moves them to
+// the end. What they used to occupy is left unused.
+void PapyrusExpressionStore::setArguments(PapyrusExpressionId id, const std::vector<PapyrusFunctionCallArgument>& args) {
+  auto& c = call(id);
+  if (args.size() > c.argumentCount) {
+    c.firstArgument = (uint32_t)arguments.size();
+    arguments.insert(arguments.end(), args.begin(), args.end());
+  } else {
+    std::copy(args.begin(), args.end(), arguments.begin() + c.firstArgument);
+  }
+  c.argumentCount = (uint32_t)args.size();
+}
+
+PapyrusType PapyrusExpressionStore::resultType(PapyrusExpressionId id) const {
+  auto& n = node(id);
+  switch (n.kind) {
+    case PapyrusExpressionKind::ArrayIndex: {
+      auto res = resultType(n.first);
+      if (res.type == PapyrusType::Kind::Array)
+        return res.getElementType();
+      return PapyrusType::None(n.location);
+    }
+    case PapyrusExpressionKind::ArrayLength:
+      return PapyrusType::Int(n.location);
+
+    case PapyrusExpressionKind::BinaryOp:
+      switch (n.binaryOperation) {
+        case PapyrusBinaryOperatorType::BooleanOr:
+        case PapyrusBinaryOperatorType::BooleanAnd:
+        case PapyrusBinaryOperatorType::CmpEq:
+        case PapyrusBinaryOperatorType::CmpNeq:
+        case PapyrusBinaryOperatorType::CmpLt:
+        case PapyrusBinaryOperatorType::CmpLte:
+        case PapyrusBinaryOperatorType::CmpGt:
+        case PapyrusBinaryOperatorType::CmpGte:
+          return PapyrusType::Bool(n.location);
+
+        case PapyrusBinaryOperatorType::Add:
+        case PapyrusBinaryOperatorType::Subtract:
+        case PapyrusBinaryOperatorType::Multiply:
+        case PapyrusBinaryOperatorType::Divide:
+        case PapyrusBinaryOperatorType::Modulus:
+          return resultType(n.first);
+
+        case PapyrusBinaryOperatorType::None:
+          break;
+      }
+      CapricaReportingContext::logicalFatal("Unknown PapyrusBinaryOperatorType!");
+
+    case PapyrusExpressionKind::Cast:
+    case PapyrusExpressionKind::NewArray:
+    case PapyrusExpressionKind::NewStruct:
+    case PapyrusExpressionKind::Parent:
+    case PapyrusExpressionKind::Self:
+      return type(id);
+
+    case PapyrusExpressionKind::FunctionCall: {
+      auto& c = call(id);
+      if (c.function.type == PapyrusIdentifierType::BuiltinArrayFunction) {
+        switch (c.function.arrayFuncKind) {
+          case PapyrusBuiltinArrayFunctionKind::Find:
+          case PapyrusBuiltinArrayFunctionKind::FindStruct:
+          case PapyrusBuiltinArrayFunctionKind::RFind:
+          case PapyrusBuiltinArrayFunctionKind::RFindStruct:
+            return PapyrusType::Int(n.location);
+          case PapyrusBuiltinArrayFunctionKind::GetMatchingStructs:
+            return PapyrusType::Array(n.location, c.function.res.arrayFuncElementType);
+          default:
+            return PapyrusType::None(n.location);
+        }
+      }
+      if (c.isPoisonedReturn)
+        return PapyrusType::PoisonedNone(n.location, c.function.res.func->returnType);
+      return c.function.res.func->returnType;
+    }
+
+    case PapyrusExpressionKind::Identifier:
+      return identifier(id).resultType();
+    case PapyrusExpressionKind::Is:
+      return PapyrusType::Bool(n.location);
+    case PapyrusExpressionKind::Literal:
+      return value(id).getPapyrusType();
+    case PapyrusExpressionKind::MemberAccess:
+      return resultType(n.second);
+
+    case PapyrusExpressionKind::UnaryOp:
+      if (n.unaryOperation == PapyrusUnaryOperatorType::Not)
+        return PapyrusType::Bool(n.location);
+      return resultType(n.first);
+  }
+  CapricaReportingContext::logicalFatal("Unknown PapyrusExpressionKind!");
+}
+
+}}}
@@ -1,8 +1,16 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 #include <common/CapricaFileLocation.h>
+#include <common/identifier_ref.h>
+
+#include <papyrus/PapyrusIdentifier.h>
 #include <papyrus/PapyrusResolutionContext.h>
 #include <papyrus/PapyrusType.h>
+#include <papyrus/PapyrusValue.h>
 
 #include <pex/PexFile.h>
 #include <pex/PexFunctionBuilder.h>
@@ -10,36 +18,200 @@
 
 namespace caprica { namespace papyrus { namespace expressions {
 
-struct PapyrusArrayIndexExpression;
-struct PapyrusArrayLengthExpression;
-struct PapyrusFunctionCallExpression;
-struct PapyrusIdentifierExpression;
-struct PapyrusLiteralExpression;
-struct PapyrusMemberAccessExpression;
-struct PapyrusParentExpression;
-struct PapyrusCastExpression;
-
-struct PapyrusExpression abstract {
-  const CapricaFileLocation location;
-
-  explicit PapyrusExpression(CapricaFileLocation loc) : location(loc) { }
-  PapyrusExpression(const PapyrusExpression&) = delete;
-  virtual ~PapyrusExpression() = default;
-
-  virtual pex::PexValue generateLoad(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const = 0;
-  virtual void semantic(PapyrusResolutionContext* ctx) = 0;
-  virtual PapyrusType resultType() const = 0;
-
-  // These exist because dynamic_cast is slow.
-  // This list only contains expressions that we actually check for.
-  virtual PapyrusArrayLengthExpression* asArrayLengthExpression() { return nullptr; }
-  virtual PapyrusArrayIndexExpression* asArrayIndexExpression() { return nullptr; }
-  virtual PapyrusFunctionCallExpression* asFunctionCallExpression() { return nullptr; }
-  virtual PapyrusIdentifierExpression* asIdentifierExpression() { return nullptr; }
-  virtual PapyrusLiteralExpression* asLiteralExpression() { return nullptr; }
-  virtual PapyrusMemberAccessExpression* asMemberAccessExpression() { return nullptr; }
-  virtual PapyrusParentExpression* asParentExpression() { return nullptr; }
-  virtual PapyrusCastExpression* asCastExpression() { return nullptr; }
+enum class PapyrusExpressionKind : uint8_t {
+  ArrayIndex,
+  ArrayLength,
+  BinaryOp,
+  Cast,
+  FunctionCall,
+  Identifier,
+  Is,
+  Literal,
+  MemberAccess,
+  NewArray,
+  NewStruct,
+  Parent,
+  Self,
+  UnaryOp,
+};
+
+enum class PapyrusBinaryOperatorType : uint8_t {
+  None,
+
+  BooleanOr,
+  BooleanAnd,
+
+  CmpEq,
+  CmpNeq,
+  CmpLt,
+  CmpLte,
+  CmpGt,
+  CmpGte,
+
+  Add,
+  Subtract,
+
+  Multiply,
+  Divide,
+  Modulus,
+};
+
+enum class PapyrusUnaryOperatorType : uint8_t {
+  None,
+
+  Not,
+  Negate,
+};
+
+// The index of an expression in the store of the function it's in.
+struct PapyrusExpressionId final {
+  uint32_t index { std::numeric_limits<uint32_t>::max() };
+
+  explicit operator bool() const { return index != std::numeric_limits<uint32_t>::max(); }
+};
+
+// What each field means depends on the kind:
+//
+//   ArrayIndex    first: base, second: index
+//   ArrayLength   nothing, it's only ever the access of a MemberAccess
+//   BinaryOp      first: left, second: right, binaryOperation
+//   Cast, Is      first: inner, data: target type
+//   FunctionCall  data: call
+//   Identifier    data: identifier, isAssignmentContext
+//   Literal       data: value
+//   MemberAccess  first: base, second: access (ArrayLength, FunctionCall or Identifier)
+//   NewArray      first: length, data: array type
+//   NewStruct     data: type
+//   Parent, Self  data: type
+//   UnaryOp       first: inner, unaryOperation
+//
+// where data is an index into the types, identifiers, values or calls of the
+// store.
+struct PapyrusExpressionNode final {
+  CapricaFileLocation location;
+  PapyrusExpressionKind kind;
+  PapyrusBinaryOperatorType binaryOperation { PapyrusBinaryOperatorType::None };
+  PapyrusUnaryOperatorType unaryOperation { PapyrusUnaryOperatorType::None };
+  bool isAssignmentContext { false };
+  PapyrusExpressionId first {};
+  PapyrusExpressionId second {};
+  uint32_t data { 0 };
+
+  explicit PapyrusExpressionNode(CapricaFileLocation loc, PapyrusExpressionKind k) : location(loc), kind(k) { }
+};
+
+struct PapyrusFunctionCallArgument final {
+  identifier_ref name { "" };
+  size_t argIndex { 0 };
+  PapyrusExpressionId value {};
+};
+
+struct PapyrusFunctionCall final {
+  PapyrusIdentifier function;
+  // The arguments are a contiguous range of the store's arguments.
+  uint32_t firstArgument { 0 };
+  uint32_t argumentCount { 0 };
+  bool isPoisonedReturn { false };
+  bool shouldEmit { true };
+
+  explicit PapyrusFunctionCall(PapyrusIdentifier&& f) : function(std::move(f)) { }
+};
+
+// All of the expressions of a function body, in one array of nodes that refer
+// to each other by index, rather than a tree of separately allocated nodes.
+// The semantic pass adds nodes as it coerces expressions, so references into
+// the store don't survive a call that might add to it; hold ids instead.
+struct PapyrusExpressionStore final {
+  explicit PapyrusExpressionStore() = default;
+  PapyrusExpressionStore(const PapyrusExpressionStore&) = delete;
+  ~PapyrusExpressionStore() = default;
+
+  PapyrusExpressionId makeArrayIndex(CapricaFileLocation loc, PapyrusExpressionId base, PapyrusExpressionId index);
+  PapyrusExpressionId makeArrayLength(CapricaFileLocation loc);
+  PapyrusExpressionId makeBinaryOp(CapricaFileLocation loc,
+                                   PapyrusBinaryOperatorType operation,
+                                   PapyrusExpressionId left,
+                                   PapyrusExpressionId right);
+  PapyrusExpressionId makeCast(CapricaFileLocation loc, PapyrusExpressionId inner, PapyrusType targetType);
+  PapyrusExpressionId makeFunctionCall(CapricaFileLocation loc,
+                                       PapyrusIdentifier function,
+                                       const std::vector<PapyrusFunctionCallArgument>& args);
+  PapyrusExpressionId makeIdentifier(CapricaFileLocation loc, PapyrusIdentifier identifier);
+  PapyrusExpressionId makeIs(CapricaFileLocation loc, PapyrusExpressionId inner, PapyrusType targetType);
+  PapyrusExpressionId makeLiteral(CapricaFileLocation loc, PapyrusValue value);
+  PapyrusExpressionId makeMemberAccess(CapricaFileLocation loc, PapyrusExpressionId base, PapyrusExpressionId access);
+  PapyrusExpressionId makeNewArray(CapricaFileLocation loc, PapyrusType elementType, PapyrusExpressionId length);
+  PapyrusExpressionId makeNewStruct(CapricaFileLocation loc, PapyrusType type);
+  PapyrusExpressionId makeParent(CapricaFileLocation loc, PapyrusType type);
+  PapyrusExpressionId makeSelf(CapricaFileLocation loc, PapyrusType type);
+  PapyrusExpressionId makeUnaryOp(CapricaFileLocation loc, PapyrusUnaryOperatorType operation, PapyrusExpressionId inner);
+
+  PapyrusExpressionNode& node(PapyrusExpressionId id) { return nodes[id.index]; }
+  const PapyrusExpressionNode& node(PapyrusExpressionId id) const { return nodes[id.index]; }
+  PapyrusExpressionKind kind(PapyrusExpressionId id) const { return nodes[id.index].kind; }
+  const CapricaFileLocation& location(PapyrusExpressionId id) const { return nodes[id.index].location; }
+  PapyrusType& type(PapyrusExpressionId id) { return types[nodes[id.index].data]; }
+  const PapyrusType& type(PapyrusExpressionId id) const { return types[nodes[id.index].data]; }
+  PapyrusIdentifier& identifier(PapyrusExpressionId id) { return identifiers[nodes[id.index].data]; }
+  const PapyrusIdentifier& identifier(PapyrusExpressionId id) const { return identifiers[nodes[id.index].data]; }
+  PapyrusValue& value(PapyrusExpressionId id) { return values[nodes[id.index].data]; }
+  const PapyrusValue& value(PapyrusExpressionId id) const { return values[nodes[id.index].data]; }
+  PapyrusFunctionCall& call(PapyrusExpressionId id) { return calls[nodes[id.index].data]; }
+  const PapyrusFunctionCall& call(PapyrusExpressionId id) const { return calls[nodes[id.index].data]; }
+  const PapyrusFunctionCallArgument& argument(const PapyrusFunctionCall& c, size_t i) const {
+    return arguments[c.firstArgument + i];
+  }
+
+  void semantic(PapyrusResolutionContext* ctx, PapyrusExpressionId id);
+  PapyrusType resultType(PapyrusExpressionId id) const;
+  pex::PexValue generateLoad(pex::PexFile* file, pex::PexFunctionBuilder& bldr, PapyrusExpressionId id) const;
+  // Jumps to the target if the value of the expression is jumpIfTrue, and
+  // falls through otherwise. The jump itself is at the branch location.
+  void generateBranch(pex::PexFile* file,
+                      pex::PexFunctionBuilder& bldr,
+                      PapyrusExpressionId id,
+                      bool jumpIfTrue,
+                      pex::PexLabel* target,
+                      const CapricaFileLocation& branchLocation) const;
+  // Only valid for the ArrayIndex and MemberAccess kinds.
+  void generateStore(pex::PexFile* file, pex::PexFunctionBuilder& bldr, PapyrusExpressionId id, pex::PexValue val)
+      const;
+
+private:
+  std::vector<PapyrusExpressionNode> nodes {};
+  std::vector<PapyrusType> types {};
+  std::vector<PapyrusIdentifier> identifiers {};
+  std::vector<PapyrusValue> values {};
+  std::vector<PapyrusFunctionCall> calls {};
+  std::vector<PapyrusFunctionCallArgument> arguments {};
+
+  PapyrusExpressionId push(PapyrusExpressionNode&& n);
+  std::vector<PapyrusFunctionCallArgument> copyArguments(PapyrusExpressionId call) const;
+  void setArguments(PapyrusExpressionId call, const std::vector<PapyrusFunctionCallArgument>& args);
+
+  void semanticArrayIndex(PapyrusResolutionContext* ctx, PapyrusExpressionId id);
+  void semanticBinaryOp(PapyrusResolutionContext* ctx, PapyrusExpressionId id);
+  void semanticCast(PapyrusResolutionContext* ctx, PapyrusExpressionId id);
+  void semanticFunctionCall(PapyrusResolutionContext* ctx, PapyrusExpressionId id, PapyrusExpressionId base);
+  void semanticBuiltinArrayFunctionCall(PapyrusResolutionContext* ctx, PapyrusExpressionId id);
+  void semanticMemberAccess(PapyrusResolutionContext* ctx, PapyrusExpressionId id);
+  void semanticNewArray(PapyrusResolutionContext* ctx, PapyrusExpressionId id);
+  void coerceToSameType(PapyrusResolutionContext* ctx, PapyrusExpressionId id);
+
+  pex::PexValue generateBinaryOpLoad(pex::PexFile* file, pex::PexFunctionBuilder& bldr, PapyrusExpressionId id) const;
+  pex::PexValue generateCastLoad(pex::PexFile* file, pex::PexFunctionBuilder& bldr, PapyrusExpressionId id) const;
+  pex::PexValue generateFunctionCallLoad(pex::PexFile* file,
+                                         pex::PexFunctionBuilder& bldr,
+                                         PapyrusExpressionId id,
+                                         PapyrusExpressionId base) const;
+  pex::PexValue generateMemberAccessLoad(pex::PexFile* file, pex::PexFunctionBuilder& bldr, PapyrusExpressionId id)
+      const;
+  pex::PexValue generateUnaryOpLoad(pex::PexFile* file, pex::PexFunctionBuilder& bldr, PapyrusExpressionId id) const;
+  bool tryFoldBinaryOp(pex::PexFile* file,
+                       PapyrusExpressionId id,
+                       const pex::PexValue& lVal,
+                       const pex::PexValue& rVal,
+                       pex::PexValue& result) const;
 };
 
 }}}
@@ -0,0 +1,612 @@
+#include <papyrus/expressions/PapyrusExpression.h>
+
+#include <cassert>
+
+#include <common/CapricaConfig.h>
+
+#include <papyrus/PapyrusFunction.h>
+#include <papyrus/PapyrusObject.h>
+
+#include <pex/optimizer/PexConstantFolder.h>
+
+namespace caprica { namespace papyrus { namespace expressions {
+
+static constexpr size_t MaxBuiltinArrayFunctionArgumentCount = 4;
+
+static void generateConditionalJump(pex::PexFunctionBuilder& bldr,
+                                    const pex::PexValue& val,
+                                    bool jumpIfTrue,
+                                    pex::PexLabel* target) {
+  if (jumpIfTrue)
+    bldr << pex::op::jmpt { val, target };
+  else
+    bldr << pex::op::jmpf { val, target };
+}
+
+pex::PexValue
+PapyrusExpressionStore::generateLoad(pex::PexFile* file, pex::PexFunctionBuilder& bldr, PapyrusExpressionId id) const {
+  namespace op = caprica::pex::op;
+  auto& n = node(id);
+  switch (n.kind) {
+    case PapyrusExpressionKind::ArrayIndex: {
+      auto base = generateLoad(file, bldr, n.first);
+      auto idx = generateLoad(file, bldr, n.second);
+      bldr << n.location;
+      auto dest = bldr.allocTemp(resultType(id));
+      bldr << op::arraygetelement { dest, pex::PexValue::Identifier::fromVar(base), idx };
+      return dest;
+    }
+    case PapyrusExpressionKind::ArrayLength:
+      CapricaReportingContext::logicalFatal("This shouldn't be called!");
+    case PapyrusExpressionKind::BinaryOp:
+      return generateBinaryOpLoad(file, bldr, id);
+    case PapyrusExpressionKind::Cast:
+      return generateCastLoad(file, bldr, id);
+    case PapyrusExpressionKind::FunctionCall:
+      return generateFunctionCallLoad(file, bldr, id, PapyrusExpressionId {});
+
+    case PapyrusExpressionKind::Identifier:
+      bldr << n.location;
+      return identifier(id).generateLoad(file, bldr, pex::PexValue::Identifier(file->getString("self")));
+
+    case PapyrusExpressionKind::Is: {
+      auto val = generateLoad(file, bldr, n.first);
+      auto dest = bldr.allocTemp(resultType(id));
+      bldr << n.location;
+      bldr << op::is { dest, val, type(id).buildPex(file) };
+      return dest;
+    }
+
+    case PapyrusExpressionKind::Literal:
+      bldr << n.location;
+      return value(id).buildPex(file);
+    case PapyrusExpressionKind::MemberAccess:
+      return generateMemberAccessLoad(file, bldr, id);
+
+    case PapyrusExpressionKind::NewArray: {
+      auto len = generateLoad(file, bldr, n.first);
+      bldr << n.location;
+      auto dest = bldr.allocTemp(type(id));
+      bldr << op::arraycreate { dest, len };
+      return dest;
+    }
+
+    case PapyrusExpressionKind::NewStruct: {
+      bldr << n.location;
+      auto dest = bldr.allocTemp(type(id));
+      bldr << op::structcreate { dest };
+      return dest;
+    }
+
+    case PapyrusExpressionKind::Parent:
+      return pex::PexValue::Identifier(file->getString("parent"));
+    case PapyrusExpressionKind::Self:
+      return pex::PexValue::Identifier(file->getString("self"));
+    case PapyrusExpressionKind::UnaryOp:
+      return generateUnaryOpLoad(file, bldr, id);
+  }
+  CapricaReportingContext::logicalFatal("Unknown PapyrusExpressionKind!");
+}
+
+void PapyrusExpressionStore::generateBranch(pex::PexFile* file,
+                                            pex::PexFunctionBuilder& bldr,
+                                            PapyrusExpressionId id,
+                                            bool jumpIfTrue,
+                                            pex::PexLabel* target,
+                                            const CapricaFileLocation& branchLocation) const {
+  namespace op = caprica::pex::op;
+  auto& n = node(id);
+  if (conf::CodeGeneration::enableOptimizations) {
+    switch (n.kind) {
+      case PapyrusExpressionKind::BinaryOp:
+        switch (n.binaryOperation) {
+          case PapyrusBinaryOperatorType::BooleanOr:
+          case PapyrusBinaryOperatorType::BooleanAnd:
+            // Either side alone decides a jump out of an And when false, or out
+            // of an Or when true. Otherwise the left side has to skip the right.
+            if (jumpIfTrue == (n.binaryOperation == PapyrusBinaryOperatorType::BooleanOr)) {
+              generateBranch(file, bldr, n.first, jumpIfTrue, target, branchLocation);
+              generateBranch(file, bldr, n.second, jumpIfTrue, target, branchLocation);
+            } else {
+              pex::PexLabel* afterRight;
+              bldr >> afterRight;
+              generateBranch(file, bldr, n.first, !jumpIfTrue, afterRight, branchLocation);
+              generateBranch(file, bldr, n.second, jumpIfTrue, target, branchLocation);
+              bldr << afterRight;
+            }
+            return;
+
+          case PapyrusBinaryOperatorType::CmpNeq: {
+            // Branch on the inverse of the equality rather than negating it.
+            auto lVal = generateLoad(file, bldr, n.first);
+            auto rVal = generateLoad(file, bldr, n.second);
+            pex::PexValue folded;
+            if (tryFoldBinaryOp(file, id, lVal, rVal, folded)) {
+              bldr << branchLocation;
+              generateConditionalJump(bldr, folded, jumpIfTrue, target);
+              return;
+            }
+            auto dest = bldr.allocTemp(resultType(id));
+            bldr << n.location;
+            bldr << op::cmpeq { dest, lVal, rVal };
+            bldr << branchLocation;
+            generateConditionalJump(bldr, dest, !jumpIfTrue, target);
+            return;
+          }
+
+          default:
+            break;
+        }
+        break;
+
+      case PapyrusExpressionKind::UnaryOp:
+        // Branching on the inverse of the inner condition doesn't need the Not.
+        if (n.unaryOperation == PapyrusUnaryOperatorType::Not)
+          return generateBranch(file, bldr, n.first, !jumpIfTrue, target, branchLocation);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  auto val = generateLoad(file, bldr, id);
+  bldr << branchLocation;
+  generateConditionalJump(bldr, val, jumpIfTrue, target);
+}
+
+void PapyrusExpressionStore::generateStore(pex::PexFile* file,
+                                           pex::PexFunctionBuilder& bldr,
+                                           PapyrusExpressionId id,
+                                           pex::PexValue val) const {
+  namespace op = caprica::pex::op;
+  auto& n = node(id);
+  switch (n.kind) {
+    case PapyrusExpressionKind::ArrayIndex: {
+      auto base = generateLoad(file, bldr, n.first);
+      auto idx = generateLoad(file, bldr, n.second);
+      bldr << n.location;
+      bldr << op::arraysetelement { pex::PexValue::Identifier::fromVar(base), idx, val };
+      return;
+    }
+
+    case PapyrusExpressionKind::MemberAccess: {
+      auto base = generateLoad(file, bldr, n.first);
+      bldr << n.location;
+      switch (kind(n.second)) {
+        case PapyrusExpressionKind::Identifier:
+          return identifier(n.second).generateStore(file, bldr, pex::PexValue::Identifier::fromVar(base), val);
+        case PapyrusExpressionKind::ArrayLength:
+          bldr.reportingContext.fatal(location(n.second), "You cannot assign to the .Length property of an array!");
+        case PapyrusExpressionKind::FunctionCall:
+          bldr.reportingContext.fatal(location(n.second), "You cannot assign to result of a function call!");
+        default:
+          break;
+      }
+      CapricaReportingContext::logicalFatal("Invalid access expression for PapyrusMemberAccessExpression!");
+    }
+
+    default:
+      break;
+  }
+  CapricaReportingContext::logicalFatal("Only array index and member access expressions can be stored to!");
+}
+
+pex::PexValue PapyrusExpressionStore::generateBinaryOpLoad(pex::PexFile* file,
+                                                           pex::PexFunctionBuilder& bldr,
+                                                           PapyrusExpressionId id) const {
+  namespace op = caprica::pex::op;
+  auto& n = node(id);
+  auto operation = n.binaryOperation;
+  auto lVal = generateLoad(file, bldr, n.first);
+  if (conf::CodeGeneration::enableOptimizations && lVal.type == pex::PexValueType::Bool &&
+      (operation == PapyrusBinaryOperatorType::BooleanOr || operation == PapyrusBinaryOperatorType::BooleanAnd)) {
+    // A constant left side decides whether the right side runs at all.
+    if (lVal.val.b == (operation == PapyrusBinaryOperatorType::BooleanOr))
+      return lVal;
+    return generateLoad(file, bldr, n.second);
+  }
+
+  if (operation == PapyrusBinaryOperatorType::BooleanOr || operation == PapyrusBinaryOperatorType::BooleanAnd) {
+    auto dest = bldr.allocTemp(resultType(id));
+    bldr << n.location;
+    bldr << op::assign { dest, lVal };
+    pex::PexLabel* after;
+    bldr >> after;
+    if (operation == PapyrusBinaryOperatorType::BooleanOr)
+      bldr << op::jmpt { dest, after };
+    else
+      bldr << op::jmpf { dest, after };
+    auto rVal = generateLoad(file, bldr, n.second);
+    bldr << n.location;
+    bldr << op::assign { dest, rVal };
+    bldr << after;
+    return dest;
+  }
+
+  auto rVal = generateLoad(file, bldr, n.second);
+  pex::PexValue folded;
+  if (conf::CodeGeneration::enableOptimizations && tryFoldBinaryOp(file, id, lVal, rVal, folded))
+    return folded;
+
+  auto dest = bldr.allocTemp(resultType(id));
+  auto leftKind = resultType(n.first).type;
+  bldr << n.location;
+  switch (operation) {
+    case PapyrusBinaryOperatorType::CmpEq:
+      bldr << op::cmpeq { dest, lVal, rVal };
+      return dest;
+    case PapyrusBinaryOperatorType::CmpNeq:
+      bldr << op::cmpeq { dest, lVal, rVal };
+      bldr << op::_not { dest, dest };
+      return dest;
+    case PapyrusBinaryOperatorType::CmpLt:
+      bldr << op::cmplt { dest, lVal, rVal };
+      return dest;
+    case PapyrusBinaryOperatorType::CmpLte:
+      bldr << op::cmplte { dest, lVal, rVal };
+      return dest;
+    case PapyrusBinaryOperatorType::CmpGt:
+      bldr << op::cmpgt { dest, lVal, rVal };
+      return dest;
+    case PapyrusBinaryOperatorType::CmpGte:
+      bldr << op::cmpgte { dest, lVal, rVal };
+      return dest;
+
+    case PapyrusBinaryOperatorType::Add:
+      if (leftKind == PapyrusType::Kind::Int)
+        bldr << op::iadd { dest, lVal, rVal };
+      else if (leftKind == PapyrusType::Kind::Float)
+        bldr << op::fadd { dest, lVal, rVal };
+      else if (leftKind == PapyrusType::Kind::String)
+        bldr << op::strcat { dest, lVal, rVal };
+      else
+        bldr.reportingContext.fatal(n.location, "Unknown argument type to an add operation!");
+      return dest;
+
+    case PapyrusBinaryOperatorType::Subtract:
+      if (leftKind == PapyrusType::Kind::Int)
+        bldr << op::isub { dest, lVal, rVal };
+      else if (leftKind == PapyrusType::Kind::Float)
+        bldr << op::fsub { dest, lVal, rVal };
+      else
+        bldr.reportingContext.fatal(n.location, "Unknown argument type to a subtraction operation!");
+      return dest;
+
+    case PapyrusBinaryOperatorType::Multiply:
+      if (leftKind == PapyrusType::Kind::Int)
+        bldr << op::imul { dest, lVal, rVal };
+      else if (leftKind == PapyrusType::Kind::Float)
+        bldr << op::fmul { dest, lVal, rVal };
+      else
+        bldr.reportingContext.fatal(n.location, "Unknown argument type to a multiplication operation!");
+      return dest;
+
+    case PapyrusBinaryOperatorType::Divide:
+      if (leftKind == PapyrusType::Kind::Int)
+        bldr << op::idiv { dest, lVal, rVal };
+      else if (leftKind == PapyrusType::Kind::Float)
+        bldr << op::fdiv { dest, lVal, rVal };
+      else
+        bldr.reportingContext.fatal(n.location, "Unknown argument type to a division operation!");
+      return dest;
+
+    case PapyrusBinaryOperatorType::Modulus:
+      if (leftKind != PapyrusType::Kind::Int)
+        bldr.reportingContext.fatal(n.location, "Unknown argument type to a modulus operation!");
+      bldr << op::imod { dest, lVal, rVal };
+      return dest;
+
+    case PapyrusBinaryOperatorType::BooleanOr:
+    case PapyrusBinaryOperatorType::BooleanAnd:
+    case PapyrusBinaryOperatorType::None:
+      break;
+  }
+  CapricaReportingContext::logicalFatal("Unknown PapyrusBinaryOperatorType while generating the pex opcodes!");
+}
+
+bool PapyrusExpressionStore::tryFoldBinaryOp(pex::PexFile* file,
+                                             PapyrusExpressionId id,
+                                             const pex::PexValue& lVal,
+                                             const pex::PexValue& rVal,
+                                             pex::PexValue& result) const {
+  using pex::PexOpCode;
+  namespace opt = caprica::pex::optimizer;
+  auto kind = resultType(node(id).first).type;
+  const auto byKind = [kind](PexOpCode intOp, PexOpCode floatOp) {
+    if (kind == PapyrusType::Kind::Int)
+      return intOp;
+    if (kind == PapyrusType::Kind::Float)
+      return floatOp;
+    return PexOpCode::Invalid;
+  };
+  switch (node(id).binaryOperation) {
+    case PapyrusBinaryOperatorType::CmpEq:
+      return opt::tryFoldBinaryOp(file, PexOpCode::CmpEq, lVal, rVal, result);
+    case PapyrusBinaryOperatorType::CmpNeq: {
+      pex::PexValue eq;
+      return opt::tryFoldBinaryOp(file, PexOpCode::CmpEq, lVal, rVal, eq) &&
+             opt::tryFoldUnaryOp(file, PexOpCode::Not, eq, result);
+    }
+    case PapyrusBinaryOperatorType::CmpLt:
+      return opt::tryFoldBinaryOp(file, PexOpCode::CmpLt, lVal, rVal, result);
+    case PapyrusBinaryOperatorType::CmpLte:
+      return opt::tryFoldBinaryOp(file, PexOpCode::CmpLte, lVal, rVal, result);
+    case PapyrusBinaryOperatorType::CmpGt:
+      return opt::tryFoldBinaryOp(file, PexOpCode::CmpGt, lVal, rVal, result);
+    case PapyrusBinaryOperatorType::CmpGte:
+      return opt::tryFoldBinaryOp(file, PexOpCode::CmpGte, lVal, rVal, result);
+    case PapyrusBinaryOperatorType::Add:
+      if (kind == PapyrusType::Kind::String)
+        return opt::tryFoldBinaryOp(file, PexOpCode::StrCat, lVal, rVal, result);
+      return opt::tryFoldBinaryOp(file, byKind(PexOpCode::IAdd, PexOpCode::FAdd), lVal, rVal, result);
+    case PapyrusBinaryOperatorType::Subtract:
+      return opt::tryFoldBinaryOp(file, byKind(PexOpCode::ISub, PexOpCode::FSub), lVal, rVal, result);
+    case PapyrusBinaryOperatorType::Multiply:
+      return opt::tryFoldBinaryOp(file, byKind(PexOpCode::IMul, PexOpCode::FMul), lVal, rVal, result);
+    case PapyrusBinaryOperatorType::Divide:
+      return opt::tryFoldBinaryOp(file, byKind(PexOpCode::IDiv, PexOpCode::FDiv), lVal, rVal, result);
+    case PapyrusBinaryOperatorType::Modulus:
+      return opt::tryFoldBinaryOp(file, byKind(PexOpCode::IMod, PexOpCode::Invalid), lVal, rVal, result);
+    default:
+      return false;
+  }
+}
+
+pex::PexValue PapyrusExpressionStore::generateCastLoad(pex::PexFile* file,
+                                                       pex::PexFunctionBuilder& bldr,
+                                                       PapyrusExpressionId id) const {
+  namespace op = caprica::pex::op;
+  auto& n = node(id);
+  auto& targetType = type(id);
+
+  auto val = generateLoad(file, bldr, n.first);
+
+  if (conf::Papyrus::game == GameID::Skyrim) {
+    // the only invalid value that would be passed back to `val` here would come as a result
+    // from a void function call returning ::NoneVar. You are apparently allowed to assign the results
+    // of void function calls to objects and bools, so we need to check for that here.
+    if (val.type == pex::PexValueType::Invalid) {
+      if (!conf::Skyrim::skyrimAllowAssigningVoidMethodCallResult)
+        bldr.reportingContext.fatal(n.location, "Cannot cast None method call result to '{}'!", targetType);
+      switch (targetType.type) {
+        case PapyrusType::Kind::ResolvedObject:
+        case PapyrusType::Kind::ResolvedStruct:
+        case PapyrusType::Kind::Bool:
+        case PapyrusType::Kind::Var:
+        case PapyrusType::Kind::String:
+        case PapyrusType::Kind::Array:
+        case PapyrusType::Kind::None:
+          bldr.reportingContext.warning_W7005_Skyrim_Casting_None_Call_Result(n.location, targetType.prettyString());
+          val = bldr.getNoneLocal(n.location);
+          break;
+        default:
+          if (conf::Papyrus::allowImplicitNoneCastsToAnyType) {
+            bldr.reportingContext.warning_W7005_Skyrim_Casting_None_Call_Result(n.location,
+                                                                                targetType.prettyString());
+            val = bldr.getNoneLocal(n.location);
+            break;
+          }
+          bldr.reportingContext.fatal(n.location, "Cannot cast None method call result to '{}'!", targetType);
+          break;
+      }
+    }
+  }
+
+  if (conf::CodeGeneration::enableOptimizations) {
+    switch (targetType.type) {
+      case PapyrusType::Kind::Bool:
+      case PapyrusType::Kind::Float:
+      case PapyrusType::Kind::Int:
+      case PapyrusType::Kind::String: {
+        pex::PexValue folded;
+        if (pex::optimizer::tryFoldCast(file, val, file->getStringValue(targetType.buildPex(file)), folded))
+          return folded;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  auto dest = bldr.allocTemp(targetType);
+  bldr << n.location;
+  bldr << op::cast { dest, val };
+  return dest;
+}
+
+pex::PexValue PapyrusExpressionStore::generateFunctionCallLoad(pex::PexFile* file,
+                                                               pex::PexFunctionBuilder& bldr,
+                                                               PapyrusExpressionId id,
+                                                               PapyrusExpressionId base) const {
+  namespace op = caprica::pex::op;
+  auto& c = call(id);
+  if (!c.shouldEmit)
+    return pex::PexValue::Invalid();
+
+  auto& loc = location(id);
+  auto& function = c.function;
+  if (function.type == PapyrusIdentifierType::BuiltinArrayFunction) {
+    assert(c.argumentCount <= MaxBuiltinArrayFunctionArgumentCount);
+    const auto argLoad = [&](size_t i) { return generateLoad(file, bldr, argument(c, i).value); };
+    const auto memberName = [&]() { return value(argument(c, 0).value).buildPex(file); };
+
+    auto bVal = pex::PexValue::Identifier::fromVar(generateLoad(file, bldr, base));
+    switch (function.arrayFuncKind) {
+      case PapyrusBuiltinArrayFunctionKind::Find: {
+        auto elem = argLoad(0);
+        auto idx = argLoad(1);
+        auto dest = bldr.allocTemp(resultType(id));
+        bldr << loc;
+        bldr << op::arrayfindelement { bVal, dest, elem, idx };
+        return dest;
+      }
+      case PapyrusBuiltinArrayFunctionKind::RFind: {
+        auto elem = argLoad(0);
+        auto idx = argLoad(1);
+        auto dest = bldr.allocTemp(resultType(id));
+        bldr << loc;
+        bldr << op::arrayrfindelement { bVal, dest, elem, idx };
+        return dest;
+      }
+      case PapyrusBuiltinArrayFunctionKind::FindStruct: {
+        auto name = memberName();
+        auto elem = argLoad(1);
+        auto idx = argLoad(2);
+        auto dest = bldr.allocTemp(resultType(id));
+        bldr << loc;
+        bldr << op::arrayfindstruct { bVal, dest, name, elem, idx };
+        return dest;
+      }
+      case PapyrusBuiltinArrayFunctionKind::RFindStruct: {
+        auto name = memberName();
+        auto elem = argLoad(1);
+        auto idx = argLoad(2);
+        auto dest = bldr.allocTemp(resultType(id));
+        bldr << loc;
+        bldr << op::arrayrfindstruct { bVal, dest, name, elem, idx };
+        return dest;
+      }
+      case PapyrusBuiltinArrayFunctionKind::Add: {
+        auto elem = argLoad(0);
+        auto cnt = argLoad(1);
+        bldr << loc;
+        bldr << op::arrayadd { bVal, elem, cnt };
+        return pex::PexValue::Invalid();
+      }
+      case PapyrusBuiltinArrayFunctionKind::Clear:
+        bldr << loc;
+        bldr << op::arrayclear { bVal };
+        return pex::PexValue::Invalid();
+      case PapyrusBuiltinArrayFunctionKind::Insert: {
+        auto elem = argLoad(0);
+        auto idx = argLoad(1);
+        bldr << loc;
+        bldr << op::arrayinsert { bVal, elem, idx };
+        return pex::PexValue::Invalid();
+      }
+      case PapyrusBuiltinArrayFunctionKind::Remove: {
+        auto idx = argLoad(0);
+        auto cnt = argLoad(1);
+        bldr << loc;
+        bldr << op::arrayremove { bVal, idx, cnt };
+        return pex::PexValue::Invalid();
+      }
+      case PapyrusBuiltinArrayFunctionKind::RemoveLast:
+        bldr << loc;
+        bldr << op::arrayremovelast { bVal };
+        return pex::PexValue::Invalid();
+      case PapyrusBuiltinArrayFunctionKind::GetMatchingStructs: {
+        auto name = memberName();
+        auto elem = argLoad(1);
+        auto idx = argLoad(2);
+        auto cnt = argLoad(3);
+        auto dest = bldr.allocTemp(resultType(id));
+        bldr << loc;
+        bldr << op::arraygetallmatchingstructs { bVal, dest, name, elem, idx, cnt };
+        return dest;
+      }
+      case PapyrusBuiltinArrayFunctionKind::Unknown:
+        break;
+    }
+    CapricaReportingContext::logicalFatal("Unknown PapyrusBuiltinArrayFunctionKind!");
+  }
+
+  auto func = function.res.func;
+  pex::PexValue::Identifier dest = func->returnType.type == PapyrusType::Kind::None
+                                       ? pex::PexValue::Identifier(bldr.getNoneLocal(loc))
+                                       : pex::PexValue::Identifier(bldr.allocTemp(func->returnType));
+
+  std::vector<pex::PexValue> args;
+  args.reserve(c.argumentCount);
+  for (size_t i = 0; i < c.argumentCount; i++)
+    args.push_back(generateLoad(file, bldr, argument(c, i).value));
+  bldr << loc;
+  if (func->isGlobal()) {
+    bldr << op::callstatic { file->getString(func->parentObject->loweredName()),
+                             file->getString(func->name),
+                             dest,
+                             std::move(args) };
+  } else if (base && kind(base) == PapyrusExpressionKind::Parent) {
+    bldr << op::callparent { file->getString(func->name), dest, std::move(args) };
+  } else if (base) {
+    auto bVal = generateLoad(file, bldr, base);
+    bldr << op::callmethod { file->getString(func->name), bVal, dest, std::move(args) };
+  } else {
+    bldr << op::callmethod { file->getString(func->name),
+                             pex::PexValue::Identifier(file->getString("self")),
+                             dest,
+                             std::move(args) };
+  }
+
+  if (func->returnType.type == PapyrusType::Kind::None)
+    return pex::PexValue::Invalid();
+  return dest;
+}
+
+pex::PexValue PapyrusExpressionStore::generateMemberAccessLoad(pex::PexFile* file,
+                                                               pex::PexFunctionBuilder& bldr,
+                                                               PapyrusExpressionId id) const {
+  namespace op = caprica::pex::op;
+  auto& n = node(id);
+  switch (kind(n.second)) {
+    case PapyrusExpressionKind::Identifier: {
+      auto base = generateLoad(file, bldr, n.first);
+      bldr << n.location;
+      return identifier(n.second).generateLoad(file, bldr, pex::PexValue::Identifier::fromVar(base));
+    }
+    case PapyrusExpressionKind::ArrayLength: {
+      auto base = generateLoad(file, bldr, n.first);
+      bldr << n.location;
+      auto dest = bldr.allocTemp(PapyrusType::Int(n.location));
+      bldr << op::arraylength { pex::PexValue::Identifier::fromVar(dest), pex::PexValue::Identifier::fromVar(base) };
+      return dest;
+    }
+    case PapyrusExpressionKind::FunctionCall:
+      return generateFunctionCallLoad(file, bldr, n.second, n.first);
+    default:
+      break;
+  }
+  CapricaReportingContext::logicalFatal("Invalid access expression for PapyrusMemberAccessExpression!");
+}
+
+pex::PexValue PapyrusExpressionStore::generateUnaryOpLoad(pex::PexFile* file,
+                                                          pex::PexFunctionBuilder& bldr,
+                                                          PapyrusExpressionId id) const {
+  namespace op = caprica::pex::op;
+  auto& n = node(id);
+  auto iVal = generateLoad(file, bldr, n.first);
+  auto innerKind = resultType(n.first).type;
+  if (conf::CodeGeneration::enableOptimizations) {
+    auto foldOp = pex::PexOpCode::Not;
+    if (n.unaryOperation == PapyrusUnaryOperatorType::Negate)
+      foldOp = innerKind == PapyrusType::Kind::Float ? pex::PexOpCode::FNeg : pex::PexOpCode::INeg;
+    pex::PexValue folded;
+    if (pex::optimizer::tryFoldUnaryOp(file, foldOp, iVal, folded))
+      return folded;
+  }
+
+  auto dest = bldr.allocTemp(resultType(id));
+  bldr << n.location;
+  switch (n.unaryOperation) {
+    case PapyrusUnaryOperatorType::Negate:
+      if (innerKind == PapyrusType::Kind::Float) {
+        bldr << op::fneg { dest, iVal };
+      } else if (innerKind == PapyrusType::Kind::Int) {
+        bldr << op::ineg { dest, iVal };
+      } else {
+        bldr.reportingContext.error(n.location, "You can only negate integers and floats!");
+        bldr << op::assign { dest, iVal };
+      }
+      return dest;
+    case PapyrusUnaryOperatorType::Not:
+      bldr << op::_not { dest, iVal };
+      return dest;
+
+    case PapyrusUnaryOperatorType::None:
+      break;
+  }
+  CapricaReportingContext::logicalFatal("Unknown PapyrusUnaryOperatorType while generating the pex opcodes!");
+}
+
+}}}
@@ -0,0 +1,532 @@
+#include <papyrus/expressions/PapyrusExpression.h>
+
+#include <cassert>
+
+#include <common/CapricaConfig.h>
+#include <common/EngineLimits.h>
+
+#include <papyrus/PapyrusFunction.h>
+#include <papyrus/PapyrusObject.h>
+
+namespace caprica { namespace papyrus { namespace expressions {
+
+static constexpr size_t MaxBuiltinArrayFunctionArgumentCount = 4;
+
+void PapyrusExpressionStore::semantic(PapyrusResolutionContext* ctx, PapyrusExpressionId id) {
+  switch (kind(id)) {
+    case PapyrusExpressionKind::ArrayIndex:
+      return semanticArrayIndex(ctx, id);
+    case PapyrusExpressionKind::ArrayLength:
+      ctx->reportingContext.fatal(location(id), "Illegal identifier: 'Length'!");
+    case PapyrusExpressionKind::BinaryOp:
+      return semanticBinaryOp(ctx, id);
+    case PapyrusExpressionKind::Cast:
+      return semanticCast(ctx, id);
+    case PapyrusExpressionKind::FunctionCall:
+      return semanticFunctionCall(ctx, id, PapyrusExpressionId {});
+
+    case PapyrusExpressionKind::Identifier:
+      identifier(id) = ctx->resolveIdentifier(identifier(id));
+      if (!node(id).isAssignmentContext)
+        identifier(id).markRead();
+      return;
+
+    case PapyrusExpressionKind::Is: {
+      auto inner = node(id).first;
+      semantic(ctx, inner);
+      ctx->checkForPoison(resultType(inner));
+      type(id) = ctx->resolveType(type(id));
+      return;
+    }
+
+    case PapyrusExpressionKind::Literal:
+      return;
+    case PapyrusExpressionKind::MemberAccess:
+      return semanticMemberAccess(ctx, id);
+    case PapyrusExpressionKind::NewArray:
+      return semanticNewArray(ctx, id);
+
+    case PapyrusExpressionKind::NewStruct:
+      type(id) = ctx->resolveType(type(id));
+      return;
+
+    case PapyrusExpressionKind::Parent:
+      type(id) = ctx->resolveType(type(id));
+      if (ctx->object->parentClass != type(id))
+        ctx->reportingContext.fatal(location(id), "An error occurred while resolving the parent type!");
+      if (ctx->object->parentClass.type == PapyrusType::Kind::None)
+        ctx->reportingContext.error(location(id), "Parent is invalid in a script with no parent!");
+      return;
+
+    case PapyrusExpressionKind::Self:
+      type(id) = ctx->resolveType(type(id));
+      if (ctx->object != type(id).resolved.obj)
+        ctx->reportingContext.fatal(location(id), "An error occurred while resolving the self type!");
+      return;
+
+    case PapyrusExpressionKind::UnaryOp: {
+      assert(node(id).unaryOperation != PapyrusUnaryOperatorType::None);
+      auto inner = node(id).first;
+      semantic(ctx, inner);
+      ctx->checkForPoison(resultType(inner));
+      return;
+    }
+  }
+  CapricaReportingContext::logicalFatal("Unknown PapyrusExpressionKind!");
+}
+
+void PapyrusExpressionStore::semanticArrayIndex(PapyrusResolutionContext* ctx, PapyrusExpressionId id) {
+  auto base = node(id).first;
+  semantic(ctx, base);
+  ctx->checkForPoison(resultType(base));
+  if (resultType(base).type != PapyrusType::Kind::Array)
+    ctx->reportingContext.error(location(base), "You can only index arrays! Got '{}'!", resultType(base));
+
+  auto index = node(id).second;
+  semantic(ctx, index);
+  ctx->checkForPoison(resultType(index));
+  auto coerced = ctx->coerceExpression(index, PapyrusType::Int(location(index)));
+  node(id).second = coerced;
+}
+
+void PapyrusExpressionStore::semanticBinaryOp(PapyrusResolutionContext* ctx, PapyrusExpressionId id) {
+  assert(node(id).binaryOperation != PapyrusBinaryOperatorType::None);
+  auto left = node(id).first;
+  semantic(ctx, left);
+  ctx->checkForPoison(resultType(left));
+  auto right = node(id).second;
+  semantic(ctx, right);
+  ctx->checkForPoison(resultType(right));
+
+  switch (node(id).binaryOperation) {
+    case PapyrusBinaryOperatorType::BooleanOr:
+    case PapyrusBinaryOperatorType::BooleanAnd: {
+      auto coercedLeft = ctx->coerceExpression(left, PapyrusType::Bool(location(left)));
+      node(id).first = coercedLeft;
+      auto coercedRight = ctx->coerceExpression(right, PapyrusType::Bool(location(right)));
+      node(id).second = coercedRight;
+      return;
+    }
+
+    case PapyrusBinaryOperatorType::CmpEq:
+    case PapyrusBinaryOperatorType::CmpNeq:
+    case PapyrusBinaryOperatorType::Add:
+      coerceToSameType(ctx, id);
+      return;
+
+    case PapyrusBinaryOperatorType::CmpLt:
+    case PapyrusBinaryOperatorType::CmpLte:
+    case PapyrusBinaryOperatorType::CmpGt:
+    case PapyrusBinaryOperatorType::CmpGte:
+    case PapyrusBinaryOperatorType::Subtract:
+    case PapyrusBinaryOperatorType::Multiply:
+    case PapyrusBinaryOperatorType::Divide: {
+      coerceToSameType(ctx, id);
+      auto leftKind = resultType(node(id).first).type;
+      if (leftKind != PapyrusType::Kind::Int && leftKind != PapyrusType::Kind::Float) {
+        ctx->reportingContext.fatal(location(id),
+                                    "The <, <=, >, >=, -, *, /, and % operators are only valid on integers and floats!");
+      }
+      return;
+    }
+
+    case PapyrusBinaryOperatorType::Modulus:
+      coerceToSameType(ctx, id);
+      if (resultType(node(id).first).type != PapyrusType::Kind::Int)
+        ctx->reportingContext.fatal(location(id), "The modulus operator can only be used on integers!");
+      return;
+
+    case PapyrusBinaryOperatorType::None:
+      break;
+  }
+  CapricaReportingContext::logicalFatal("Unknown PapyrusBinaryOperatorType in semantic pass!");
+}
+
+void PapyrusExpressionStore::coerceToSameType(PapyrusResolutionContext* ctx, PapyrusExpressionId id) {
+  auto left = node(id).first;
+  auto right = node(id).second;
+  auto leftKind = resultType(left).type;
+  auto rightKind = resultType(right).type;
+  const auto coerceBoth = [&](PapyrusType (*make)(CapricaFileLocation)) {
+    auto coercedLeft = ctx->coerceExpression(left, make(location(left)));
+    node(id).first = coercedLeft;
+    auto coercedRight = ctx->coerceExpression(right, make(location(right)));
+    node(id).second = coercedRight;
+  };
+
+  if (leftKind == PapyrusType::Kind::String || rightKind == PapyrusType::Kind::String) {
+    coerceBoth(PapyrusType::String);
+  } else if (leftKind == PapyrusType::Kind::Bool || rightKind == PapyrusType::Kind::Bool) {
+    coerceBoth(PapyrusType::Bool);
+  } else if (leftKind == PapyrusType::Kind::Float || rightKind == PapyrusType::Kind::Float) {
+    coerceBoth(PapyrusType::Float);
+  } else if (!ctx->canImplicitlyCoerceExpression(right, resultType(left))) {
+    auto coercedLeft = ctx->coerceExpression(left, resultType(right));
+    node(id).first = coercedLeft;
+  } else {
+    auto coercedRight = ctx->coerceExpression(right, resultType(left));
+    node(id).second = coercedRight;
+  }
+}
+
+void PapyrusExpressionStore::semanticCast(PapyrusResolutionContext* ctx, PapyrusExpressionId id) {
+  auto inner = node(id).first;
+  semantic(ctx, inner);
+  ctx->checkForPoison(resultType(inner));
+  type(id) = ctx->resolveType(type(id));
+
+  auto innerType = resultType(inner);
+  auto targetType = type(id);
+  if (innerType == targetType) {
+    ctx->reportingContext.warning_W4001_Unecessary_Cast(location(id),
+                                                        innerType.prettyString(),
+                                                        targetType.prettyString());
+  }
+
+  if (!ctx->canExplicitlyCast(location(inner), innerType, targetType)) {
+    if (!ctx->canImplicitlyCoerceExpression(inner, targetType))
+      ctx->reportingContext.error(location(id), "Cannot convert from '{}' to '{}'!", innerType, targetType);
+  }
+}
+
+void PapyrusExpressionStore::semanticMemberAccess(PapyrusResolutionContext* ctx, PapyrusExpressionId id) {
+  auto base = node(id).first;
+  auto access = node(id).second;
+  // We don't explicitly use the access expression, so we don't
+  // check it for poison.
+  if (kind(access) == PapyrusExpressionKind::FunctionCall) {
+    if (kind(base) == PapyrusExpressionKind::Identifier) {
+      identifier(base) = ctx->tryResolveIdentifier(identifier(base));
+      if (identifier(base).type == PapyrusIdentifierType::Unresolved) {
+        auto tp = ctx->resolveType(PapyrusType::Unresolved(location(base), identifier(base).res.name));
+        if (tp.type != PapyrusType::Kind::ResolvedObject) {
+          ctx->reportingContext.error(location(base), "Unresolved identifier '{}'!", identifier(base).res.name);
+          return;
+        }
+        call(access).function = ctx->resolveFunctionIdentifier(tp, call(access).function, true);
+        semanticFunctionCall(ctx, access, PapyrusExpressionId {});
+        return;
+      }
+    }
+    semantic(ctx, base);
+    ctx->checkForPoison(resultType(base));
+    call(access).function = ctx->resolveFunctionIdentifier(resultType(base), call(access).function);
+    semanticFunctionCall(ctx, access, base);
+  } else {
+    semantic(ctx, base);
+    ctx->checkForPoison(resultType(base));
+    if (kind(access) == PapyrusExpressionKind::Identifier) {
+      identifier(access) = ctx->resolveMemberIdentifier(resultType(base), identifier(access));
+      semantic(ctx, access);
+    } else if (kind(access) == PapyrusExpressionKind::ArrayLength) {
+      if (resultType(base).type != PapyrusType::Kind::Array)
+        ctx->reportingContext.error(location(access), "Attempted to access the .Length property of a non-array value!");
+    } else {
+      CapricaReportingContext::logicalFatal("Invalid access expression for PapyrusMemberAccessExpression!");
+    }
+  }
+}
+
+void PapyrusExpressionStore::semanticNewArray(PapyrusResolutionContext* ctx, PapyrusExpressionId id) {
+  auto elementType = ctx->resolveType(type(id));
+  type(id) = PapyrusType::Array(elementType.location, ctx->allocator->make<PapyrusType>(elementType));
+
+  auto length = node(id).first;
+  semantic(ctx, length);
+  ctx->checkForPoison(resultType(length));
+  if (resultType(length).type != PapyrusType::Kind::Int) {
+    ctx->reportingContext.error(
+        location(length),
+        "The length expression of a new array expression must be an integral type, but got '{}'.",
+        resultType(length));
+  } else if (kind(length) == PapyrusExpressionKind::Literal) {
+    auto& len = value(length);
+    if (len.val.i < 0) {
+      ctx->reportingContext.error(
+          len.location,
+          "The length expression of a new array expression must be greater than or equal to zero. Got '{}'.",
+          (int64_t)len.val.i);
+    } else {
+      EngineLimits::checkLimit(ctx->reportingContext, len.location, EngineLimits::Type::ArrayLength, len.val.i);
+    }
+  }
+}
+
+void PapyrusExpressionStore::semanticFunctionCall(PapyrusResolutionContext* ctx,
+                                                  PapyrusExpressionId id,
+                                                  PapyrusExpressionId base) {
+  if (base)
+    ctx->checkForPoison(resultType(base));
+  // TODO: Maybe pass base now that it's being passed to us?
+  call(id).function = ctx->resolveFunctionIdentifier(PapyrusType::None(location(id)), call(id).function);
+  if (call(id).function.type == PapyrusIdentifierType::BuiltinArrayFunction)
+    return semanticBuiltinArrayFunctionCall(ctx, id);
+
+  auto func = call(id).function.res.func;
+  assert(func != nullptr);
+
+  if (func->returnType.isPoisoned(PapyrusType::PoisonKind::Beta)) {
+    if (ctx->function == nullptr || !ctx->function->isBetaOnly()) {
+      call(id).isPoisonedReturn = true;
+      call(id).shouldEmit = !conf::CodeGeneration::disableBetaCode;
+    }
+  }
+  if (func->returnType.isPoisoned(PapyrusType::PoisonKind::Debug)) {
+    if (ctx->function == nullptr || !ctx->function->isDebugOnly()) {
+      call(id).isPoisonedReturn = true;
+      call(id).shouldEmit = !conf::CodeGeneration::disableDebugCode;
+    }
+  }
+
+  auto args = copyArguments(id);
+  const auto hasNamedArgs = [&]() {
+    for (auto& a : args)
+      if (a.name != "")
+        return true;
+    return false;
+  };
+  if (args.size() != func->parameters.size() || hasNamedArgs()) {
+    // We may have default args to fill in.
+    std::vector<PapyrusFunctionCallArgument> newArgs {};
+    bool hadNamedArgs = false;
+    for (size_t baseI = 0; baseI < args.size(); baseI++) {
+      auto a = args[baseI];
+      if (a.name != "") {
+        hadNamedArgs = true;
+        size_t newArgsPos = 0;
+        bool found = false;
+        for (auto p : func->parameters) {
+          if (idEq(p->name, a.name)) {
+            a.argIndex = p->index;
+            if (newArgsPos != newArgs.size() && idEq(newArgs[newArgsPos].name, a.name))
+              ctx->reportingContext.error(location(a.value), "Duplicate named parameter provided '{}'!", a.name);
+            else
+              newArgs.insert(newArgs.begin() + newArgsPos, a);
+            found = true;
+            break;
+          }
+          if (newArgsPos != newArgs.size() && newArgs[newArgsPos].argIndex <= p->index)
+            newArgsPos++;
+        }
+        if (!found)
+          ctx->reportingContext.error(location(a.value), "Unable to find a parameter named '{}'!", a.name);
+        continue;
+      }
+      if (hadNamedArgs)
+        ctx->reportingContext.error(location(a.value), "No normal arguments are allowed after the first named argument!");
+
+      a.argIndex = baseI;
+      newArgs.push_back(a);
+    }
+
+    size_t newArgsPos = 0;
+    for (auto p : func->parameters) {
+      if (newArgsPos == newArgs.size() || newArgs[newArgsPos].argIndex != p->index) {
+        PapyrusFunctionCallArgument newP {};
+        newP.argIndex = p->index;
+        if (p->defaultValue.type == PapyrusValueType::Invalid) {
+          ctx->reportingContext.error(location(id), "Not enough arguments provided.");
+          newP.value = makeLiteral(location(id), PapyrusValue::defaultFromType(ctx, p->type));
+        } else {
+          newP.value = makeLiteral(location(id), p->defaultValue);
+        }
+        newArgs.insert(newArgs.begin() + newArgsPos, newP);
+      }
+      newArgsPos++;
+    }
+    args = std::move(newArgs);
+  }
+  if (args.size() > func->parameters.size()) {
+    ctx->reportingContext.error(location(id), "Too many arguments provided.");
+    args.resize(func->parameters.size());
+  }
+
+  auto param = func->parameters.begin();
+  for (size_t i = 0; i < args.size(); i++, ++param) {
+    auto p = *param;
+    auto argValue = args[i].value;
+    semantic(ctx, argValue);
+    ctx->checkForPoison(resultType(argValue));
+    switch (p->type.type) {
+      case PapyrusType::Kind::CustomEventName:
+      case PapyrusType::Kind::ScriptEventName: {
+        bool isCustomEvent = p->type.type == PapyrusType::Kind::CustomEventName;
+
+        if (kind(argValue) != PapyrusExpressionKind::Literal || value(argValue).type != PapyrusValueType::String) {
+          ctx->reportingContext.error(location(argValue), "Argument {} must be string literal.", p->index);
+          continue;
+        }
+
+        auto baseType = [&]() -> PapyrusType {
+          if (p->index != 0)
+            return resultType(args[i - 1].value);
+          if (!base)
+            return PapyrusType::ResolvedObject(ctx->object->location, ctx->object);
+          return resultType(base);
+        }();
+        if (baseType.type != PapyrusType::Kind::ResolvedObject)
+          goto EventResolutionError;
+
+        if (!isCustomEvent && ctx->tryResolveEvent(baseType.resolved.obj, value(argValue).val.s)) {
+          continue;
+        } else if (auto ev = ctx->tryResolveCustomEvent(baseType.resolved.obj, value(argValue).val.s)) {
+          value(argValue).val.s = ctx->allocator->allocateIdentifier(ev->parentObject->name.to_string() + "_" +
+                                                                     value(argValue).val.s.to_string());
+          continue;
+        }
+
+      EventResolutionError:
+        ctx->reportingContext.error(location(argValue),
+                                    "Unable to resolve {} event named '{}' in '{}' or one of its parents.",
+                                    isCustomEvent ? "a custom" : "an",
+                                    value(argValue).val.s,
+                                    baseType);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  // We need the semantic pass to have run for the args, but we can't have them coerced until after
+  // we've transformed CustomEventName and ScriptEventName parameters.
+  param = func->parameters.begin();
+  for (size_t i = 0; i < args.size(); i++, ++param) {
+    auto p = *param;
+    if (p->type.type == PapyrusType::Kind::CustomEventName || p->type.type == PapyrusType::Kind::ScriptEventName)
+      args[i].value = ctx->coerceExpression(args[i].value, PapyrusType::String(location(args[i].value)));
+    else
+      args[i].value = ctx->coerceExpression(args[i].value, p->type);
+  }
+
+  if (func->name == "GotoState" && args.size() == 1) {
+    auto arg = args.front().value;
+    if (kind(arg) == PapyrusExpressionKind::Literal && value(arg).type == PapyrusValueType::String) {
+      auto targetStateName = value(arg).val.s;
+      if (!ctx->tryResolveState(targetStateName))
+        ctx->reportingContext.warning_W4003_State_Doesnt_Exist(location(arg), targetStateName);
+    }
+  }
+  setArguments(id, args);
+}
+
+void PapyrusExpressionStore::semanticBuiltinArrayFunctionCall(PapyrusResolutionContext* ctx, PapyrusExpressionId id) {
+  auto args = copyArguments(id);
+  for (auto& a : args) {
+    semantic(ctx, a.value);
+    ctx->checkForPoison(resultType(a.value));
+  }
+
+  const auto function = call(id).function;
+  const auto callLocation = location(id);
+  const auto getArgs = [&](const char* funcName, size_t argCountMin, size_t argCountMax = 0) {
+    assert(args.size() <= MaxBuiltinArrayFunctionArgumentCount);
+    if (argCountMax != 0) {
+      if (args.size() < argCountMin || args.size() > argCountMax) {
+        ctx->reportingContext.fatal(callLocation,
+                                    "Expected either {} or {} parameters to '{}'!",
+                                    argCountMin,
+                                    argCountMax,
+                                    funcName);
+      }
+    } else {
+      if (args.size() != argCountMin)
+        ctx->reportingContext.fatal(callLocation, "Expected {} parameters to '{}'!", argCountMin, funcName);
+    }
+  };
+  const auto coerceArg = [&](size_t i, const PapyrusType& tp) {
+    args[i].value = ctx->coerceExpression(args[i].value, tp);
+  };
+  const auto coerceArgToInt = [&](size_t i) { coerceArg(i, PapyrusType::Int(location(args[i].value))); };
+  // Fills in the last argument with its default, or checks the name it was
+  // given and coerces it.
+  const auto optionalIntArg = [&](size_t i, int32_t defaultValue, const char* expectedName) {
+    if (args.size() == i) {
+      PapyrusFunctionCallArgument p {};
+      p.value = makeLiteral(callLocation, PapyrusValue::Integer(callLocation, defaultValue));
+      args.push_back(p);
+    } else {
+      if (args[i].name != "" && !idEq(args[i].name, expectedName)) {
+        ctx->reportingContext.error(location(args[i].value),
+                                    "Unknown argument '{}'! Was expecting '{}'!",
+                                    args[i].name,
+                                    expectedName);
+      }
+      coerceArgToInt(i);
+    }
+  };
+  const auto structMemberType = [&](const CapricaFileLocation& typeErrorLocation) -> PapyrusType {
+    auto memberArg = args[0].value;
+    if (resultType(memberArg).type != PapyrusType::Kind::String || kind(memberArg) != PapyrusExpressionKind::Literal) {
+      ctx->reportingContext.fatal(typeErrorLocation,
+                                  "Expected the literal name of the struct member as a string to compare against!");
+    }
+
+    auto memberName = value(memberArg).val.s;
+    PapyrusType elemType = PapyrusType::None(location(memberArg));
+    if (auto m = function.res.arrayFuncElementType->resolved.struc->tryFindMember(memberName))
+      elemType = m->type;
+    if (elemType.type == PapyrusType::Kind::None) {
+      ctx->reportingContext.fatal(location(memberArg),
+                                  "Unknown member '{}' of struct '{}'!",
+                                  memberName,
+                                  function.res.arrayFuncElementType->resolved.struc->name);
+    }
+    return elemType;
+  };
+
+  switch (function.arrayFuncKind) {
+    case PapyrusBuiltinArrayFunctionKind::Find:
+      getArgs("Find", 1, 2);
+      coerceArg(0, *function.res.arrayFuncElementType);
+      optionalIntArg(1, 0, "aiStartIndex");
+      break;
+    case PapyrusBuiltinArrayFunctionKind::FindStruct:
+      getArgs("FindStruct", 2, 3);
+      coerceArg(1, structMemberType(location(args[0].value)));
+      optionalIntArg(2, 0, "aiStartIndex");
+      break;
+    case PapyrusBuiltinArrayFunctionKind::RFind:
+      getArgs("RFind", 1, 2);
+      coerceArg(0, *function.res.arrayFuncElementType);
+      optionalIntArg(1, -1, "aiStartIndex");
+      break;
+    case PapyrusBuiltinArrayFunctionKind::RFindStruct:
+      getArgs("RFindStruct", 2, 3);
+      coerceArg(1, structMemberType(callLocation));
+      optionalIntArg(2, -1, "aiStartIndex");
+      break;
+    case PapyrusBuiltinArrayFunctionKind::Add:
+      getArgs("Add", 1, 2);
+      coerceArg(0, *function.res.arrayFuncElementType);
+      optionalIntArg(1, 1, "aiCount");
+      break;
+    case PapyrusBuiltinArrayFunctionKind::Clear:
+      getArgs("Clear", 0);
+      break;
+    case PapyrusBuiltinArrayFunctionKind::Insert:
+      getArgs("Insert", 2);
+      coerceArg(0, *function.res.arrayFuncElementType);
+      coerceArgToInt(1);
+      break;
+    case PapyrusBuiltinArrayFunctionKind::Remove:
+      getArgs("Remove", 1, 2);
+      coerceArgToInt(0);
+      optionalIntArg(1, 1, "aiCount");
+      break;
+    case PapyrusBuiltinArrayFunctionKind::RemoveLast:
+      getArgs("RemoveLast", 0);
+      break;
+    case PapyrusBuiltinArrayFunctionKind::GetMatchingStructs:
+      getArgs("GetMatchingStructs", 3, 4);
+      coerceArg(1, structMemberType(callLocation));
+      coerceArgToInt(2);
+      optionalIntArg(3, -1, "aiCount");
+      break;
+    case PapyrusBuiltinArrayFunctionKind::Unknown:
+      ctx->reportingContext.logicalFatal("Unknown PapyrusBuiltinArrayFunctionKind!");
+  }
+  setArguments(id, args);
+}
+
+}}}
@@ -508,8 +508,9 @@ StartOver:
           return setTok(f2->second, baseLoc);
       }
 
+      // Copied, so that the source can be let go of once it's been parsed.
       setTok(TokenType::Identifier, baseLoc);
-      cur.val.s = str;
+      cur.val.s = stringAlloc->allocateIdentifier(str.data(), str.size());
       return;
     }
 
@@ -549,7 +550,7 @@ StartOver:
 
       setTok(TokenType::String, baseLoc);
       if (charsRequired != str.size()) {
-        auto buf = alloc->allocate(charsRequired);
+        auto buf = stringAlloc->allocate(charsRequired);
         for (size_t i = 0, i2 = 0; i < charsRequired;) {
           if (baseStrm[i2] == '\\') {
             i2++;
@@ -578,7 +579,7 @@ StartOver:
         }
         cur.val.s = identifier_ref(buf, charsRequired);
       } else {
-        cur.val.s = alloc->allocateIdentifier(str.data(), str.size());
+        cur.val.s = stringAlloc->allocateIdentifier(str.data(), str.size());
       }
       return;
     }
@@ -649,7 +650,7 @@ StartOver:
       }
 
       if (charsRequired != str.size()) {
-        auto buf = alloc->allocate(charsRequired);
+        auto buf = stringAlloc->allocate(charsRequired);
         for (size_t i = 0, i2 = 0; i < charsRequired;) {
           if (baseStrm[i2] == '\r' && i2 + 1 < str.size() && baseStrm[i2 + 1] == '\n') {
             i2 += 2;
@@ -660,7 +661,7 @@ StartOver:
         }
         cur.val.s = identifier_ref(buf, charsRequired);
       } else {
-        cur.val.s = alloc->allocateIdentifier(str.data(), str.size());
+        cur.val.s = stringAlloc->allocateIdentifier(str.data(), str.size());
       }
       return;
     }
@@ -197,7 +197,7 @@ struct PapyrusLexer {
   };
 
   explicit PapyrusLexer(CapricaReportingContext& repCtx, const std::string& file, std::string_view data)
-      : filename(file), reportingContext(repCtx), alloc(new allocators::ChainedPool(1024 * 4)) {
+      : filename(file), reportingContext(repCtx), alloc(new allocators::ChainedPool(1024 * 4)), stringAlloc(alloc) {
     CapricaStats::lexedFilesCount++;
     strm = data.data();
     strmLen = data.size();
@@ -208,6 +208,9 @@ struct PapyrusLexer {
 
 protected:
   allocators::ChainedPool* alloc;
+  // What's lexed always outlives the function bodies, which the parser puts
+  // in a pool of their own.
+  allocators::ChainedPool* stringAlloc;
   CapricaReportingContext& reportingContext;
   std::string filename;
   Token cur { TokenType::Unknown };
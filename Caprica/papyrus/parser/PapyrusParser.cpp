@@ -8,20 +8,7 @@
 
 #include <papyrus/PapyrusObject.h>
 
-#include <papyrus/expressions/PapyrusArrayIndexExpression.h>
-#include <papyrus/expressions/PapyrusArrayLengthExpression.h>
-#include <papyrus/expressions/PapyrusBinaryOpExpression.h>
-#include <papyrus/expressions/PapyrusCastExpression.h>
-#include <papyrus/expressions/PapyrusFunctionCallExpression.h>
-#include <papyrus/expressions/PapyrusIdentifierExpression.h>
-#include <papyrus/expressions/PapyrusIsExpression.h>
-#include <papyrus/expressions/PapyrusLiteralExpression.h>
-#include <papyrus/expressions/PapyrusMemberAccessExpression.h>
-#include <papyrus/expressions/PapyrusNewArrayExpression.h>
-#include <papyrus/expressions/PapyrusNewStructExpression.h>
-#include <papyrus/expressions/PapyrusParentExpression.h>
-#include <papyrus/expressions/PapyrusSelfExpression.h>
-#include <papyrus/expressions/PapyrusUnaryOpExpression.h>
+#include <papyrus/expressions/PapyrusExpression.h>
 
 #include <papyrus/statements/PapyrusAssignStatement.h>
 #include <papyrus/statements/PapyrusBreakStatement.h>
@@ -123,6 +110,7 @@ static const caseless_unordered_identifier_ref_set skyrim_native_classes = {
 PapyrusScript* PapyrusParser::parseScript() {
   auto script = alloc->make<PapyrusScript>();
   script->allocator = alloc;
+  script->bodyAllocator = new allocators::ChainedPool(1024 * 4);
   script->sourceFileName = FSUtils::canonical(filename);
   script->objects.push_back(parseObject(script));
   return script;
@@ -515,7 +503,7 @@ PapyrusVariable* PapyrusParser::parseVariable(PapyrusScript*, PapyrusObject* obj
 }
 
 PapyrusFunction* PapyrusParser::parseFunction(
-    PapyrusScript*, PapyrusObject* object, PapyrusState*, PapyrusType&& returnType, TokenType endToken) {
+    PapyrusScript* script, PapyrusObject* object, PapyrusState*, PapyrusType&& returnType, TokenType endToken) {
   auto func = alloc->make<PapyrusFunction>(cur.location, std::move(returnType));
   if (endToken == TokenType::kEndFunction)
     func->functionType = PapyrusFunctionType::Function;
@@ -552,8 +540,12 @@ PapyrusFunction* PapyrusParser::parseFunction(
   expectConsumeEOLs();
   func->documentationComment = maybeConsumeDocStringRef();
   if (!func->isNative()) {
+    auto scriptAlloc = alloc;
+    alloc = script->bodyAllocator;
+    func->expressionStore = alloc->make<expressions::PapyrusExpressionStore>();
     while (cur.type != endToken && cur.type != TokenType::END)
       func->statements.push_back(parseStatement(func));
+    alloc = scriptAlloc;
 
     if (cur.type == TokenType::END) {
       reportingContext.error(cur.location, "Unexpected EOF in state body!");
@@ -859,7 +851,7 @@ statements::PapyrusStatement* PapyrusParser::parseStatement(PapyrusFunction* fun
         }
 
         default: {
-          auto exprStat = alloc->make<statements::PapyrusExpressionStatement>(expr->location);
+          auto exprStat = alloc->make<statements::PapyrusExpressionStatement>(func->expressionStore->location(expr));
           exprStat->expression = expr;
           expectConsumeEOLs();
           return exprStat;
@@ -869,31 +861,27 @@ statements::PapyrusStatement* PapyrusParser::parseStatement(PapyrusFunction* fun
   }
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseExpression(PapyrusFunction* func) {
   auto expr = parseAndExpression(func);
   while (cur.type == TokenType::BooleanOr) {
-    auto binExpr = alloc->make<expressions::PapyrusBinaryOpExpression>(consumeLocation());
-    binExpr->left = expr;
-    binExpr->operation = expressions::PapyrusBinaryOperatorType::BooleanOr;
-    binExpr->right = parseAndExpression(func);
-    expr = binExpr;
+    auto loc = consumeLocation();
+    auto right = parseAndExpression(func);
+    expr = func->expressionStore->makeBinaryOp(loc, expressions::PapyrusBinaryOperatorType::BooleanOr, expr, right);
   }
   return expr;
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseAndExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseAndExpression(PapyrusFunction* func) {
   auto expr = parseCmpExpression(func);
   while (cur.type == TokenType::BooleanAnd) {
-    auto binExpr = alloc->make<expressions::PapyrusBinaryOpExpression>(consumeLocation());
-    binExpr->left = expr;
-    binExpr->operation = expressions::PapyrusBinaryOperatorType::BooleanAnd;
-    binExpr->right = parseCmpExpression(func);
-    expr = binExpr;
+    auto loc = consumeLocation();
+    auto right = parseCmpExpression(func);
+    expr = func->expressionStore->makeBinaryOp(loc, expressions::PapyrusBinaryOperatorType::BooleanAnd, expr, right);
   }
   return expr;
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseCmpExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseCmpExpression(PapyrusFunction* func) {
   auto expr = parseAddExpression(func);
   while (true) {
     expressions::PapyrusBinaryOperatorType op = expressions::PapyrusBinaryOperatorType::None;
@@ -918,11 +906,9 @@ expressions::PapyrusExpression* PapyrusParser::parseCmpExpression(PapyrusFunctio
         goto OperatorCommon;
 
       OperatorCommon : {
-        auto binExpr = alloc->make<expressions::PapyrusBinaryOpExpression>(consumeLocation());
-        binExpr->left = expr;
-        binExpr->operation = op;
-        binExpr->right = parseAddExpression(func);
-        expr = binExpr;
+        auto loc = consumeLocation();
+        auto right = parseAddExpression(func);
+        expr = func->expressionStore->makeBinaryOp(loc, op, expr, right);
         break;
       }
 
@@ -934,7 +920,7 @@ Return:
   return expr;
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseAddExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseAddExpression(PapyrusFunction* func) {
   auto expr = parseMultExpression(func);
   while (true) {
     auto op = expressions::PapyrusBinaryOperatorType::None;
@@ -955,22 +941,18 @@ expressions::PapyrusExpression* PapyrusParser::parseAddExpression(PapyrusFunctio
         goto OperatorCommon;
 
       OperatorCommon : {
-        auto binExpr = alloc->make<expressions::PapyrusBinaryOpExpression>(consumeLocation());
-        binExpr->left = expr;
-        binExpr->operation = op;
-        binExpr->right = parseMultExpression(func);
-        expr = binExpr;
+        auto loc = consumeLocation();
+        auto right = parseMultExpression(func);
+        expr = func->expressionStore->makeBinaryOp(loc, op, expr, right);
         break;
       }
 
       DumbNegativesCommon : {
         if (!conf::Papyrus::allowNegativeLiteralAsBinaryOp)
           goto Return;
-        auto binExpr = alloc->make<expressions::PapyrusBinaryOpExpression>(cur.location);
-        binExpr->left = expr;
-        binExpr->operation = expressions::PapyrusBinaryOperatorType::Add;
-        binExpr->right = parseMultExpression(func);
-        expr = binExpr;
+        auto loc = cur.location;
+        auto right = parseMultExpression(func);
+        expr = func->expressionStore->makeBinaryOp(loc, expressions::PapyrusBinaryOperatorType::Add, expr, right);
         break;
       }
 
@@ -982,7 +964,7 @@ Return:
   return expr;
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseMultExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseMultExpression(PapyrusFunction* func) {
   auto expr = parseUnaryExpression(func);
   while (true) {
     auto op = expressions::PapyrusBinaryOperatorType::None;
@@ -998,11 +980,9 @@ expressions::PapyrusExpression* PapyrusParser::parseMultExpression(PapyrusFuncti
         goto OperatorCommon;
 
       OperatorCommon : {
-        auto binExpr = alloc->make<expressions::PapyrusBinaryOpExpression>(consumeLocation());
-        binExpr->left = expr;
-        binExpr->operation = op;
-        binExpr->right = parseUnaryExpression(func);
-        expr = binExpr;
+        auto loc = consumeLocation();
+        auto right = parseUnaryExpression(func);
+        expr = func->expressionStore->makeBinaryOp(loc, op, expr, right);
         break;
       }
 
@@ -1014,7 +994,7 @@ Return:
   return expr;
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseUnaryExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseUnaryExpression(PapyrusFunction* func) {
   auto op = expressions::PapyrusUnaryOperatorType::None;
   switch (cur.type) {
     case TokenType::Exclaim:
@@ -1025,35 +1005,30 @@ expressions::PapyrusExpression* PapyrusParser::parseUnaryExpression(PapyrusFunct
       goto OperatorCommon;
 
     OperatorCommon : {
-      auto unExpr = alloc->make<expressions::PapyrusUnaryOpExpression>(consumeLocation());
-      unExpr->operation = op;
-      unExpr->innerExpression = parseCastExpression(func);
-      return unExpr;
+      auto loc = consumeLocation();
+      auto inner = parseCastExpression(func);
+      return func->expressionStore->makeUnaryOp(loc, op, inner);
     }
     default:
       return parseCastExpression(func);
   }
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseCastExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseCastExpression(PapyrusFunction* func) {
   auto expr = parseDotExpression(func);
 
   if (cur.type == TokenType::kIs) {
     auto loc = consumeLocation();
-    auto isExpr = alloc->make<expressions::PapyrusIsExpression>(loc, expectConsumePapyrusType());
-    isExpr->innerExpression = expr;
-    expr = isExpr;
+    expr = func->expressionStore->makeIs(loc, expr, expectConsumePapyrusType());
   } else if (cur.type == TokenType::kAs) {
     auto loc = consumeLocation();
-    auto castExpr = alloc->make<expressions::PapyrusCastExpression>(loc, expectConsumePapyrusType());
-    castExpr->innerExpression = expr;
-    expr = castExpr;
+    expr = func->expressionStore->makeCast(loc, expr, expectConsumePapyrusType());
   }
 
   return expr;
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseDotExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseDotExpression(PapyrusFunction* func) {
   switch (cur.type) {
     case TokenType::Float:
     case TokenType::Integer:
@@ -1062,24 +1037,21 @@ expressions::PapyrusExpression* PapyrusParser::parseDotExpression(PapyrusFunctio
     case TokenType::kTrue:
     case TokenType::kFalse: {
       auto eLoc = cur.location;
-      return alloc->make<expressions::PapyrusLiteralExpression>(eLoc, expectConsumePapyrusValue());
+      return func->expressionStore->makeLiteral(eLoc, expectConsumePapyrusValue());
     }
 
     default: {
       auto expr = parseArrayExpression(func);
       while (cur.type == TokenType::Dot) {
-        auto maExpr = alloc->make<expressions::PapyrusMemberAccessExpression>(consumeLocation());
-        maExpr->baseExpression = expr;
-        maExpr->accessExpression = parseFuncOrIdExpression(func);
+        auto maLoc = consumeLocation();
+        auto access = parseFuncOrIdExpression(func);
+        expr = func->expressionStore->makeMemberAccess(maLoc, expr, access);
 
         if (cur.type == TokenType::LSquare) {
-          auto aiExpr = alloc->make<expressions::PapyrusArrayIndexExpression>(consumeLocation());
-          aiExpr->baseExpression = maExpr;
-          aiExpr->indexExpression = parseExpression(func);
+          auto aiLoc = consumeLocation();
+          auto index = parseExpression(func);
           expectConsume(TokenType::RSquare);
-          expr = aiExpr;
-        } else {
-          expr = maExpr;
+          expr = func->expressionStore->makeArrayIndex(aiLoc, expr, index);
         }
       }
       return expr;
@@ -1087,19 +1059,18 @@ expressions::PapyrusExpression* PapyrusParser::parseDotExpression(PapyrusFunctio
   }
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseArrayExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseArrayExpression(PapyrusFunction* func) {
   auto expr = parseAtomExpression(func);
   if (cur.type == TokenType::LSquare) {
-    auto aiExpr = alloc->make<expressions::PapyrusArrayIndexExpression>(consumeLocation());
-    aiExpr->baseExpression = expr;
-    aiExpr->indexExpression = parseExpression(func);
+    auto loc = consumeLocation();
+    auto index = parseExpression(func);
     expectConsume(TokenType::RSquare);
-    return aiExpr;
+    return func->expressionStore->makeArrayIndex(loc, expr, index);
   }
   return expr;
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseAtomExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseAtomExpression(PapyrusFunction* func) {
   switch (cur.type) {
     case TokenType::LParen: {
       consume();
@@ -1113,13 +1084,12 @@ expressions::PapyrusExpression* PapyrusParser::parseAtomExpression(PapyrusFuncti
       consume();
       auto tp = expectConsumePapyrusType();
       if (maybeConsume(TokenType::LSquare)) {
-        auto nArrExpr = alloc->make<expressions::PapyrusNewArrayExpression>(loc, std::move(tp));
-        nArrExpr->lengthExpression = parseExpression(func);
+        auto length = parseExpression(func);
         expectConsume(TokenType::RSquare);
-        return nArrExpr;
+        return func->expressionStore->makeNewArray(loc, std::move(tp), length);
       }
 
-      return alloc->make<expressions::PapyrusNewStructExpression>(loc, std::move(tp));
+      return func->expressionStore->makeNewStruct(loc, std::move(tp));
     }
 
     default:
@@ -1127,48 +1097,44 @@ expressions::PapyrusExpression* PapyrusParser::parseAtomExpression(PapyrusFuncti
   }
 }
 
-expressions::PapyrusExpression* PapyrusParser::parseFuncOrIdExpression(PapyrusFunction* func) {
+expressions::PapyrusExpressionId PapyrusParser::parseFuncOrIdExpression(PapyrusFunction* func) {
   switch (cur.type) {
     case TokenType::kLength:
-      return alloc->make<expressions::PapyrusArrayLengthExpression>(consumeLocation());
+      return func->expressionStore->makeArrayLength(consumeLocation());
     case TokenType::kParent:
-      return alloc->make<expressions::PapyrusParentExpression>(consumeLocation(), func->parentObject->parentClass);
+      return func->expressionStore->makeParent(consumeLocation(), func->parentObject->parentClass);
     case TokenType::kSelf: {
-      auto selfExpr = alloc->make<expressions::PapyrusSelfExpression>(
-          cur.location,
-          PapyrusType::ResolvedObject(cur.location, func->parentObject));
+      auto selfExpr =
+          func->expressionStore->makeSelf(cur.location, PapyrusType::ResolvedObject(cur.location, func->parentObject));
       consume();
       return selfExpr;
     }
     case TokenType::Identifier: {
       if (peekTokenType() == TokenType::LParen) {
         auto eLoc = cur.location;
-        auto fCallExpr = alloc->make<expressions::PapyrusFunctionCallExpression>(
-            eLoc,
-            PapyrusIdentifier::Unresolved(eLoc, expectConsumeIdentRef()));
+        auto function = PapyrusIdentifier::Unresolved(eLoc, expectConsumeIdentRef());
         expectConsume(TokenType::LParen);
 
+        std::vector<expressions::PapyrusFunctionCallArgument> args {};
         if (cur.type != TokenType::RParen) {
           do {
             maybeConsume(TokenType::Comma);
 
-            auto param = alloc->make<expressions::PapyrusFunctionCallExpression::Parameter>();
+            expressions::PapyrusFunctionCallArgument arg {};
             if (cur.type == TokenType::Identifier && peekTokenType() == TokenType::Equal) {
-              param->name = expectConsumeIdentRef();
+              arg.name = expectConsumeIdentRef();
               expectConsume(TokenType::Equal);
             }
-            param->value = parseExpression(func);
-            fCallExpr->arguments.push_back(param);
+            arg.value = parseExpression(func);
+            args.push_back(arg);
           } while (cur.type == TokenType::Comma);
         }
         expectConsume(TokenType::RParen);
 
-        return fCallExpr;
+        return func->expressionStore->makeFunctionCall(eLoc, std::move(function), args);
       } else {
         auto eLoc = cur.location;
-        return alloc->make<expressions::PapyrusIdentifierExpression>(
-            eLoc,
-            PapyrusIdentifier::Unresolved(eLoc, expectConsumeIdentRef()));
+        return func->expressionStore->makeIdentifier(eLoc, PapyrusIdentifier::Unresolved(eLoc, expectConsumeIdentRef()));
       }
     }
     default:
@@ -34,17 +34,17 @@ private:
 
   statements::PapyrusStatement* parseStatement(PapyrusFunction* func);
 
-  expressions::PapyrusExpression* parseExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseAndExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseCmpExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseAddExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseMultExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseUnaryExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseCastExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseDotExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseArrayExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseAtomExpression(PapyrusFunction* func);
-  expressions::PapyrusExpression* parseFuncOrIdExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseAndExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseCmpExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseAddExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseMultExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseUnaryExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseCastExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseDotExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseArrayExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseAtomExpression(PapyrusFunction* func);
+  expressions::PapyrusExpressionId parseFuncOrIdExpression(PapyrusFunction* func);
 
   PapyrusType expectConsumePapyrusType();
   PapyrusValue expectConsumePapyrusValue();
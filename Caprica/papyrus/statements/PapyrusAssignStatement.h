@@ -2,11 +2,7 @@
 
 #include <common/CapricaConfig.h>
 
-#include <papyrus/expressions/PapyrusArrayIndexExpression.h>
-#include <papyrus/expressions/PapyrusBinaryOpExpression.h>
 #include <papyrus/expressions/PapyrusExpression.h>
-#include <papyrus/expressions/PapyrusIdentifierExpression.h>
-#include <papyrus/expressions/PapyrusMemberAccessExpression.h>
 #include <papyrus/statements/PapyrusStatement.h>
 
 #include <pex/PexFile.h>
@@ -26,10 +22,10 @@ enum class PapyrusAssignOperatorType {
 };
 
 struct PapyrusAssignStatement final : public PapyrusStatement {
-  expressions::PapyrusExpression* lValue { nullptr };
+  expressions::PapyrusExpressionId lValue {};
   PapyrusAssignOperatorType operation { PapyrusAssignOperatorType::None };
-  expressions::PapyrusExpression* rValue { nullptr };
-  expressions::PapyrusBinaryOpExpression* binOpExpression { nullptr };
+  expressions::PapyrusExpressionId rValue {};
+  expressions::PapyrusExpressionId binOpExpression {};
 
   explicit PapyrusAssignStatement(CapricaFileLocation loc) : PapyrusStatement(loc) { }
   PapyrusAssignStatement(const PapyrusAssignStatement&) = delete;
@@ -40,68 +36,72 @@ struct PapyrusAssignStatement final : public PapyrusStatement {
     return false;
   }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
-    namespace op = caprica::pex::op;
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
+    using expressions::PapyrusExpressionKind;
     pex::PexValue rVal;
     if (binOpExpression) {
-      rVal = binOpExpression->generateLoad(file, bldr);
+      rVal = exprs.generateLoad(file, bldr, binOpExpression);
     } else {
-      rVal = rValue->generateLoad(file, bldr);
+      rVal = exprs.generateLoad(file, bldr, rValue);
       if (conf::Papyrus::game == GameID::Skyrim && rVal.type == pex::PexValueType::Invalid) {
         // check if if the rValue is the result of a function call
         auto travRValueExpression = rValue;
         while (true) {
-          if (auto fc = travRValueExpression->asFunctionCallExpression()) {
+          auto travKind = exprs.kind(travRValueExpression);
+          if (travKind == PapyrusExpressionKind::FunctionCall) {
             // this was a void method call that was assigned to this variable; change it to None and emit a warning
-            if (fc->resultType().type == PapyrusType::Kind::None) {
-              rVal = bldr.getNoneLocal(fc->location);
+            if (exprs.resultType(travRValueExpression).type == PapyrusType::Kind::None) {
+              rVal = bldr.getNoneLocal(exprs.location(travRValueExpression));
               bldr.reportingContext.warning_W7004_Skyrim_Assignment_Of_Void_Call_Result(
-                  fc->location,
-                  fc->function.res.name);
+                  exprs.location(travRValueExpression),
+                  exprs.call(travRValueExpression).function.res.name);
             }
             break;
           }
-          if (auto ma = travRValueExpression->asMemberAccessExpression()) {
-            travRValueExpression = ma->accessExpression;
+          if (travKind == PapyrusExpressionKind::MemberAccess) {
+            travRValueExpression = exprs.node(travRValueExpression).second;
             continue;
           }
-          if (auto ai = travRValueExpression->asCastExpression()) {
-            travRValueExpression = ai->innerExpression;
+          if (travKind == PapyrusExpressionKind::Cast) {
+            travRValueExpression = exprs.node(travRValueExpression).first;
             continue;
           }
           break; // we didn't find a function call expression
         }
       }
     }
-    if (auto id = lValue->asIdentifierExpression()) {
-      bldr << location;
-      id->identifier.generateStore(file, bldr, pex::PexValue::Identifier(file->getString("self")), rVal);
-    } else if (auto ai = lValue->asArrayIndexExpression()) {
-      bldr << location;
-      ai->generateStore(file, bldr, rVal);
-    } else if (auto ma = lValue->asMemberAccessExpression()) {
-      bldr << location;
-      ma->generateStore(file, bldr, rVal);
-    } else {
-      CapricaReportingContext::logicalFatal("Invalid Lefthand Side for PapyrusAssignStatement!");
+    switch (exprs.kind(lValue)) {
+      case PapyrusExpressionKind::Identifier:
+        bldr << location;
+        exprs.identifier(lValue).generateStore(file, bldr, pex::PexValue::Identifier(file->getString("self")), rVal);
+        return;
+      case PapyrusExpressionKind::ArrayIndex:
+      case PapyrusExpressionKind::MemberAccess:
+        bldr << location;
+        exprs.generateStore(file, bldr, lValue, rVal);
+        return;
+      default:
+        break;
     }
+    CapricaReportingContext::logicalFatal("Invalid Lefthand Side for PapyrusAssignStatement!");
   }
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
-    if (auto id = lValue->asIdentifierExpression())
-      id->isAssignmentContext = true;
+    using expressions::PapyrusExpressionKind;
+    auto& exprs = *ctx->expressionStore;
+    if (exprs.kind(lValue) == PapyrusExpressionKind::Identifier)
+      exprs.node(lValue).isAssignmentContext = true;
 
     if (operation == PapyrusAssignOperatorType::Assign) {
-      lValue->semantic(ctx);
-      ctx->checkForPoison(lValue);
-      rValue->semantic(ctx);
-      ctx->checkForPoison(rValue);
-      rValue = ctx->coerceExpression(rValue, lValue->resultType());
+      exprs.semantic(ctx, lValue);
+      ctx->checkForPoison(exprs.resultType(lValue));
+      exprs.semantic(ctx, rValue);
+      ctx->checkForPoison(exprs.resultType(rValue));
+      rValue = ctx->coerceExpression(rValue, exprs.resultType(lValue));
     } else {
-      binOpExpression = ctx->allocator->make<expressions::PapyrusBinaryOpExpression>(location);
-      binOpExpression->left = lValue;
-      binOpExpression->right = rValue;
-      binOpExpression->operation = [](PapyrusAssignOperatorType op) {
+      auto binOp = [](PapyrusAssignOperatorType op) {
         switch (op) {
           case PapyrusAssignOperatorType::Add:
             return expressions::PapyrusBinaryOperatorType::Add;
@@ -119,26 +119,34 @@ struct PapyrusAssignStatement final : public PapyrusStatement {
         }
         CapricaReportingContext::logicalFatal("Unknown PapyrusAssignOperatorType!");
       }(operation);
-      binOpExpression->semantic(ctx);
-      ctx->checkForPoison(binOpExpression);
-      if (lValue->resultType().type == PapyrusType::Kind::Array && !conf::Papyrus::enableLanguageExtensions) {
+      binOpExpression = exprs.makeBinaryOp(location, binOp, lValue, rValue);
+      exprs.semantic(ctx, binOpExpression);
+      ctx->checkForPoison(exprs.resultType(binOpExpression));
+      if (exprs.resultType(lValue).type == PapyrusType::Kind::Array && !conf::Papyrus::enableLanguageExtensions) {
         ctx->reportingContext.error(
             location,
             "You can't do anything except assign to an array element unless you have language extensions enabled!");
       }
-      rValue = ctx->coerceExpression(binOpExpression, lValue->resultType());
+      rValue = ctx->coerceExpression(binOpExpression, exprs.resultType(lValue));
     }
 
-    if (auto id = lValue->asIdentifierExpression()) {
-      id->identifier.ensureAssignable(ctx->reportingContext);
-      id->identifier.markWritten();
-    } else if (auto ai = lValue->asArrayIndexExpression()) {
-      // It's valid.
-    } else if (auto ma = lValue->asMemberAccessExpression()) {
-      if (auto ident = ma->accessExpression->asIdentifierExpression())
-        ident->identifier.ensureAssignable(ctx->reportingContext);
-    } else {
-      ctx->reportingContext.error(lValue->location, "Invalid Lefthand Side for PapyrusAssignStatement!");
+    switch (exprs.kind(lValue)) {
+      case PapyrusExpressionKind::Identifier:
+        exprs.identifier(lValue).ensureAssignable(ctx->reportingContext);
+        exprs.identifier(lValue).markWritten();
+        break;
+      case PapyrusExpressionKind::ArrayIndex:
+        // It's valid.
+        break;
+      case PapyrusExpressionKind::MemberAccess: {
+        auto access = exprs.node(lValue).second;
+        if (exprs.kind(access) == PapyrusExpressionKind::Identifier)
+          exprs.identifier(access).ensureAssignable(ctx->reportingContext);
+        break;
+      }
+      default:
+        ctx->reportingContext.error(exprs.location(lValue), "Invalid Lefthand Side for PapyrusAssignStatement!");
+        break;
     }
   }
 
@@ -18,7 +18,9 @@ struct PapyrusBreakStatement final : public PapyrusStatement {
     return true;
   }
 
-  virtual void buildPex(pex::PexFile*, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile*,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore&) const override {
     namespace op = caprica::pex::op;
     bldr << op::jmp { bldr.currentBreakTarget() };
   }
@@ -17,7 +17,9 @@ struct PapyrusContinueStatement final : public PapyrusStatement {
     return true;
   }
 
-  virtual void buildPex(pex::PexFile*, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile*,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore&) const override {
     namespace op = caprica::pex::op;
     bldr << op::jmp { bldr.currentContinueTarget() };
   }
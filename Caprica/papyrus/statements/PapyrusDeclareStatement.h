@@ -16,42 +16,42 @@ struct PapyrusDeclareStatement final : public PapyrusStatement {
   identifier_ref name { "" };
   bool isAuto { false };
   bool isConst { false };
-  expressions::PapyrusExpression* initialValue { nullptr };
+  expressions::PapyrusExpressionId initialValue {};
 
   explicit PapyrusDeclareStatement(CapricaFileLocation loc, PapyrusType&& tp)
       : PapyrusStatement(loc), type(std::move(tp)) { }
   PapyrusDeclareStatement(const PapyrusDeclareStatement&) = delete;
-  virtual ~PapyrusDeclareStatement() override {
-    if (initialValue)
-      delete initialValue;
-  }
+  virtual ~PapyrusDeclareStatement() override = default;
 
   virtual bool buildCFG(PapyrusCFG& cfg) const override {
     cfg.appendStatement(this);
     return false;
   }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
     namespace op = caprica::pex::op;
     auto loc = bldr.allocateLocal(name, type);
     if (initialValue) {
-      auto val = initialValue->generateLoad(file, bldr);
+      auto val = exprs.generateLoad(file, bldr, initialValue);
       bldr << location;
       bldr << op::assign { loc, val };
     }
   }
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
+    auto& exprs = *ctx->expressionStore;
     if (isAuto) {
-      initialValue->semantic(ctx);
-      ctx->checkForPoison(initialValue);
-      type = initialValue->resultType();
+      exprs.semantic(ctx, initialValue);
+      ctx->checkForPoison(exprs.resultType(initialValue));
+      type = exprs.resultType(initialValue);
     } else {
       type = ctx->resolveType(type);
 
       if (initialValue) {
-        initialValue->semantic(ctx);
-        ctx->checkForPoison(initialValue);
+        exprs.semantic(ctx, initialValue);
+        ctx->checkForPoison(exprs.resultType(initialValue));
         initialValue = ctx->coerceExpression(initialValue, type);
       }
     }
@@ -11,7 +11,7 @@
 namespace caprica { namespace papyrus { namespace statements {
 
 struct PapyrusDoWhileStatement final : public PapyrusStatement {
-  expressions::PapyrusExpression* condition { nullptr };
+  expressions::PapyrusExpressionId condition {};
   IntrusiveLinkedList<PapyrusStatement> body {};
 
   explicit PapyrusDoWhileStatement(CapricaFileLocation loc) : PapyrusStatement(loc) { }
@@ -20,8 +20,9 @@ struct PapyrusDoWhileStatement final : public PapyrusStatement {
 
   virtual bool buildCFG(PapyrusCFG& cfg) const override { return cfg.processCommonLoopBody(body); }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
-    namespace op = caprica::pex::op;
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
     pex::PexLabel* beforeCondition;
     bldr >> beforeCondition;
     pex::PexLabel* afterAll;
@@ -32,21 +33,20 @@ struct PapyrusDoWhileStatement final : public PapyrusStatement {
 
     bldr << beforeBody;
     for (auto s : body)
-      s->buildPex(file, bldr);
+      s->buildPex(file, bldr, exprs);
 
     bldr << beforeCondition;
-    auto lVal = condition->generateLoad(file, bldr);
-    bldr << location;
-    bldr << op::jmpt { lVal, beforeBody };
+    exprs.generateBranch(file, bldr, condition, true, beforeBody, location);
 
     bldr << afterAll;
     bldr.popBreakContinueScope();
   }
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
-    condition->semantic(ctx);
-    ctx->checkForPoison(condition);
-    condition = ctx->coerceExpression(condition, PapyrusType::Bool(condition->location));
+    auto& exprs = *ctx->expressionStore;
+    exprs.semantic(ctx, condition);
+    ctx->checkForPoison(exprs.resultType(condition));
+    condition = ctx->coerceExpression(condition, PapyrusType::Bool(exprs.location(condition)));
     ctx->pushBreakContinueScope();
     ctx->pushLocalVariableScope();
     if (conf::Papyrus::game == GameID::Skyrim)
@@ -9,7 +9,7 @@
 namespace caprica { namespace papyrus { namespace statements {
 
 struct PapyrusExpressionStatement final : public PapyrusStatement {
-  expressions::PapyrusExpression* expression { nullptr };
+  expressions::PapyrusExpressionId expression {};
 
   explicit PapyrusExpressionStatement(CapricaFileLocation loc) : PapyrusStatement(loc) { }
   PapyrusExpressionStatement(const PapyrusExpressionStatement&) = delete;
@@ -20,14 +20,17 @@ struct PapyrusExpressionStatement final : public PapyrusStatement {
     return false;
   }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
-    bldr.freeValueIfTemp(expression->generateLoad(file, bldr));
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
+    bldr.freeValueIfTemp(exprs.generateLoad(file, bldr, expression));
   }
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
+    auto& exprs = *ctx->expressionStore;
     // We don't explicitly use the result of the expression, so we don't
     // check it for poison.
-    expression->semantic(ctx);
+    exprs.semantic(ctx, expression);
   }
 
   virtual void visit(PapyrusStatementVisitor& visitor) override { visitor.visit(this); }
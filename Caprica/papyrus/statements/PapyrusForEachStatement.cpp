@@ -4,7 +4,9 @@
 
 namespace caprica { namespace papyrus { namespace statements {
 
-void PapyrusForEachStatement::buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const {
+void PapyrusForEachStatement::buildPex(pex::PexFile* file,
+                                       pex::PexFunctionBuilder& bldr,
+                                       const expressions::PapyrusExpressionStore& exprs) const {
   namespace op = caprica::pex::op;
   pex::PexLabel* beforeCondition;
   bldr >> beforeCondition;
@@ -14,15 +16,15 @@ void PapyrusForEachStatement::buildPex(pex::PexFile* file, pex::PexFunctionBuild
   bldr >> continueLabel;
   bldr.pushBreakContinueScope(afterAll, continueLabel);
   auto counter = bldr.allocLongLivedTemp(PapyrusType::Int(location));
-  auto iterVal = bldr.allocLongLivedTemp(expressionToIterate->resultType());
+  auto iterVal = bldr.allocLongLivedTemp(exprs.resultType(expressionToIterate));
   bldr << location;
   bldr << op::assign { counter, pex::PexValue::Integer(0) };
-  auto baseVal = expressionToIterate->generateLoad(file, bldr);
+  auto baseVal = exprs.generateLoad(file, bldr, expressionToIterate);
   bldr << location;
   bldr << op::assign { iterVal, baseVal };
   bldr << beforeCondition;
   auto cTemp = bldr.allocTemp(PapyrusType::Int(location));
-  if (expressionToIterate->resultType().type == PapyrusType::Kind::Array)
+  if (exprs.resultType(expressionToIterate).type == PapyrusType::Kind::Array)
     bldr << op::arraylength { cTemp, iterVal };
   else
     bldr << op::callmethod { file->getString(getCountIdentifier->res.func->name), iterVal, cTemp, {} };
@@ -32,16 +34,14 @@ void PapyrusForEachStatement::buildPex(pex::PexFile* file, pex::PexFunctionBuild
 
   auto loc = bldr.allocateLocal(declareStatement->name, declareStatement->type);
   bldr << location;
-  if (expressionToIterate->resultType().type == PapyrusType::Kind::Array) {
+  if (exprs.resultType(expressionToIterate).type == PapyrusType::Kind::Array) {
     bldr << op::arraygetelement { loc, iterVal, counter };
   } else {
-    IntrusiveLinkedList<pex::IntrusivePexValue> args;
-    args.push_back(file->alloc->make<pex::IntrusivePexValue>(counter));
-    bldr << op::callmethod { file->getString(getAtIdentifier->res.func->name), iterVal, loc, std::move(args) };
+    bldr << op::callmethod { file->getString(getAtIdentifier->res.func->name), iterVal, loc, { counter } };
   }
 
   for (auto s : body)
-    s->buildPex(file, bldr);
+    s->buildPex(file, bldr, exprs);
 
   bldr << location;
   bldr << continueLabel;
@@ -54,8 +54,9 @@ void PapyrusForEachStatement::buildPex(pex::PexFile* file, pex::PexFunctionBuild
 }
 
 void PapyrusForEachStatement::semantic(PapyrusResolutionContext* ctx) {
-  expressionToIterate->semantic(ctx);
-  ctx->checkForPoison(expressionToIterate);
+  auto& exprs = *ctx->expressionStore;
+  exprs.semantic(ctx, expressionToIterate);
+  ctx->checkForPoison(exprs.resultType(expressionToIterate));
   auto elementType = [this, ctx](const PapyrusType& tp) -> PapyrusType {
     if (tp.type == PapyrusType::Kind::Array) {
       return tp.getElementType();
@@ -110,7 +111,7 @@ void PapyrusForEachStatement::semantic(PapyrusResolutionContext* ctx) {
       ctx->reportingContext.error(tp.location, "Cannot iterate over a value of type '{}'!", tp);
       return PapyrusType::None(tp.location);
     }
-  }(expressionToIterate->resultType());
+  }(exprs.resultType(expressionToIterate));
 
   ctx->pushBreakContinueScope();
   ctx->pushLocalVariableScope();
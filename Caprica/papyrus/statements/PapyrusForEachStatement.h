@@ -13,7 +13,7 @@ namespace caprica { namespace papyrus { namespace statements {
 
 struct PapyrusForEachStatement final : public PapyrusStatement {
   PapyrusDeclareStatement* declareStatement { nullptr };
-  expressions::PapyrusExpression* expressionToIterate { nullptr };
+  expressions::PapyrusExpressionId expressionToIterate {};
   IntrusiveLinkedList<PapyrusStatement> body {};
   PapyrusIdentifier* getCountIdentifier { nullptr };
   PapyrusIdentifier* getAtIdentifier { nullptr };
@@ -26,7 +26,9 @@ struct PapyrusForEachStatement final : public PapyrusStatement {
     cfg.appendStatement(declareStatement);
     return cfg.processCommonLoopBody(body);
   }
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override;
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override;
   virtual void semantic(PapyrusResolutionContext* ctx) override;
   virtual void visit(PapyrusStatementVisitor& visitor) override {
     visitor.visit(this);
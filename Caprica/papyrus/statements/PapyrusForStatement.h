@@ -14,9 +14,9 @@ namespace caprica { namespace papyrus { namespace statements {
 struct PapyrusForStatement final : public PapyrusStatement {
   PapyrusDeclareStatement* declareStatement { nullptr };
   PapyrusIdentifier* iteratorVariable { nullptr };
-  expressions::PapyrusExpression* initialValue { nullptr };
-  expressions::PapyrusExpression* targetValue { nullptr };
-  expressions::PapyrusExpression* stepValue { nullptr };
+  expressions::PapyrusExpressionId initialValue {};
+  expressions::PapyrusExpressionId targetValue {};
+  expressions::PapyrusExpressionId stepValue {};
   IntrusiveLinkedList<PapyrusStatement> body {};
 
   explicit PapyrusForStatement(const CapricaFileLocation& loc) : PapyrusStatement(loc) { }
@@ -29,7 +29,9 @@ struct PapyrusForStatement final : public PapyrusStatement {
     return cfg.processCommonLoopBody(body);
   }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
     namespace op = caprica::pex::op;
     namespace op = caprica::pex::op;
     pex::PexLabel* beforeCondition;
@@ -41,7 +43,7 @@ struct PapyrusForStatement final : public PapyrusStatement {
     bldr.pushBreakContinueScope(afterAll, continueLabel);
 
     pex::PexValue loadedCounter;
-    auto iVal = initialValue->generateLoad(file, bldr);
+    auto iVal = exprs.generateLoad(file, bldr, initialValue);
     if (declareStatement) {
       auto loc = bldr.allocateLocal(declareStatement->name, declareStatement->type);
       bldr << location;
@@ -53,17 +55,17 @@ struct PapyrusForStatement final : public PapyrusStatement {
 
     pex::PexLocalVariable* sValLoc { nullptr };
     pex::PexValue sVal;
-    if (stepValue && !stepValue->asLiteralExpression()) {
-      auto stepValVal = stepValue->generateLoad(file, bldr);
+    if (stepValue && exprs.kind(stepValue) != expressions::PapyrusExpressionKind::Literal) {
+      auto stepValVal = exprs.generateLoad(file, bldr, stepValue);
       bldr << location;
-      sValLoc = bldr.allocLongLivedTemp(initialValue->resultType());
+      sValLoc = bldr.allocLongLivedTemp(exprs.resultType(initialValue));
       bldr << op::assign { sValLoc, stepValVal };
       sVal = sValLoc;
     } else {
       bldr << location;
       if (stepValue) // It's a literal expression, inline it.
-        sVal = stepValue->generateLoad(file, bldr);
-      else if (initialValue->resultType().type == PapyrusType::Kind::Int)
+        sVal = exprs.generateLoad(file, bldr, stepValue);
+      else if (exprs.resultType(initialValue).type == PapyrusType::Kind::Int)
         sVal = pex::PexValue::Integer(1);
       else
         sVal = pex::PexValue::Float(1);
@@ -71,20 +73,20 @@ struct PapyrusForStatement final : public PapyrusStatement {
 
     pex::PexLocalVariable* tValLoc { nullptr };
     pex::PexValue tVal;
-    if (!targetValue->asLiteralExpression()) {
-      tValLoc = bldr.allocLongLivedTemp(targetValue->resultType());
-      auto targValVal = targetValue->generateLoad(file, bldr);
+    if (exprs.kind(targetValue) != expressions::PapyrusExpressionKind::Literal) {
+      tValLoc = bldr.allocLongLivedTemp(exprs.resultType(targetValue));
+      auto targValVal = exprs.generateLoad(file, bldr, targetValue);
       bldr << location;
       bldr << op::assign { tValLoc, targValVal };
       tVal = tValLoc;
     } else {
-      tVal = targetValue->generateLoad(file, bldr);
+      tVal = exprs.generateLoad(file, bldr, targetValue);
     }
 
     pex::PexLocalVariable* lowerStep { nullptr };
     if (sValLoc) {
       lowerStep = bldr.allocLongLivedTemp(PapyrusType::Bool(location));
-      if (initialValue->resultType().type == PapyrusType::Kind::Int)
+      if (exprs.resultType(initialValue).type == PapyrusType::Kind::Int)
         bldr << op::cmpgt { lowerStep, sVal, pex::PexValue::Integer(0) };
       else
         bldr << op::cmpgt { lowerStep, sVal, pex::PexValue::Float(0) };
@@ -115,7 +117,7 @@ struct PapyrusForStatement final : public PapyrusStatement {
     bldr << op::jmpf { bTemp, afterAll };
 
     for (auto s : body)
-      s->buildPex(file, bldr);
+      s->buildPex(file, bldr, exprs);
 
     bldr << continueLabel;
     bldr << location;
@@ -146,40 +148,41 @@ struct PapyrusForStatement final : public PapyrusStatement {
   }
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
-    initialValue->semantic(ctx);
-    ctx->checkForPoison(initialValue);
-    if (initialValue->resultType().type != PapyrusType::Kind::Int &&
-        initialValue->resultType().type != PapyrusType::Kind::Float) {
+    auto& exprs = *ctx->expressionStore;
+    exprs.semantic(ctx, initialValue);
+    ctx->checkForPoison(exprs.resultType(initialValue));
+    if (exprs.resultType(initialValue).type != PapyrusType::Kind::Int &&
+        exprs.resultType(initialValue).type != PapyrusType::Kind::Float) {
       ctx->reportingContext.error(
-          initialValue->location,
+          exprs.location(initialValue),
           "For statements only support Int and Float counter values, got an initial value of type '{}'!",
-          initialValue->resultType());
+          exprs.resultType(initialValue));
     }
-    targetValue->semantic(ctx);
-    ctx->checkForPoison(targetValue);
-    if (targetValue->resultType().type != PapyrusType::Kind::Int &&
-        targetValue->resultType().type != PapyrusType::Kind::Float) {
+    exprs.semantic(ctx, targetValue);
+    ctx->checkForPoison(exprs.resultType(targetValue));
+    if (exprs.resultType(targetValue).type != PapyrusType::Kind::Int &&
+        exprs.resultType(targetValue).type != PapyrusType::Kind::Float) {
       ctx->reportingContext.error(
-          initialValue->location,
+          exprs.location(initialValue),
           "For statements only support Int and Float counter values, got a target value of type '{}'!",
-          targetValue->resultType());
+          exprs.resultType(targetValue));
     }
     // TODO: Allow some implicit coercion and add checks about the declare/iterator/step expressions' types as well.
-    if (targetValue->resultType() != initialValue->resultType()) {
-      ctx->reportingContext.error(initialValue->location,
+    if (exprs.resultType(targetValue) != exprs.resultType(initialValue)) {
+      ctx->reportingContext.error(exprs.location(initialValue),
                                   "The initial value, of type '{}', does not match the target value type '{}'!",
-                                  initialValue->resultType(),
-                                  targetValue->resultType());
+                                  exprs.resultType(initialValue),
+                                  exprs.resultType(targetValue));
     }
     if (stepValue) {
-      stepValue->semantic(ctx);
-      ctx->checkForPoison(stepValue);
-      if (stepValue->resultType().type != PapyrusType::Kind::Int &&
-          stepValue->resultType().type != PapyrusType::Kind::Float) {
+      exprs.semantic(ctx, stepValue);
+      ctx->checkForPoison(exprs.resultType(stepValue));
+      if (exprs.resultType(stepValue).type != PapyrusType::Kind::Int &&
+          exprs.resultType(stepValue).type != PapyrusType::Kind::Float) {
         ctx->reportingContext.error(
-            initialValue->location,
+            exprs.location(initialValue),
             "For statements only support Int and Float counter values, got a step value of type '{}'!",
-            stepValue->resultType());
+            exprs.resultType(stepValue));
       }
     }
 
@@ -187,14 +190,14 @@ struct PapyrusForStatement final : public PapyrusStatement {
     ctx->pushLocalVariableScope();
     if (declareStatement) {
       if (declareStatement->isAuto) {
-        declareStatement->type = initialValue->resultType();
+        declareStatement->type = exprs.resultType(initialValue);
         declareStatement->isAuto = false;
       }
       declareStatement->semantic(ctx);
       if (declareStatement->type.type != PapyrusType::Kind::Int &&
           declareStatement->type.type != PapyrusType::Kind::Float) {
         ctx->reportingContext.error(
-            initialValue->location,
+            exprs.location(initialValue),
             "For statements only support Int and Float counter values, got a counter of type '{}'!",
             declareStatement->type);
       }
@@ -205,7 +208,7 @@ struct PapyrusForStatement final : public PapyrusStatement {
       if (iteratorVariable->resultType().type != PapyrusType::Kind::Int &&
           iteratorVariable->resultType().type != PapyrusType::Kind::Float) {
         ctx->reportingContext.error(
-            initialValue->location,
+            exprs.location(initialValue),
             "For statements only support Int and Float counter values, got a counter of type '{}'!",
             iteratorVariable->resultType());
       }
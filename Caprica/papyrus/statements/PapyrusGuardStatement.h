@@ -34,16 +34,18 @@ struct PapyrusGuardStatement final : public PapyrusStatement {
     return isTerminal;
   }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
     namespace op = caprica::pex::op;
-    IntrusiveLinkedList<pex::IntrusivePexValue> args;
+    std::vector<pex::PexValue> args;
     for (auto guard : lockParams)
-      args.push_back(file->alloc->make<pex::IntrusivePexValue>(pex::PexValue(file->getString(guard->name))));
+      args.push_back(pex::PexValue(file->getString(guard->name)));
     bldr << location;
-    bldr << op::lockguards { std::move(args) };
-    bldr.pushLockScope(std::move(args));
+    bldr << op::lockguards { args };
+    bldr.pushLockScope(args);
     for (auto s : body)
-      s->buildPex(file, bldr);
+      s->buildPex(file, bldr, exprs);
     bldr.popLockScope();
     bldr << location;
     bldr << op::unlockguards { std::move(args) };
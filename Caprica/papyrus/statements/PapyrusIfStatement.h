@@ -12,10 +12,10 @@ namespace caprica { namespace papyrus { namespace statements {
 
 struct PapyrusIfStatement final : public PapyrusStatement {
   struct IfBody final {
-    expressions::PapyrusExpression* condition { nullptr };
+    expressions::PapyrusExpressionId condition {};
     IntrusiveLinkedList<PapyrusStatement> body {};
 
-    IfBody(expressions::PapyrusExpression* c, IntrusiveLinkedList<PapyrusStatement>&& b)
+    IfBody(expressions::PapyrusExpressionId c, IntrusiveLinkedList<PapyrusStatement>&& b)
         : condition(c), body(std::move(b)) { }
 
   private:
@@ -49,7 +49,9 @@ struct PapyrusIfStatement final : public PapyrusStatement {
     return isTerminal;
   }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
     namespace op = caprica::pex::op;
     pex::PexLabel* afterAll;
     bldr >> afterAll;
@@ -58,26 +60,25 @@ struct PapyrusIfStatement final : public PapyrusStatement {
       if (nextCondition)
         bldr << nextCondition;
       bldr >> nextCondition;
-      auto lVal = ifBody->condition->generateLoad(file, bldr);
-      bldr << location;
-      bldr << op::jmpf { lVal, nextCondition };
+      exprs.generateBranch(file, bldr, ifBody->condition, false, nextCondition, location);
       for (auto s : ifBody->body)
-        s->buildPex(file, bldr);
+        s->buildPex(file, bldr, exprs);
       bldr << location;
       bldr << op::jmp { afterAll };
     }
 
     bldr << nextCondition;
     for (auto s : elseStatements)
-      s->buildPex(file, bldr);
+      s->buildPex(file, bldr, exprs);
     bldr << afterAll;
   }
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
+    auto& exprs = *ctx->expressionStore;
     for (auto& i : ifBodies) {
-      i->condition->semantic(ctx);
-      ctx->checkForPoison(i->condition);
-      i->condition = ctx->coerceExpression(i->condition, PapyrusType::Bool(i->condition->location));
+      exprs.semantic(ctx, i->condition);
+      ctx->checkForPoison(exprs.resultType(i->condition));
+      i->condition = ctx->coerceExpression(i->condition, PapyrusType::Bool(exprs.location(i->condition)));
       ctx->pushLocalVariableScope();
       if (conf::Papyrus::game == GameID::Skyrim)
         for (auto s : i->body)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <papyrus/expressions/PapyrusExpression.h>
+#include <papyrus/PapyrusFunction.h>
 #include <papyrus/statements/PapyrusStatement.h>
 
 #include <pex/PexFile.h>
@@ -10,7 +11,7 @@
 namespace caprica { namespace papyrus { namespace statements {
 
 struct PapyrusReturnStatement final : public PapyrusStatement {
-  expressions::PapyrusExpression* returnValue { nullptr };
+  expressions::PapyrusExpressionId returnValue {};
 
   explicit PapyrusReturnStatement(CapricaFileLocation loc) : PapyrusStatement(loc) { }
   PapyrusReturnStatement(const PapyrusReturnStatement&) = delete;
@@ -21,9 +22,11 @@ struct PapyrusReturnStatement final : public PapyrusStatement {
     return true;
   }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
     namespace op = caprica::pex::op;
-    auto val = !returnValue ? pex::PexValue::None() : returnValue->generateLoad(file, bldr);
+    auto val = !returnValue ? pex::PexValue::None() : exprs.generateLoad(file, bldr, returnValue);
     bldr << location;
     bldr.generateUnlockGuardsForCurrentLockScope();
     bldr << location;
@@ -31,9 +34,10 @@ struct PapyrusReturnStatement final : public PapyrusStatement {
   }
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
+    auto& exprs = *ctx->expressionStore;
     if (returnValue) {
-      returnValue->semantic(ctx);
-      ctx->checkForPoison(returnValue);
+      exprs.semantic(ctx, returnValue);
+      ctx->checkForPoison(exprs.resultType(returnValue));
       returnValue = ctx->coerceExpression(returnValue, ctx->function->returnType);
     }
   }
@@ -11,7 +11,13 @@
 #include <pex/PexFunctionBuilder.h>
 #include <pex/PexValue.h>
 
-namespace caprica { namespace papyrus { namespace statements {
+namespace caprica { namespace papyrus {
+
+namespace expressions {
+struct PapyrusExpressionStore;
+}
+
+namespace statements {
 
 struct PapyrusStatement abstract {
   const CapricaFileLocation location;
@@ -21,7 +27,9 @@ struct PapyrusStatement abstract {
   virtual ~PapyrusStatement() = default;
 
   virtual bool buildCFG(PapyrusCFG& cfg) const = 0;
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const = 0;
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const = 0;
   virtual void semantic(PapyrusResolutionContext* ctx) = 0;
   virtual void semantic_skyrim_first_pass(PapyrusResolutionContext* ctx) {};
   virtual void visit(PapyrusStatementVisitor& visitor) = 0;
@@ -0,0 +1,141 @@
+#include <papyrus/statements/PapyrusSwitchStatement.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+#include <common/CaselessStringComparer.h>
+
+namespace caprica { namespace papyrus { namespace statements {
+
+void PapyrusSwitchStatement::buildPex(pex::PexFile* file,
+                                      pex::PexFunctionBuilder& bldr,
+                                      const expressions::PapyrusExpressionStore& exprs) const {
+  auto tmpDest = bldr.allocLongLivedTemp(exprs.resultType(condition));
+  bldr << location;
+  bldr << pex::op::assign { tmpDest, exprs.generateLoad(file, bldr, condition) };
+
+  // A case matching the same value as one before it can never be reached,
+  // so it's dropped. Strings compare caselessly, but what that means outside
+  // of printable ASCII is up to the VM, so those only count on an exact match.
+  std::vector<const CaseBody*> cases {};
+  cases.reserve(caseBodies.size());
+  if (exprs.resultType(condition).type == PapyrusType::Kind::Int) {
+    std::unordered_set<int32_t> seen {};
+    for (auto cBody : caseBodies) {
+      if (seen.insert(cBody->condition.val.i).second)
+        cases.push_back(cBody);
+    }
+  } else {
+    caseless_unordered_set seen {};
+    for (auto cBody : caseBodies) {
+      auto& str = cBody->condition.val.s;
+      bool isDuplicate = false;
+      if (isPrintableAscii(str.to_string_view())) {
+        isDuplicate = !seen.insert(str.to_string()).second;
+      } else {
+        isDuplicate = std::any_of(cases.begin(), cases.end(), [&](const CaseBody* c) {
+          return c->condition.val.s.to_string_view() == str.to_string_view();
+        });
+      }
+      if (!isDuplicate)
+        cases.push_back(cBody);
+    }
+  }
+
+  pex::PexLabel* afterAll;
+  bldr >> afterAll;
+  bldr.pushBreakScope(afterAll);
+  if (exprs.resultType(condition).type == PapyrusType::Kind::Int && cases.size() >= MinDecisionTreeCases)
+    buildDecisionTreePex(file, bldr, exprs, tmpDest, cases);
+  else
+    buildLinearPex(file, bldr, exprs, tmpDest, cases);
+  bldr.popBreakScope();
+  bldr << afterAll;
+}
+
+void PapyrusSwitchStatement::buildLinearPex(pex::PexFile* file,
+                                            pex::PexFunctionBuilder& bldr,
+                                            const expressions::PapyrusExpressionStore& exprs,
+                                            pex::PexLocalVariable* tmpDest,
+                                            const std::vector<const CaseBody*>& cases) const {
+  namespace op = caprica::pex::op;
+
+  pex::PexLabel* nextCondition { nullptr };
+  for (auto cBody : cases) {
+    if (nextCondition)
+      bldr << nextCondition;
+    bldr >> nextCondition;
+    bldr << location;
+    auto cond = bldr.allocTemp(PapyrusType::Bool(location));
+    bldr << op::cmpeq { cond, tmpDest, cBody->condition.buildPex(file) };
+    bldr << op::jmpf { cond, nextCondition };
+    for (auto s : cBody->body)
+      s->buildPex(file, bldr, exprs);
+  }
+  bldr.freeLongLivedTemp(tmpDest);
+
+  if (nextCondition)
+    bldr << nextCondition;
+  for (auto s : defaultStatements)
+    s->buildPex(file, bldr, exprs);
+}
+
+// Binary searches the sorted case values with cmplt, so that a switch with n
+// cases costs about log2(n) comparisons rather than n. The case bodies follow
+// the search in source order; none of them can fall through, so their order
+// doesn't matter to the search.
+void PapyrusSwitchStatement::buildDecisionTreePex(pex::PexFile* file,
+                                                  pex::PexFunctionBuilder& bldr,
+                                                  const expressions::PapyrusExpressionStore& exprs,
+                                                  pex::PexLocalVariable* tmpDest,
+                                                  const std::vector<const CaseBody*>& cases) const {
+  namespace op = caprica::pex::op;
+
+  std::vector<pex::PexLabel*> caseLabels(cases.size());
+  std::vector<std::pair<int32_t, size_t>> sorted {};
+  sorted.reserve(cases.size());
+  for (size_t i = 0; i < cases.size(); i++) {
+    bldr >> caseLabels[i];
+    sorted.emplace_back(cases[i]->condition.val.i, i);
+  }
+  std::sort(sorted.begin(), sorted.end());
+  pex::PexLabel* defaultLabel;
+  bldr >> defaultLabel;
+
+  const auto buildRange = [&](const auto& self, size_t begin, size_t end) -> void {
+    bldr << location;
+    if (end - begin <= MaxDecisionTreeLeafCases) {
+      for (size_t i = begin; i < end; i++) {
+        auto cond = bldr.allocTemp(PapyrusType::Bool(location));
+        bldr << op::cmpeq { cond, tmpDest, pex::PexValue::Integer(sorted[i].first) };
+        bldr << op::jmpt { cond, caseLabels[sorted[i].second] };
+      }
+      bldr << op::jmp { defaultLabel };
+      return;
+    }
+
+    auto mid = begin + (end - begin) / 2;
+    pex::PexLabel* lowerHalf;
+    bldr >> lowerHalf;
+    auto cond = bldr.allocTemp(PapyrusType::Bool(location));
+    bldr << op::cmplt { cond, tmpDest, pex::PexValue::Integer(sorted[mid].first) };
+    bldr << op::jmpt { cond, lowerHalf };
+    self(self, mid, end);
+    bldr << lowerHalf;
+    self(self, begin, mid);
+  };
+  buildRange(buildRange, 0, sorted.size());
+  bldr.freeLongLivedTemp(tmpDest);
+
+  for (size_t i = 0; i < cases.size(); i++) {
+    bldr << caseLabels[i];
+    for (auto s : cases[i]->body)
+      s->buildPex(file, bldr, exprs);
+  }
+  bldr << defaultLabel;
+  for (auto s : defaultStatements)
+    s->buildPex(file, bldr, exprs);
+}
+
+}}}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <common/IntrusiveLinkedList.h>
 
 #include <papyrus/expressions/PapyrusExpression.h>
@@ -22,7 +24,7 @@ struct PapyrusSwitchStatement final : public PapyrusStatement {
     friend IntrusiveLinkedList<CaseBody>;
     CaseBody* next { nullptr };
   };
-  expressions::PapyrusExpression* condition { nullptr };
+  expressions::PapyrusExpressionId condition {};
   IntrusiveLinkedList<CaseBody> caseBodies {};
   IntrusiveLinkedList<PapyrusStatement> defaultStatements {};
 
@@ -54,55 +56,29 @@ struct PapyrusSwitchStatement final : public PapyrusStatement {
     return isTerminal;
   }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
-    namespace op = caprica::pex::op;
-
-    auto tmpDest = bldr.allocLongLivedTemp(condition->resultType());
-    bldr << location;
-    bldr << op::assign { tmpDest, condition->generateLoad(file, bldr) };
-
-    pex::PexLabel* afterAll;
-    bldr >> afterAll;
-    bldr.pushBreakScope(afterAll);
-    pex::PexLabel* nextCondition { nullptr };
-    for (auto& cBody : caseBodies) {
-      if (nextCondition)
-        bldr << nextCondition;
-      bldr >> nextCondition;
-      bldr << location;
-      auto cond = bldr.allocTemp(PapyrusType::Bool(location));
-      bldr << op::cmpeq { cond, tmpDest, cBody->condition.buildPex(file) };
-      bldr << op::jmpf { cond, nextCondition };
-      for (auto s : cBody->body)
-        s->buildPex(file, bldr);
-    }
-    bldr.freeLongLivedTemp(tmpDest);
-
-    bldr << nextCondition;
-    for (auto s : defaultStatements)
-      s->buildPex(file, bldr);
-    bldr.popBreakScope();
-    bldr << afterAll;
-  }
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override;
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
-    condition->semantic(ctx);
-    ctx->checkForPoison(condition);
-    if (condition->resultType().type != PapyrusType::Kind::Int &&
-        condition->resultType().type != PapyrusType::Kind::String) {
+    auto& exprs = *ctx->expressionStore;
+    exprs.semantic(ctx, condition);
+    ctx->checkForPoison(exprs.resultType(condition));
+    if (exprs.resultType(condition).type != PapyrusType::Kind::Int &&
+        exprs.resultType(condition).type != PapyrusType::Kind::String) {
       ctx->reportingContext.error(
-          condition->location,
+          exprs.location(condition),
           "The condition of a switch statement can only be either an Int or a String, got '{}'!",
-          condition->resultType());
+          exprs.resultType(condition));
     }
 
     ctx->pushBreakScope();
     for (auto i : caseBodies) {
-      if (i->condition.getPapyrusType() != condition->resultType()) {
+      if (i->condition.getPapyrusType() != exprs.resultType(condition)) {
         ctx->reportingContext.error(i->condition.location,
                                     "The condition of a case statement must match the type of the expression being "
                                     "switched on! Expected '{}', got '{}'!",
-                                    condition->resultType(),
+                                    exprs.resultType(condition),
                                     i->condition.getPapyrusType());
       }
       ctx->pushLocalVariableScope();
@@ -132,6 +108,24 @@ struct PapyrusSwitchStatement final : public PapyrusStatement {
     for (auto s : defaultStatements)
       s->visit(visitor);
   }
+
+private:
+  // Int switches with at least this many distinct cases are lowered to a
+  // binary search rather than a chain of comparisons.
+  static constexpr size_t MinDecisionTreeCases = 8;
+  // The ranges at the leaves of the search are compared linearly.
+  static constexpr size_t MaxDecisionTreeLeafCases = 3;
+
+  void buildLinearPex(pex::PexFile* file,
+                      pex::PexFunctionBuilder& bldr,
+                      const expressions::PapyrusExpressionStore& exprs,
+                      pex::PexLocalVariable* tmpDest,
+                      const std::vector<const CaseBody*>& cases) const;
+  void buildDecisionTreePex(pex::PexFile* file,
+                            pex::PexFunctionBuilder& bldr,
+                            const expressions::PapyrusExpressionStore& exprs,
+                            pex::PexLocalVariable* tmpDest,
+                            const std::vector<const CaseBody*>& cases) const;
 };
 
 }}}
@@ -33,21 +33,23 @@ struct PapyrusTryGuardStatement final : public PapyrusStatement {
   }
 
   // TODO: Not sure if this is at all correct
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
     namespace op = caprica::pex::op;
-    IntrusiveLinkedList<pex::IntrusivePexValue> args;
+    std::vector<pex::PexValue> args;
     for (auto guard : lockParams)
-      args.push_back(file->alloc->make<pex::IntrusivePexValue>(pex::PexValue(file->getString(guard->name))));
+      args.push_back(pex::PexValue(file->getString(guard->name)));
     pex::PexLabel* afterAll;
     bldr >> afterAll;
 
     auto tlTemp = bldr.allocTemp(PapyrusType::Bool(location));
     bldr << location;
-    bldr << op::trylockguards { tlTemp, std::move(args) };
+    bldr << op::trylockguards { tlTemp, args };
     bldr << op::jmpf(tlTemp, afterAll);
-    bldr.pushLockScope(std::move(args));
+    bldr.pushLockScope(args);
     for (auto s : body)
-      s->buildPex(file, bldr);
+      s->buildPex(file, bldr, exprs);
     bldr.popLockScope();
     bldr << location;
     bldr << op::unlockguards { std::move(args) };
@@ -12,7 +12,7 @@
 namespace caprica { namespace papyrus { namespace statements {
 
 struct PapyrusWhileStatement final : public PapyrusStatement {
-  expressions::PapyrusExpression* condition { nullptr };
+  expressions::PapyrusExpressionId condition {};
   IntrusiveLinkedList<PapyrusStatement> body {};
 
   explicit PapyrusWhileStatement(CapricaFileLocation loc) : PapyrusStatement(loc) { }
@@ -21,7 +21,9 @@ struct PapyrusWhileStatement final : public PapyrusStatement {
 
   virtual bool buildCFG(PapyrusCFG& cfg) const override { return cfg.processCommonLoopBody(body); }
 
-  virtual void buildPex(pex::PexFile* file, pex::PexFunctionBuilder& bldr) const override {
+  virtual void buildPex(pex::PexFile* file,
+                        pex::PexFunctionBuilder& bldr,
+                        const expressions::PapyrusExpressionStore& exprs) const override {
     namespace op = caprica::pex::op;
     pex::PexLabel* beforeCondition;
     bldr >> beforeCondition;
@@ -29,12 +31,10 @@ struct PapyrusWhileStatement final : public PapyrusStatement {
     pex::PexLabel* afterAll;
     bldr >> afterAll;
     bldr.pushBreakContinueScope(afterAll, beforeCondition);
-    auto lVal = condition->generateLoad(file, bldr);
-    bldr << location;
-    bldr << op::jmpf { lVal, afterAll };
+    exprs.generateBranch(file, bldr, condition, false, afterAll, location);
 
     for (auto s : body)
-      s->buildPex(file, bldr);
+      s->buildPex(file, bldr, exprs);
     bldr << location;
     bldr << op::jmp { beforeCondition };
 
@@ -43,9 +43,10 @@ struct PapyrusWhileStatement final : public PapyrusStatement {
   }
 
   virtual void semantic(PapyrusResolutionContext* ctx) override {
-    condition->semantic(ctx);
-    ctx->checkForPoison(condition);
-    condition = ctx->coerceExpression(condition, PapyrusType::Bool(condition->location));
+    auto& exprs = *ctx->expressionStore;
+    exprs.semantic(ctx, condition);
+    ctx->checkForPoison(exprs.resultType(condition));
+    condition = ctx->coerceExpression(condition, PapyrusType::Bool(exprs.location(condition)));
     ctx->pushBreakContinueScope();
     ctx->pushLocalVariableScope();
     if (conf::Papyrus::game == GameID::Skyrim)
@@ -1,23 +1,34 @@
 #pragma once
 
 #include <cstdint>
-#include <cstdio>
-#include <iostream>
-#include <memory>
-#include <sstream>
+#include <ctime>
+#include <iterator>
+#include <ostream>
 #include <string>
+#include <string_view>
+
+#include <fmt/format.h>
 
 #include <pex/PexUserFlags.h>
 
 namespace caprica { namespace pex {
 
+// Everything written is buffered, and only handed to the destination stream
+// when flushed or destroyed, so a whole file goes out in a single write.
 struct PexAsmWriter final {
   // The indent level. Yes, this spelling is deliberate.
   size_t ident { 0 };
 
   explicit PexAsmWriter(std::ostream& dest) : strm(dest) { }
   PexAsmWriter(const PexAsmWriter&) = delete;
-  ~PexAsmWriter() = default;
+  // Errors can't propagate out of here, so flush explicitly first if they
+  // matter.
+  ~PexAsmWriter() {
+    try {
+      flush();
+    } catch (...) {
+    }
+  }
 
   template <typename T>
   void writeKV(const char* key, T val) {
@@ -26,105 +37,101 @@ struct PexAsmWriter final {
 
   template <>
   void writeKV(const char* key, time_t val) {
-    ensureIndent();
     // TODO: Add a comment output of the times in the local time.
-    strm << '.' << key << ' ' << (unsigned long long)val;
-    writeln();
+    writeln(".{} {}", key, (unsigned long long)val);
   }
 
   template <>
   void writeKV(const char* key, std::string val) {
-    ensureIndent();
-    strm << '.' << key << " \"" << escapeString(val) << "\"";
-    writeln();
+    writeKV<std::string_view>(key, val);
   }
 
   template <>
   void writeKV(const char* key, std::string_view val) {
-    ensureIndent();
-    strm << '.' << key << " \"" << escapeString(std::string(val)) << "\"";
+    write(".{} ", key);
+    writeEscapedString(val);
     writeln();
   }
 
   template <>
   void writeKV(const char* key, PexUserFlags val) {
-    ensureIndent();
-    strm << '.' << key << " " << val.data;
-    writeln();
+    writeln(".{} {}", key, val.data);
   }
 
   template <typename... Args>
-  void write(std::string_view msg, Args&&... args) {
+  void write(fmt::format_string<Args...> msg, Args&&... args) {
     ensureIndent();
-    strm << formatString(msg, args...);
+    fmt::format_to(std::back_inserter(buf), msg, std::forward<Args>(args)...);
+  }
+
+  void write(std::string_view str) {
+    ensureIndent();
+    buf.append(str);
   }
 
   template <typename... Args>
-  void writeln(std::string_view msg, Args&&... args) {
+  void writeln(fmt::format_string<Args...> msg, Args&&... args) {
     ensureIndent();
-    strm << formatString(msg, args...);
+    fmt::format_to(std::back_inserter(buf), msg, std::forward<Args>(args)...);
+    writeln();
+  }
+
+  void writeln(std::string_view str) {
+    write(str);
     writeln();
   }
 
   void writeln() {
     haveIndented = false;
-    strm << std::endl;
+    buf.push_back('\n');
   }
 
-  static std::string escapeString(const std::string& str) {
-    std::ostringstream dest;
-
+  // Writes the string quoted, with anything the lexer treats specially
+  // escaped.
+  void writeEscapedString(std::string_view str) {
+    ensureIndent();
+    buf.push_back('"');
     for (auto c : str) {
       switch (c) {
         case '\n':
-          dest.put('\\');
-          dest.put('n');
+          buf.append(std::string_view("\\n"));
           break;
         case '\t':
-          dest.put('\\');
-          dest.put('t');
+          buf.append(std::string_view("\\t"));
           break;
         case '"':
-          dest.put('\\');
-          dest.put('"');
+          buf.append(std::string_view("\\\""));
           break;
         case '\\':
-          dest.put('\\');
-          dest.put('\\');
+          buf.append(std::string_view("\\\\"));
           break;
         default:
-          dest.put(c);
+          buf.push_back(c);
           break;
       }
     }
+    buf.push_back('"');
+  }
 
-    return dest.str();
+  void flush() {
+    if (buf.size() == 0)
+      return;
+    strm.write(buf.data(), buf.size());
+    buf.clear();
   }
 
 private:
   bool haveIndented { false };
   std::ostream& strm;
+  fmt::memory_buffer buf {};
 
   void ensureIndent() {
     if (!haveIndented) {
       for (size_t i = 0; i < ident; i++)
-        strm << "  ";
+        buf.append(std::string_view("  "));
       haveIndented = true;
     }
   }
-
-  template <typename... Args>
-  static std::string formatString(std::string_view msg, Args&&... args) {
-    constexpr bool hasArgs = sizeof...(args) != 0;
-    if (hasArgs) {
-      size_t size = std::snprintf(nullptr, 0, msg.data(), args...) + 1;
-      std::unique_ptr<char[]> buf(new char[size]);
-      std::snprintf(buf.get(), size, msg.data(), args...);
-      return std::string(buf.get(), buf.get() + size - 1);
-    } else {
-      return std::string(msg);
-    }
-  }
 };
 
 }}
@@ -18,6 +18,34 @@ PexFile::~PexFile() {
   stringPoolAllocator.release(stringTable);
 }
 
+static uint64_t makeDebugFunctionKey(size_t objectName,
+                                     size_t stateName,
+                                     size_t functionName,
+                                     PexDebugFunctionType functionType) {
+  return (uint64_t)objectName << 40 | (uint64_t)stateName << 24 | (uint64_t)functionName << 8 |
+         (uint64_t)functionType;
+}
+
+// A file that was read in can have the same string in its table more than
+// once, so the index is keyed on the one index the table resolves it to.
+size_t PexFile::getCanonicalStringIndex(const identifier_ref& str) const {
+  return stringTable->tryLookup(str);
+}
+
+void PexFile::indexFunctionDebugInfo() {
+  debugFunctionIndex.clear();
+  debugFunctionIndex.reserve(debugInfo->functions.size());
+  for (auto fi : debugInfo->functions) {
+    debugFunctionIndex.emplace(makeDebugFunctionKey(getCanonicalStringIndex(getStringValue(fi->objectName)),
+                                                    getCanonicalStringIndex(getStringValue(fi->stateName)),
+                                                    getCanonicalStringIndex(getStringValue(fi->functionName)),
+                                                    fi->functionType),
+                               fi);
+  }
+  indexedDebugInfo = debugInfo;
+  indexedDebugFunctionCount = debugInfo->functions.size();
+}
+
 PexDebugFunctionInfo* PexFile::tryFindFunctionDebugInfo(const PexObject* object,
                                                         const PexState* state,
                                                         const PexFunction* function,
@@ -26,16 +54,21 @@ PexDebugFunctionInfo* PexFile::tryFindFunctionDebugInfo(const PexObject* object,
   if (debugInfo) {
     assert(function);
     assert(object);
-    auto fName = propertyName == "" ? getStringValue(function->name) : propertyName;
-    auto objectName = getStringValue(object->name);
-    auto stateName = state ? getStringValue(state->name) : "";
-
-    for (auto fi : debugInfo->functions) {
-      if (getStringValue(fi->objectName) == objectName && getStringValue(fi->stateName) == stateName &&
-          getStringValue(fi->functionName) == fName && fi->functionType == functionType) {
-        return fi;
-      }
+    if (indexedDebugInfo != debugInfo || indexedDebugFunctionCount != debugInfo->functions.size())
+      indexFunctionDebugInfo();
+
+    auto fName = getCanonicalStringIndex(propertyName == "" ? getStringValue(function->name) : propertyName);
+    auto objectName = getCanonicalStringIndex(getStringValue(object->name));
+    auto stateName = getCanonicalStringIndex(state ? getStringValue(state->name) : "");
+    // A name that isn't in the string table can't have any debug info.
+    if (fName == allocators::ReffyStringPool::npos || objectName == allocators::ReffyStringPool::npos ||
+        stateName == allocators::ReffyStringPool::npos) {
+      return nullptr;
     }
+
+    auto f = debugFunctionIndex.find(makeDebugFunctionKey(objectName, stateName, fName, functionType));
+    if (f != debugFunctionIndex.end())
+      return f->second;
   }
   return nullptr;
 }
@@ -50,7 +83,7 @@ const PexDebugFunctionInfo* PexFile::tryFindFunctionDebugInfo(const PexObject* o
 
 PexString PexFile::getString(const identifier_ref& str) {
   auto ret = PexString();
-  ret.index = stringTable->lookup(str);
+  ret.index = (uint32_t)stringTable->lookup(str);
   return ret;
 }
 
@@ -76,6 +109,16 @@ size_t PexFile::getUserFlagCount() const noexcept {
   return userFlagTable.size();
 }
 
+std::vector<PexString> PexFile::mergeStringsFrom(const PexFile* other) {
+  std::vector<PexString> stringMap {};
+  stringMap.reserve(other->stringTable->size());
+  for (size_t i = 0; i < other->stringTable->size(); i++)
+    stringMap.push_back(getString(other->stringTable->byIndex(i)));
+  for (auto& f : other->userFlagTable)
+    getUserFlag(stringMap[f.first.index], f.second);
+  return stringMap;
+}
+
 PexFile* PexFile::read(allocators::ChainedPool* alloc, PexReader& rdr) {
   auto file = alloc->make<PexFile>(alloc);
   rdr.endianness = Endianness::Little; // ensure that we're reading little endian to begin with
@@ -177,7 +220,7 @@ void PexFile::writeAsm(PexAsmWriter& wtr) const {
   wtr.writeln(".userFlagsRef");
   wtr.ident++;
   for (auto a : userFlagTable)
-    wtr.writeln(".flag %s %u", getStringValue(a.first).to_string().c_str(), (unsigned)a.second);
+    wtr.writeln(".flag {} {}", getStringValue(a.first), (unsigned)a.second);
   wtr.ident--;
   wtr.writeln(".endUserFlagsRef");
 
@@ -29,7 +29,7 @@ struct PapyrusScript;
 namespace pex {
 
 constexpr uint32_t PEX_MAGIC_NUM = 0xFA57C0DE;
-constexpr uint32_t PEX_MAGIC_NUM_BE = 0xDE57C0FA;
+constexpr uint32_t PEX_MAGIC_NUM_BE = 0xDEC057FA;
 
 struct PexFile final {
   allocators::ChainedPool* alloc;
@@ -66,6 +66,11 @@ struct PexFile final {
   identifier_ref getStringValue(const PexString& str) const;
   PexUserFlags getUserFlag(PexString name, uint8_t bitNum);
   size_t getUserFlagCount() const noexcept;
+  // Adds the strings and user flags of another file, in the order it added
+  // them, and returns what each of its strings became here. Anything built
+  // in that file and then copied over ends up just as if it had been built
+  // in this one.
+  std::vector<PexString> mergeStringsFrom(const PexFile* other);
 
   void setGameAndVersion(GameID game) {
     gameID = game;
@@ -105,6 +110,15 @@ private:
 
   std::vector<std::pair<PexString, uint8_t>> userFlagTable;
   std::unordered_map<size_t, size_t> userFlagTableLookup;
+
+  // The function debug info keyed on its object, state, function and type,
+  // built on the first lookup after any were added.
+  std::unordered_map<uint64_t, PexDebugFunctionInfo*> debugFunctionIndex {};
+  const PexDebugInfo* indexedDebugInfo { nullptr };
+  size_t indexedDebugFunctionCount { 0 };
+
+  size_t getCanonicalStringIndex(const identifier_ref& str) const;
+  void indexFunctionDebugInfo();
 };
 
 }
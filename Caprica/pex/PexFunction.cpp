@@ -28,8 +28,9 @@ PexFunction* PexFunction::read(allocators::ChainedPool* alloc, PexReader& rdr, b
   for (size_t i = 0; i < lSize; i++)
     func->locals.push_back(PexLocalVariable::read(alloc, rdr));
   auto iSize = rdr.read<uint16_t>();
+  func->instructions.reserve(iSize);
   for (size_t i = 0; i < iSize; i++)
-    func->instructions.push_back(PexInstruction::read(alloc, rdr, gameType));
+    func->instructions.push_back(PexInstruction::read(func->operands, rdr, gameType));
 
   return func;
 }
@@ -54,8 +55,8 @@ void PexFunction::write(PexWriter& wtr) const {
   for (auto l : locals)
     l->write(wtr);
   wtr.boundWrite<uint16_t>(instructions.size());
-  for (auto i : instructions)
-    i->write(wtr);
+  for (auto& i : instructions)
+    i.write(wtr, operands);
 }
 
 void PexFunction::writeAsm(const PexFile* file,
@@ -70,7 +71,7 @@ void PexFunction::writeAsm(const PexFile* file,
   else if (funcType == PexDebugFunctionType::Setter)
     wtr.write("set");
   else
-    wtr.write(file->getStringValue(name).to_string().c_str());
+    wtr.write(file->getStringValue(name).to_string_view());
 
   if (isNative)
     wtr.write(" native");
@@ -81,8 +82,8 @@ void PexFunction::writeAsm(const PexFile* file,
   wtr.ident++;
 
   wtr.writeKV<PexUserFlags>("userFlags", userFlags);
-  wtr.writeKV<std::string>("docString", file->getStringValue(documentationString).to_string());
-  wtr.writeln(".return %s", file->getStringValue(returnTypeName).to_string().c_str());
+  wtr.writeKV<std::string_view>("docString", file->getStringValue(documentationString).to_string_view());
+  wtr.writeln(".return {}", file->getStringValue(returnTypeName));
 
   wtr.writeln(".paramTable");
   wtr.ident++;
@@ -106,47 +107,49 @@ void PexFunction::writeAsm(const PexFile* file,
 
     // This is the fun part.
     std::unordered_map<size_t, size_t> labelMap;
-    for (auto cur = instructions.begin(), end = instructions.end(); cur != end; ++cur) {
-      if (cur->isBranch()) {
-        auto targI = cur->branchTarget() + cur.index;
+    for (size_t i = 0; i < instructions.size(); i++) {
+      if (instructions[i].isBranch()) {
+        auto targI = instructions[i].branchTarget(operands) + i;
         if (!labelMap.count((size_t)(targI)))
           labelMap.emplace((size_t)targI, labelMap.size());
       }
     }
 
-    for (auto cur = instructions.begin(), end = instructions.end(); cur != end; ++cur) {
-      auto f = labelMap.find(cur.index);
+    for (size_t i = 0; i < instructions.size(); i++) {
+      auto& cur = instructions[i];
+      auto f = labelMap.find(i);
       if (f != labelMap.end())
-        wtr.writeln("label%llu:", f->second);
+        wtr.writeln("label{}:", f->second);
 
-      wtr.write(PexInstruction::opCodeToPexAsm(cur->opCode));
+      wtr.write(PexInstruction::opCodeToPexAsm(cur.opCode));
 
-      if (cur->opCode == PexOpCode::Jmp) {
-        wtr.write(" label%llu", labelMap[(size_t)(cur->args[0].val.i + cur.index)]);
-      } else if (cur->opCode == PexOpCode::JmpT || cur->opCode == PexOpCode::JmpF) {
+      auto args = cur.args(operands);
+      if (cur.opCode == PexOpCode::Jmp) {
+        wtr.write(" label{}", labelMap[(size_t)(args[0].val.i + i)]);
+      } else if (cur.opCode == PexOpCode::JmpT || cur.opCode == PexOpCode::JmpF) {
         wtr.write(" ");
-        cur->args[0].writeAsm(file, wtr);
-        wtr.write(" label%llu", labelMap[(size_t)(cur->args[1].val.i + cur.index)]);
+        args[0].writeAsm(file, wtr);
+        wtr.write(" label{}", labelMap[(size_t)(args[1].val.i + i)]);
       } else {
-        for (auto& a : cur->args) {
+        for (auto& a : args) {
           wtr.write(" ");
           a.writeAsm(file, wtr);
         }
-        for (auto& a : cur->variadicArgs) {
+        for (auto& a : cur.variadicArgs(operands)) {
           wtr.write(" ");
-          a->writeAsm(file, wtr);
+          a.writeAsm(file, wtr);
         }
       }
 
-      if (debInf && cur.index < debInf->instructionLineMap.size())
-        wtr.write(" ;@line %u", debInf->instructionLineMap[cur.index]);
+      if (debInf && i < debInf->instructionLineMap.size())
+        wtr.write(" ;@line {}", debInf->instructionLineMap[i]);
 
       wtr.writeln();
     }
 
     auto f = labelMap.find(instructions.size());
     if (f != labelMap.end())
-      wtr.writeln("label%llu:", f->second);
+      wtr.writeln("label{}:", f->second);
 
     wtr.ident--;
     wtr.writeln(".endCode");
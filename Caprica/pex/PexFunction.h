@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <common/IntrusiveLinkedList.h>
 
@@ -32,7 +33,9 @@ struct PexFunction final {
   bool isGlobal { false };
   IntrusiveLinkedList<PexFunctionParameter> parameters {};
   IntrusiveLinkedList<PexLocalVariable> locals {};
-  IntrusiveLinkedList<PexInstruction> instructions {};
+  std::vector<PexInstruction> instructions {};
+  // The arguments of all of the instructions, in the same order.
+  std::vector<PexValue> operands {};
 
   explicit PexFunction() = default;
   PexFunction(const PexFunction&) = delete;
@@ -47,6 +50,44 @@ struct PexFunction final {
                 std::string propName,
                 PexAsmWriter& wtr) const;
 
+  // Copies the function into alloc, passing every string it refers to
+  // through mapString, which is how a function moves between files.
+  template <typename F>
+  PexFunction* copy(allocators::ChainedPool* alloc, F&& mapString) const {
+    const auto str = [&](const PexString& s) { return s.valid() ? mapString(s) : s; };
+    const auto value = [&](const PexValue& v) {
+      auto ret = v;
+      if (v.type == PexValueType::Identifier || v.type == PexValueType::String)
+        ret.val.s = str(v.val.s);
+      return ret;
+    };
+
+    auto func = alloc->make<PexFunction>();
+    func->name = str(name);
+    func->returnTypeName = str(returnTypeName);
+    func->documentationString = str(documentationString);
+    func->userFlags = userFlags;
+    func->isNative = isNative;
+    func->isGlobal = isGlobal;
+    for (auto p : parameters) {
+      auto param = alloc->make<PexFunctionParameter>();
+      param->name = str(p->name);
+      param->type = str(p->type);
+      func->parameters.push_back(param);
+    }
+    for (auto l : locals) {
+      auto local = alloc->make<PexLocalVariable>();
+      local->name = str(l->name);
+      local->type = str(l->type);
+      func->locals.push_back(local);
+    }
+    func->instructions = instructions;
+    func->operands.reserve(operands.size());
+    for (auto& a : operands)
+      func->operands.push_back(value(a));
+    return func;
+  }
+
 private:
   friend IntrusiveLinkedList<PexFunction>;
   PexFunction* next { nullptr };
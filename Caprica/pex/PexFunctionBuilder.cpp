@@ -12,12 +12,13 @@ PexFunctionBuilder::PexFunctionBuilder(CapricaReportingContext& repCtx, CapricaF
 }
 
 void PexFunctionBuilder::populateFunction(PexFunction* func, PexDebugFunctionInfo* debInfo) {
-  for (auto cur = instructions.begin(), end = instructions.end(); cur != end; ++cur) {
-    for (auto& arg : cur->args) {
+  for (size_t i = 0; i < instructions.size(); i++) {
+    for (auto& arg : instructions[i].args(operands)) {
       if (arg.type == PexValueType::Label) {
-        if (arg.val.l->targetIdx == (size_t)-1)
+        auto lab = labels[arg.val.labelId];
+        if (lab->targetIdx == (size_t)-1)
           CapricaReportingContext::logicalFatal("Unresolved label!");
-        auto newVal = arg.val.l->targetIdx - cur.index;
+        auto newVal = lab->targetIdx - i;
         arg.type = PexValueType::Integer;
         arg.val.i = (int32_t)newVal;
       }
@@ -33,6 +34,7 @@ void PexFunctionBuilder::populateFunction(PexFunction* func, PexDebugFunctionInf
       CapricaReportingContext::logicalFatal("Unresolved tmp var!");
 
   func->instructions = std::move(instructions);
+  func->operands = std::move(operands);
   func->locals = std::move(locals);
   debInfo->instructionLineMap.reserve(func->instructions.size());
   size_t line = 0;
@@ -55,8 +57,8 @@ void PexFunctionBuilder::freeValueIfTemp(const PexValue& v) {
   PexString varName;
   if (v.type == PexValueType::Identifier)
     varName = v.val.s;
-  else if (v.type == PexValueType::TemporaryVar && v.val.tmpVar->var)
-    varName = v.val.tmpVar->var->name;
+  else if (v.type == PexValueType::TemporaryVar && tempVarRefs[v.val.tmpVarId]->var)
+    varName = tempVarRefs[v.val.tmpVarId]->var->name;
   else
     return;
 
@@ -96,41 +98,35 @@ PexLocalVariable* PexFunctionBuilder::internalAllocateTempVar(const PexString& t
   return loc;
 }
 
-PexFunctionBuilder& PexFunctionBuilder::fixup(PexInstruction* instr) {
-  for (auto& v : instr->args) {
-    if (v.type == PexValueType::Invalid) {
-      reportingContext.fatal(currentLocation,
-                             "Attempted to use an invalid value as a value! (perhaps you tried to use the return value "
-                             "of a function that doesn't return?)");
-    }
-    if (v.type == PexValueType::TemporaryVar && v.val.tmpVar->var)
-      v = PexValue::Identifier(v.val.tmpVar->var);
-    freeValueIfTemp(v);
-  }
-  for (auto it = instr->variadicArgs.beginInsertable(); it != instr->variadicArgs.endInsertable(); ++it) {
-    if ((*it)->type == PexValueType::Invalid) {
-      reportingContext.fatal(currentLocation,
-                             "Attempted to use an invalid value as a value! (perhaps you tried to use the return value "
-                             "of a function that doesn't return?)");
+PexFunctionBuilder& PexFunctionBuilder::fixup(PexInstruction instr) {
+  auto args = instr.args(operands);
+  auto variadicArgs = instr.variadicArgs(operands);
+  for (auto list : { args, variadicArgs }) {
+    for (auto& v : list) {
+      if (v.type == PexValueType::Invalid) {
+        reportingContext.fatal(currentLocation,
+                               "Attempted to use an invalid value as a value! (perhaps you tried to use the return "
+                               "value of a function that doesn't return?)");
+      }
+      if (v.type == PexValueType::TemporaryVar && tempVarRefs[v.val.tmpVarId]->var)
+        v = PexValue::Identifier(tempVarRefs[v.val.tmpVarId]->var);
+      freeValueIfTemp(v);
     }
-    if ((*it)->type == PexValueType::TemporaryVar && (*it)->val.tmpVar->var)
-      instr->variadicArgs.replace(it, PexValue(PexValue::Identifier((*it)->val.tmpVar->var)));
-    freeValueIfTemp(**it);
   }
 
-  auto destIdx = PexInstruction::getDestArgIndexForOpCode(instr->opCode);
-  if (destIdx != -1 && instr->args[destIdx].type == PexValueType::TemporaryVar) {
-    auto loc = internalAllocateTempVar(instr->args[destIdx].val.tmpVar->type);
-    instr->args[destIdx].val.tmpVar->var = loc;
-    instr->args[destIdx] = PexValue::Identifier(loc);
+  auto destIdx = PexInstruction::getDestArgIndexForOpCode(instr.opCode);
+  if (destIdx != -1 && args[destIdx].type == PexValueType::TemporaryVar) {
+    auto ref = tempVarRefs[args[destIdx].val.tmpVarId];
+    auto loc = internalAllocateTempVar(ref->type);
+    ref->var = loc;
+    args[destIdx] = PexValue::Identifier(loc);
   }
 
-  for (auto& v : instr->args)
-    if (v.type == PexValueType::TemporaryVar)
-      reportingContext.fatal(currentLocation, "Attempted to use a temporary var before it's been assigned!");
-  for (auto& v : instr->variadicArgs)
-    if (v->type == PexValueType::TemporaryVar)
-      reportingContext.fatal(currentLocation, "Attempted to use a temporary var before it's been assigned!");
+  for (auto list : { args, variadicArgs }) {
+    for (auto& v : list)
+      if (v.type == PexValueType::TemporaryVar)
+        reportingContext.fatal(currentLocation, "Attempted to use a temporary var before it's been assigned!");
+  }
 
   instructionLocations.make<CapricaFileLocation>(currentLocation);
   instructions.push_back(instr);
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <limits>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -224,42 +225,36 @@ OPCODES(OP_ARG1, OP_ARG2, OP_ARG3, OP_ARG4, OP_ARG5, OP_ARG6)
 
 struct callmethod final {
   PexValue a1, a2, a3;
-  IntrusiveLinkedList<IntrusivePexValue> variadicArgs;
-  callmethod(PexString function,
-             PexValue baseObj,
-             PexValue::Identifier dest,
-             IntrusiveLinkedList<IntrusivePexValue>&& varArgs)
+  std::vector<PexValue> variadicArgs;
+  callmethod(PexString function, PexValue baseObj, PexValue::Identifier dest, std::vector<PexValue> varArgs)
       : a1(function), a2(baseObj), a3(dest), variadicArgs(std::move(varArgs)) { }
 };
 
 struct callparent final {
   PexValue a1, a2;
-  IntrusiveLinkedList<IntrusivePexValue> variadicArgs;
-  callparent(PexString function, PexValue::Identifier dest, IntrusiveLinkedList<IntrusivePexValue>&& varArgs)
+  std::vector<PexValue> variadicArgs;
+  callparent(PexString function, PexValue::Identifier dest, std::vector<PexValue> varArgs)
       : a1(function), a2(dest), variadicArgs(std::move(varArgs)) { }
 };
 
 struct callstatic final {
   PexValue a1, a2, a3;
-  IntrusiveLinkedList<IntrusivePexValue> variadicArgs;
-  callstatic(PexString type,
-             PexString function,
-             PexValue::Identifier dest,
-             IntrusiveLinkedList<IntrusivePexValue>&& varArgs)
+  std::vector<PexValue> variadicArgs;
+  callstatic(PexString type, PexString function, PexValue::Identifier dest, std::vector<PexValue> varArgs)
       : a1(type), a2(function), a3(dest), variadicArgs(std::move(varArgs)) { }
 };
 struct lockguards final {
-  IntrusiveLinkedList<IntrusivePexValue> variadicArgs;
-  lockguards(IntrusiveLinkedList<IntrusivePexValue>&& varArgs) : variadicArgs(std::move(varArgs)) { }
+  std::vector<PexValue> variadicArgs;
+  lockguards(std::vector<PexValue> varArgs) : variadicArgs(std::move(varArgs)) { }
 };
 struct unlockguards final {
-  IntrusiveLinkedList<IntrusivePexValue> variadicArgs;
-  unlockguards(IntrusiveLinkedList<IntrusivePexValue>&& varArgs) : variadicArgs(std::move(varArgs)) { }
+  std::vector<PexValue> variadicArgs;
+  unlockguards(std::vector<PexValue> varArgs) : variadicArgs(std::move(varArgs)) { }
 };
 struct trylockguards final {
   PexValue a1;
-  IntrusiveLinkedList<IntrusivePexValue> variadicArgs;
-  trylockguards(PexValue::Identifier dest, IntrusiveLinkedList<IntrusivePexValue>&& varArgs)
+  std::vector<PexValue> variadicArgs;
+  trylockguards(PexValue::Identifier dest, std::vector<PexValue> varArgs)
       : a1(dest), variadicArgs(std::move(varArgs)) { }
 };
 
@@ -277,32 +272,36 @@ struct TempVarDescriptor final {
 }
 
 struct PexFunctionBuilder final {
-  PexFunctionBuilder& operator<<(op::nop&&) { return fixup(alloc->make<PexInstruction>(PexOpCode::Nop)); }
+  PexFunctionBuilder& operator<<(op::nop&&) {
+    return fixup(PexInstruction(operands, PexOpCode::Nop, std::span<const PexValue> {}));
+  }
 
-#define OP_ARG1(name, opcode, ...)                                          \
-  PexFunctionBuilder& operator<<(op::name&& instr) {                        \
-    return fixup(alloc->make<PexInstruction>(PexOpCode::opcode, instr.a1)); \
+#define OP_ARG1(name, opcode, ...)                                           \
+  PexFunctionBuilder& operator<<(op::name&& instr) {                         \
+    return fixup(PexInstruction(operands, PexOpCode::opcode, { instr.a1 })); \
   }
-#define OP_ARG2(name, opcode, ...)                                                    \
-  PexFunctionBuilder& operator<<(op::name&& instr) {                                  \
-    return fixup(alloc->make<PexInstruction>(PexOpCode::opcode, instr.a1, instr.a2)); \
+#define OP_ARG2(name, opcode, ...)                                                     \
+  PexFunctionBuilder& operator<<(op::name&& instr) {                                   \
+    return fixup(PexInstruction(operands, PexOpCode::opcode, { instr.a1, instr.a2 })); \
   }
-#define OP_ARG3(name, opcode, ...)                                                              \
-  PexFunctionBuilder& operator<<(op::name&& instr) {                                            \
-    return fixup(alloc->make<PexInstruction>(PexOpCode::opcode, instr.a1, instr.a2, instr.a3)); \
+#define OP_ARG3(name, opcode, ...)                                                               \
+  PexFunctionBuilder& operator<<(op::name&& instr) {                                             \
+    return fixup(PexInstruction(operands, PexOpCode::opcode, { instr.a1, instr.a2, instr.a3 })); \
   }
-#define OP_ARG4(name, opcode, ...)                                                                        \
-  PexFunctionBuilder& operator<<(op::name&& instr) {                                                      \
-    return fixup(alloc->make<PexInstruction>(PexOpCode::opcode, instr.a1, instr.a2, instr.a3, instr.a4)); \
+#define OP_ARG4(name, opcode, ...)                                                                         \
+  PexFunctionBuilder& operator<<(op::name&& instr) {                                                       \
+    return fixup(PexInstruction(operands, PexOpCode::opcode, { instr.a1, instr.a2, instr.a3, instr.a4 })); \
   }
-#define OP_ARG5(name, opcode, ...)                                                                                  \
-  PexFunctionBuilder& operator<<(op::name&& instr) {                                                                \
-    return fixup(alloc->make<PexInstruction>(PexOpCode::opcode, instr.a1, instr.a2, instr.a3, instr.a4, instr.a5)); \
+#define OP_ARG5(name, opcode, ...)                                                                          \
+  PexFunctionBuilder& operator<<(op::name&& instr) {                                                        \
+    return fixup(                                                                                           \
+        PexInstruction(operands, PexOpCode::opcode, { instr.a1, instr.a2, instr.a3, instr.a4, instr.a5 })); \
   }
-#define OP_ARG6(name, opcode, ...)                                                                                   \
-  PexFunctionBuilder& operator<<(op::name&& instr) {                                                                 \
-    return fixup(                                                                                                    \
-        alloc->make<PexInstruction>(PexOpCode::opcode, instr.a1, instr.a2, instr.a3, instr.a4, instr.a5, instr.a6)); \
+#define OP_ARG6(name, opcode, ...)                                                                \
+  PexFunctionBuilder& operator<<(op::name&& instr) {                                              \
+    return fixup(PexInstruction(operands,                                                         \
+                                PexOpCode::opcode,                                                \
+                                { instr.a1, instr.a2, instr.a3, instr.a4, instr.a5, instr.a6 })); \
   }
   OPCODES(OP_ARG1, OP_ARG2, OP_ARG3, OP_ARG4, OP_ARG5, OP_ARG6)
 #undef OP_ARG1
@@ -313,30 +312,24 @@ struct PexFunctionBuilder final {
 #undef OP_ARG6
 
   PexFunctionBuilder& operator<<(op::callmethod&& instr) {
-    return fixup(alloc->make<PexInstruction>(PexOpCode::CallMethod,
-                                             instr.a1,
-                                             instr.a2,
-                                             instr.a3,
-                                             std::move(instr.variadicArgs)));
+    return fixup(
+        PexInstruction(operands, PexOpCode::CallMethod, { instr.a1, instr.a2, instr.a3 }, instr.variadicArgs));
   }
   PexFunctionBuilder& operator<<(op::callparent&& instr) {
-    return fixup(alloc->make<PexInstruction>(PexOpCode::CallParent, instr.a1, instr.a2, std::move(instr.variadicArgs)));
+    return fixup(PexInstruction(operands, PexOpCode::CallParent, { instr.a1, instr.a2 }, instr.variadicArgs));
   }
   PexFunctionBuilder& operator<<(op::callstatic&& instr) {
-    return fixup(alloc->make<PexInstruction>(PexOpCode::CallStatic,
-                                             instr.a1,
-                                             instr.a2,
-                                             instr.a3,
-                                             std::move(instr.variadicArgs)));
+    return fixup(
+        PexInstruction(operands, PexOpCode::CallStatic, { instr.a1, instr.a2, instr.a3 }, instr.variadicArgs));
   }
   PexFunctionBuilder& operator<<(op::lockguards&& instr) {
-    return fixup(alloc->make<PexInstruction>(PexOpCode::LockGuards, std::move(instr.variadicArgs)));
+    return fixup(PexInstruction(operands, PexOpCode::LockGuards, std::span<const PexValue> {}, instr.variadicArgs));
   }
   PexFunctionBuilder& operator<<(op::unlockguards&& instr) {
-    return fixup(alloc->make<PexInstruction>(PexOpCode::UnlockGuards, std::move(instr.variadicArgs)));
+    return fixup(PexInstruction(operands, PexOpCode::UnlockGuards, std::span<const PexValue> {}, instr.variadicArgs));
   }
   PexFunctionBuilder& operator<<(op::trylockguards&& instr) {
-    return fixup(alloc->make<PexInstruction>(PexOpCode::TryLockGuards, instr.a1, std::move(instr.variadicArgs)));
+    return fixup(PexInstruction(operands, PexOpCode::TryLockGuards, { instr.a1 }, instr.variadicArgs));
   }
 
   PexFunctionBuilder& operator<<(CapricaFileLocation loc) {
@@ -372,7 +365,7 @@ struct PexFunctionBuilder final {
   }
 
   PexValue::TemporaryVariable allocTemp(const papyrus::PapyrusType& tp) {
-    auto vRef = alloc->make<PexTemporaryVariableRef>(tp.buildPex(file));
+    auto vRef = alloc->make<PexTemporaryVariableRef>((uint32_t)tempVarRefs.size(), tp.buildPex(file));
     tempVarRefs.push_back(vRef);
     return PexValue::TemporaryVariable(vRef);
   }
@@ -389,16 +382,14 @@ struct PexFunctionBuilder final {
   }
 
   PexFunctionBuilder& operator>>(PexLabel*& loc) {
-    loc = alloc->make<PexLabel>();
+    loc = alloc->make<PexLabel>((uint32_t)labels.size());
     labels.push_back(loc);
     return *this;
   }
 
   PexLabel* currentBreakTarget() { return curBreakStack.back(); }
 
-  void pushLockScope(IntrusiveLinkedList<pex::IntrusivePexValue>&& guards) {
-    curLockStack.push_back(std::move(guards));
-  }
+  void pushLockScope(std::vector<PexValue> guards) { curLockStack.push_back(std::move(guards)); }
 
   void popLockScope() { curLockStack.pop_back(); }
   void generateUnlockGuardsForCurrentLockScope() {
@@ -406,7 +397,7 @@ struct PexFunctionBuilder final {
       return;
     // iterate over the lock scope in reverse
     for (auto it = curLockStack.rbegin(); it != curLockStack.rend(); ++it) {
-      auto& guards = *it;
+      auto guards = *it;
       *this << op::unlockguards { std::move(guards) };
     }
   }
@@ -442,17 +433,19 @@ private:
   PexFile* file;
   CapricaFileLocation currentLocation;
   allocators::TypedChainedPool<CapricaFileLocation> instructionLocations { 512 };
-  IntrusiveLinkedList<PexInstruction> instructions {};
+  std::vector<PexInstruction> instructions {};
+  std::vector<PexValue> operands {};
   IntrusiveLinkedList<PexLocalVariable> locals {};
-  IntrusiveLinkedList<PexLabel> labels {};
-  IntrusiveLinkedList<PexTemporaryVariableRef> tempVarRefs {};
+  // Indexed by the ids the values refer to them by.
+  std::vector<PexLabel*> labels {};
+  std::vector<PexTemporaryVariableRef*> tempVarRefs {};
   FixedPexStringMap<detail::TempVarDescriptor>* tempVarMap;
   size_t currentTempI = 0;
   std::vector<PexLabel*> curBreakStack {};
   std::vector<PexLabel*> curContinueStack {};
-  std::vector<IntrusiveLinkedList<pex::IntrusivePexValue>> curLockStack {};
+  std::vector<std::vector<PexValue>> curLockStack {};
 
-  PexFunctionBuilder& fixup(PexInstruction* instr);
+  PexFunctionBuilder& fixup(PexInstruction instr);
   PexLocalVariable* internalAllocateTempVar(const PexString& typeName);
 };
 
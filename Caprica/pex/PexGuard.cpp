@@ -18,7 +18,7 @@ void PexGuard::write(PexWriter& wtr) const {
 }
 
 void PexGuard::writeAsm(const PexFile* file, PexAsmWriter& wtr) const {
-  wtr.writeln(".guard %s", file->getStringValue(name).to_string().c_str());
+  wtr.writeln(".guard {}", file->getStringValue(name));
 }
 
 }}
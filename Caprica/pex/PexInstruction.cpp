@@ -95,79 +95,92 @@ int32_t PexInstruction::getDestArgIndexForOpCode(PexOpCode op) {
   CapricaReportingContext::logicalFatal("Unknown PexOpCode!");
 }
 
-PexInstruction* PexInstruction::read(allocators::ChainedPool* alloc, PexReader& rdr, GameID gameType) {
-  auto inst = alloc->make<PexInstruction>();
-  inst->opCode = (PexOpCode)rdr.read<uint8_t>();
+PexInstruction::PexInstruction(std::vector<PexValue>& operands,
+                               PexOpCode op,
+                               std::span<const PexValue> arguments,
+                               std::span<const PexValue> varArguments)
+    : opCode(op),
+      argCount((uint8_t)arguments.size()),
+      firstArg((uint32_t)operands.size()),
+      variadicArgCount((uint32_t)varArguments.size()) {
+  assert(arguments.size() <= std::numeric_limits<uint8_t>::max());
+  if (operands.size() + arguments.size() + varArguments.size() > std::numeric_limits<uint32_t>::max())
+    CapricaReportingContext::logicalFatal("Exceeded the maximum number of operands possible in a function!");
+  operands.insert(operands.end(), arguments.begin(), arguments.end());
+  operands.insert(operands.end(), varArguments.begin(), varArguments.end());
+}
+
+PexInstruction PexInstruction::read(std::vector<PexValue>& operands, PexReader& rdr, GameID gameType) {
+  PexInstruction inst {};
+  inst.opCode = (PexOpCode)rdr.read<uint8_t>();
+  inst.firstArg = (uint32_t)operands.size();
 
-  if (inst->opCode >= PexOpCode::OPCODECOUNT)
-    CapricaReportingContext::logicalFatal("Unknown PexOpCode: {}", (unsigned)inst->opCode);
+  if (inst.opCode >= PexOpCode::OPCODECOUNT)
+    CapricaReportingContext::logicalFatal("Unknown PexOpCode: {}", (unsigned)inst.opCode);
   switch (gameType) {
     case GameID::Skyrim: {
-      if (inst->opCode > PexOpCode::SkyrimOpcodeMax) {
+      if (inst.opCode > PexOpCode::SkyrimOpcodeMax) {
         CapricaReportingContext::logicalFatal("Invalid opcode for Skyrim: {}",
-                                              PexInstruction::opCodeToPexAsm(inst->opCode));
+                                              PexInstruction::opCodeToPexAsm(inst.opCode));
       }
       break;
     }
     case GameID::Fallout4: {
-      if (inst->opCode > PexOpCode::Fallout4OpcodeMax) {
+      if (inst.opCode > PexOpCode::Fallout4OpcodeMax) {
         CapricaReportingContext::logicalFatal("Invalid opcode for Fallout4: {}",
-                                              PexInstruction::opCodeToPexAsm(inst->opCode));
+                                              PexInstruction::opCodeToPexAsm(inst.opCode));
       }
       break;
     }
     case GameID::Fallout76: {
-      if (inst->opCode > PexOpCode::Fallout76OpcodeMax) {
+      if (inst.opCode > PexOpCode::Fallout76OpcodeMax) {
         CapricaReportingContext::logicalFatal("Invalid opcode for Fallout76: {}",
-                                              PexInstruction::opCodeToPexAsm(inst->opCode));
+                                              PexInstruction::opCodeToPexAsm(inst.opCode));
       }
       break;
     }
     case GameID::Starfield: {
-      if (inst->opCode > PexOpCode::StarfieldOpcodeMax)
-        CapricaReportingContext::logicalFatal("Unknown PexOpCode: {}", (unsigned)inst->opCode);
+      if (inst.opCode > PexOpCode::StarfieldOpcodeMax)
+        CapricaReportingContext::logicalFatal("Unknown PexOpCode: {}", (unsigned)inst.opCode);
       break;
     }
   }
 
-  switch (inst->opCode) {
+  switch (inst.opCode) {
     case PexOpCode::LockGuards:
     case PexOpCode::UnlockGuards: {
       goto CallCommon;
     }
     case PexOpCode::TryLockGuards: {
-      inst->args.reserve(1);
-      inst->args.push_back(rdr.read<PexValue>());
+      inst.argCount = 1;
       goto CallCommon;
     }
     case PexOpCode::CallMethod:
     case PexOpCode::CallStatic: {
-      inst->args.reserve(3);
-      for (size_t i = 0; i < 3; i++)
-        inst->args.push_back(rdr.read<PexValue>());
+      inst.argCount = 3;
       goto CallCommon;
     }
     case PexOpCode::CallParent: {
-      inst->args.reserve(2);
-      for (size_t i = 0; i < 2; i++)
-        inst->args.push_back(rdr.read<PexValue>());
+      inst.argCount = 2;
       goto CallCommon;
     }
 
     CallCommon : {
+      for (size_t i = 0; i < inst.argCount; i++)
+        operands.push_back(rdr.read<PexValue>());
       auto varVal = rdr.read<PexValue>();
-      if (varVal.type != PexValueType::Integer)
+      if (varVal.type != PexValueType::Integer || varVal.val.i < 0)
         CapricaReportingContext::logicalFatal("The var arg count for call instructions should be an integer!");
-      for (size_t i = 0; i < varVal.val.i; i++)
-        inst->variadicArgs.push_back(alloc->make<IntrusivePexValue>(rdr.read<PexValue>()));
+      inst.variadicArgCount = (uint32_t)varVal.val.i;
+      for (size_t i = 0; i < inst.variadicArgCount; i++)
+        operands.push_back(rdr.read<PexValue>());
       break;
     }
 
     default: {
-      auto aCount = getArgCountForOpCode(inst->opCode);
-      inst->args.reserve(aCount);
-      for (size_t i = 0; i < aCount; i++)
-        inst->args.push_back(rdr.read<PexValue>());
+      inst.argCount = (uint8_t)getArgCountForOpCode(inst.opCode);
+      for (size_t i = 0; i < inst.argCount; i++)
+        operands.push_back(rdr.read<PexValue>());
       break;
     }
   }
@@ -175,9 +188,9 @@ PexInstruction* PexInstruction::read(allocators::ChainedPool* alloc, PexReader&
   return inst;
 }
 
-void PexInstruction::write(PexWriter& wtr) const {
+void PexInstruction::write(PexWriter& wtr, const std::vector<PexValue>& operands) const {
   wtr.write<uint8_t>((uint8_t)opCode);
-  for (auto& a : args)
+  for (auto& a : args(operands))
     wtr.write<PexValue>(a);
 
   switch (opCode) {
@@ -187,17 +200,16 @@ void PexInstruction::write(PexWriter& wtr) const {
     case PexOpCode::CallMethod:
     case PexOpCode::CallParent:
     case PexOpCode::CallStatic: {
-      assert(variadicArgs.size() <= std::numeric_limits<uint32_t>::max());
       PexValue val {};
       val.type = PexValueType::Integer;
-      val.val.i = (uint32_t)variadicArgs.size();
+      val.val.i = (int32_t)variadicArgCount;
       wtr.write<PexValue>(val);
-      for (auto v : variadicArgs)
-        wtr.write<PexValue>(*v);
+      for (auto& v : variadicArgs(operands))
+        wtr.write<PexValue>(v);
       break;
     }
     default:
-      assert(variadicArgs.size() == 0);
+      assert(variadicArgCount == 0);
       break;
   }
 }
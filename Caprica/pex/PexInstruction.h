@@ -1,9 +1,10 @@
 #pragma once
 
 #include <cstdint>
+#include <initializer_list>
+#include <span>
 #include <string>
-
-#include <boost/container/static_vector.hpp>
+#include <vector>
 
 #include <pex/PexReader.h>
 #include <pex/PexValue.h>
@@ -75,56 +76,47 @@ enum class PexOpCode : uint8_t {
   StarfieldOpcodeMax = TryLockGuards,
 };
 
-#define MAX_OPCODE_RAW_ARGS 6
-
-using PexInstructionArgs = boost::container::static_vector<caprica::pex::PexValue, MAX_OPCODE_RAW_ARGS>;
-
+// An instruction of a function. Its arguments aren't stored in it, but in
+// the operand pool of the function, with the fixed ones first and the
+// variadic ones right after them.
 struct PexInstruction final {
-  static constexpr size_t kMaxRawArgs = MAX_OPCODE_RAW_ARGS;
-
   PexOpCode opCode { PexOpCode::Nop };
-  PexInstructionArgs args {};
-  IntrusiveLinkedList<IntrusivePexValue> variadicArgs {};
+  uint8_t argCount { 0 };
+  uint32_t firstArg { 0 };
+  uint32_t variadicArgCount { 0 };
 
   explicit PexInstruction() = default;
-  explicit PexInstruction(PexOpCode op) : opCode(op) { assert(op == PexOpCode::Nop); }
-  explicit PexInstruction(PexOpCode op, PexValue arg1) : opCode(op), args({ arg1 }) { }
-  explicit PexInstruction(PexOpCode op, PexValue arg1, PexValue arg2) : opCode(op), args({ arg1, arg2 }) { }
-  explicit PexInstruction(PexOpCode op,
-                          PexValue arg1,
-                          PexValue arg2,
-                          IntrusiveLinkedList<IntrusivePexValue>&& varArguments)
-      : opCode(op), args({ arg1, arg2 }), variadicArgs(std::move(varArguments)) { }
-  explicit PexInstruction(PexOpCode op, PexValue arg1, PexValue arg2, PexValue arg3)
-      : opCode(op), args({ arg1, arg2, arg3 }) { }
-  explicit PexInstruction(
-      PexOpCode op, PexValue arg1, PexValue arg2, PexValue arg3, IntrusiveLinkedList<IntrusivePexValue>&& varArguments)
-      : opCode(op), args({ arg1, arg2, arg3 }), variadicArgs(std::move(varArguments)) { }
-  explicit PexInstruction(PexOpCode op, PexValue arg1, PexValue arg2, PexValue arg3, PexValue arg4)
-      : opCode(op), args({ arg1, arg2, arg3, arg4 }) { }
-  explicit PexInstruction(PexOpCode op, PexValue arg1, PexValue arg2, PexValue arg3, PexValue arg4, PexValue arg5)
-      : opCode(op), args({ arg1, arg2, arg3, arg4, arg5 }) { }
-  explicit PexInstruction(
-      PexOpCode op, PexValue arg1, PexValue arg2, PexValue arg3, PexValue arg4, PexValue arg5, PexValue arg6)
-      : opCode(op), args({ arg1, arg2, arg3, arg4, arg5, arg6 }) { }
-  explicit PexInstruction(PexOpCode op, PexInstructionArgs&& arguments) : opCode(op), args(std::move(arguments)) { }
-  explicit PexInstruction(PexOpCode op,
-                          PexInstructionArgs&& arguments,
-                          IntrusiveLinkedList<IntrusivePexValue>&& varArguments)
-      : opCode(op), args(std::move(arguments)), variadicArgs(std::move(varArguments)) { }
-  explicit PexInstruction(PexOpCode op, PexValue arg1, IntrusiveLinkedList<IntrusivePexValue>&& varArguments)
-      : opCode(op), args({ arg1 }), variadicArgs(std::move(varArguments)) { }
-  explicit PexInstruction(PexOpCode op, IntrusiveLinkedList<IntrusivePexValue>&& varArguments)
-      : opCode(op), args(), variadicArgs(std::move(varArguments)) { }
-
+  // Appends the arguments to the end of operands, which they must not
+  // already be part of.
+  explicit PexInstruction(std::vector<PexValue>& operands,
+                          PexOpCode op,
+                          std::span<const PexValue> arguments,
+                          std::span<const PexValue> varArguments = {});
+  explicit PexInstruction(std::vector<PexValue>& operands,
+                          PexOpCode op,
+                          std::initializer_list<PexValue> arguments,
+                          std::span<const PexValue> varArguments = {})
+      : PexInstruction(operands, op, std::span<const PexValue>(arguments.begin(), arguments.size()), varArguments) { }
   PexInstruction(const PexInstruction&) = default;
-  PexInstruction(PexInstruction&&) = default;
   PexInstruction& operator=(const PexInstruction&) = default;
-  PexInstruction& operator=(PexInstruction&&) = default;
   ~PexInstruction() = default;
 
-  bool isBranch() const noexcept {
-    return opCode == PexOpCode::Jmp || opCode == PexOpCode::JmpT || opCode == PexOpCode::JmpF;
+  std::span<PexValue> args(std::vector<PexValue>& operands) const {
+    return { operands.data() + firstArg, argCount };
+  }
+  std::span<const PexValue> args(const std::vector<PexValue>& operands) const {
+    return { operands.data() + firstArg, argCount };
+  }
+  std::span<PexValue> variadicArgs(std::vector<PexValue>& operands) const {
+    return { operands.data() + firstArg + argCount, variadicArgCount };
+  }
+  std::span<const PexValue> variadicArgs(const std::vector<PexValue>& operands) const {
+    return { operands.data() + firstArg + argCount, variadicArgCount };
+  }
+
+  bool isBranch() const noexcept { return isBranch(opCode); }
+  static bool isBranch(PexOpCode op) noexcept {
+    return op == PexOpCode::Jmp || op == PexOpCode::JmpT || op == PexOpCode::JmpF;
   }
 
   /**
@@ -132,43 +124,27 @@ struct PexInstruction final {
    * number representing the relative target in
    * number of instructions.
    */
-  int branchTarget() const {
-    if (opCode == PexOpCode::Jmp) {
-      assert(args.size() == 1);
-      assert(args[0].type == PexValueType::Integer);
-      return args[0].val.i;
-    } else if (opCode == PexOpCode::JmpT || opCode == PexOpCode::JmpF) {
-      assert(args.size() == 2);
-      assert(args[1].type == PexValueType::Integer);
-      return args[1].val.i;
-    }
-    CapricaReportingContext::logicalFatal("Attempted to get the branch target of a non-branch opcode!");
+  int branchTarget(const std::vector<PexValue>& operands) const {
+    auto& target = args(operands)[getBranchTargetArgIndex(opCode)];
+    assert(target.type == PexValueType::Integer);
+    return target.val.i;
   }
-
-  void setBranchTarget(int target) {
-    if (opCode == PexOpCode::Jmp) {
-      assert(args.size() == 1);
-      assert(args[0].type == PexValueType::Integer);
-      args[0].val.i = target;
-    } else if (opCode == PexOpCode::JmpT || opCode == PexOpCode::JmpF) {
-      assert(args.size() == 2);
-      assert(args[1].type == PexValueType::Integer);
-      args[1].val.i = target;
-    } else {
-      CapricaReportingContext::logicalFatal("Attempted to get the branch target of a non-branch opcode!");
-    }
+  static size_t getBranchTargetArgIndex(PexOpCode op) {
+    if (op == PexOpCode::Jmp)
+      return 0;
+    else if (op == PexOpCode::JmpT || op == PexOpCode::JmpF)
+      return 1;
+    CapricaReportingContext::logicalFatal("Attempted to get the branch target of a non-branch opcode!");
   }
   static int32_t getDestArgIndexForOpCode(PexOpCode op);
 
-  static PexInstruction* read(allocators::ChainedPool* alloc, PexReader& rdr, GameID gameType);
-  void write(PexWriter& wtr) const;
+  static PexInstruction read(std::vector<PexValue>& operands, PexReader& rdr, GameID gameType);
+  void write(PexWriter& wtr, const std::vector<PexValue>& operands) const;
 
   static PexOpCode tryParseOpCode(std::string_view str);
   static std::string_view opCodeToPexAsm(PexOpCode op);
-
-private:
-  friend IntrusiveLinkedList<PexInstruction>;
-  PexInstruction* next { nullptr };
 };
+// Functions keep these in one array, so keep them small.
+static_assert(sizeof(PexInstruction) == 12, "PexInstruction should be 12 bytes!");
 
 }}
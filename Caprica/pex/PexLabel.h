@@ -2,20 +2,17 @@
 
 #include <cstdint>
 
-#include <common/IntrusiveLinkedList.h>
-
 namespace caprica { namespace pex {
 
 struct PexLabel final {
+  // What a PexValue refers to the label by, an index into the labels of
+  // the function being built.
+  uint32_t id;
   size_t targetIdx { (size_t)-1 };
 
-  explicit PexLabel() = default;
+  explicit PexLabel(uint32_t labelId) : id(labelId) { }
   PexLabel(const PexLabel&) = delete;
   ~PexLabel() = default;
-
-private:
-  friend IntrusiveLinkedList<PexLabel>;
-  PexLabel* next { nullptr };
 };
 
 }}
@@ -1,77 +1,42 @@
 #include <pex/PexOptimizer.h>
 
-#include <unordered_map>
 #include <vector>
 
-namespace caprica { namespace pex {
+#include <common/allocators/CachePool.h>
 
-struct OptInstruction final {
-  size_t id { 0 };
-  size_t instructionNum { 0 };
-  PexInstruction* instr { nullptr };
-  std::vector<OptInstruction*> instructionsReferencingLabel {};
-  OptInstruction* branchTarget { nullptr };
-  uint16_t lineNumber { 0 };
-
-  explicit OptInstruction(size_t id, PexInstruction* instr) : id(id), instr(instr) { }
-  ~OptInstruction() = default;
-
-  bool isDead() const { return instr == nullptr || instr->opCode == PexOpCode::Nop; }
-
-  void killInstruction() {
-#if 0
-    instr->opCode = PexOpCode::Nop;
-    instr->args.clear();
-    instr->variadicArgs.clear();
-#else
-    delete instr;
-    instr = nullptr;
-    branchTarget = nullptr;
-    lineNumber = 0;
-#endif
-  }
+#include <pex/optimizer/PexOptFunction.h>
 
-private:
-  explicit OptInstruction() = default;
-};
+namespace caprica { namespace pex {
 
-static std::vector<OptInstruction*> buildOptInstructions(const PexDebugFunctionInfo* debInfo,
-                                                         IntrusiveLinkedList<PexInstruction>& instructions) {
-  std::unordered_map<size_t, OptInstruction*> labelMap;
-  for (auto cur = instructions.begin(), end = instructions.end(); cur != end; ++cur) {
-    if (cur->isBranch()) {
-      auto targI = cur->branchTarget() + cur.index;
-      if (!labelMap.count((size_t)(targI)))
-        labelMap.emplace((size_t)targI, new OptInstruction(0, nullptr));
-    }
-  }
+namespace {
+struct OptimizerPool final : public allocators::ChainedPool {
+  OptimizerPool() : ChainedPool(16 * 1024) { }
 
-  std::vector<OptInstruction*> optimizedInstructions {};
-  optimizedInstructions.reserve(instructions.size());
-  size_t id = 0;
-  for (auto cur = instructions.begin(), end = instructions.end(); cur != end; ++cur, id++) {
-    auto f = labelMap.find(cur.index);
-    if (f != labelMap.end()) {
-      f->second->id = id++;
-      optimizedInstructions.emplace_back(f->second);
-    }
+  void reset() { ChainedPool::reset(); }
+};
+}
 
-    auto o = new OptInstruction(id, *cur);
-    if (debInfo && cur.index < debInfo->instructionLineMap.size())
-      o->lineNumber = debInfo->instructionLineMap[cur.index];
-    if (o->instr->isBranch()) {
-      o->branchTarget = labelMap[(size_t)(o->instr->branchTarget() + cur.index)];
-      o->branchTarget->instructionsReferencingLabel.push_back(o);
-    }
-    optimizedInstructions.emplace_back(o);
-  }
+// The IR of a function only lives until it's been lowered again, so the
+// memory for it gets reused for every function compiled on this thread.
+static thread_local allocators::CachePool<OptimizerPool> optimizerPoolCache {};
+
+namespace {
+struct FunctionOptimizeJob final {
+  std::vector<PexFunction*> functions {};
+  std::vector<PexFunction*> copies {};
+  std::vector<PexDebugFunctionInfo*> debugInfos {};
+  allocators::ChainedPool* alloc { nullptr };
+  PexFile* file { nullptr };
+  CapricaFunctionJob* job { nullptr };
+};
+}
 
-  auto f = labelMap.find(instructions.size());
-  if (f != labelMap.end()) {
-    f->second->id = optimizedInstructions.size();
-    optimizedInstructions.emplace_back(f->second);
-  }
-  return optimizedInstructions;
+void PexOptimizer::optimize(PexFile* file, CapricaJobManager* jobManager) {
+  auto pool = optimizerPoolCache.acquire();
+  PexOptimizer opt { pool };
+  for (auto o : file->objects)
+    opt.optimize(file, o, jobManager);
+  optimizerPoolCache.release(pool);
 }
 
 void PexOptimizer::optimize(PexFile* file,
@@ -80,92 +45,81 @@ void PexOptimizer::optimize(PexFile* file,
                             PexFunction* function,
                             const std::string& propertyName,
                             PexDebugFunctionType functionType) {
-  PexDebugFunctionInfo* debInfo = file->tryFindFunctionDebugInfo(object, state, function, propertyName, functionType);
-  auto optimizedInstructions = buildOptInstructions(debInfo, function->instructions);
-
-  const auto isDeadBetween = [&optimizedInstructions](size_t startID, size_t endID) -> bool {
-    for (size_t i = startID + 1; i <= endID; i++) {
-      assert(i < optimizedInstructions.size());
-      if (!optimizedInstructions[i]->isDead())
-        return false;
-    }
-    return true;
-  };
-  const auto nextNonDead = [&optimizedInstructions](size_t startID) -> OptInstruction* {
-    for (size_t i = startID + 1; i < optimizedInstructions.size(); i++)
-      if (!optimizedInstructions[i]->isDead())
-        return optimizedInstructions[i];
-    return nullptr;
-  };
-
-  for (int i = (int)optimizedInstructions.size() - 1; i >= 0; i--) {
-    auto opt = optimizedInstructions[i];
-    if (opt->instr) {
-      switch (opt->instr->opCode) {
-        case PexOpCode::Assign:
-          if (opt->instr->args[0] == opt->instr->args[1])
-            opt->killInstruction();
-          break;
-        case PexOpCode::Jmp:
-          if (opt->id < opt->branchTarget->id && isDeadBetween(opt->id, opt->branchTarget->id))
-            opt->killInstruction();
-          break;
-#if 0
-        case PexOpCode::Not: {
-          if (i <= 1)
-            break;
-
-          auto n = nextNonDead(opt->id);
-          if (!n)
-            break;
-          if (n->instr->opCode != PexOpCode::JmpF && n->instr->opCode != PexOpCode::JmpT)
-            break;
-          // Ensure source of branch is dest of not.
-          if (opt->instr->args[0] != n->instr->args[0])
-            break;
-
-          if (n->instr->opCode == PexOpCode::JmpF)
-            n->instr->opCode = PexOpCode::JmpT;
-          else if (n->instr->opCode == PexOpCode::JmpT)
-            n->instr->opCode = PexOpCode::JmpF;
-          else
-            CapricaReportingContext::logicalFatal("Somehow got a weird op-code here.");
-          n->instr->args[0] = opt->instr->args[1];
-          opt->killInstruction();
-          break;
-        }
-#endif
-        default:
-          break;
+  if (function->isNative)
+    return;
+
+  optimize(file, function, file->tryFindFunctionDebugInfo(object, state, function, propertyName, functionType));
+}
+
+void PexOptimizer::optimize(PexFile* file, PexFunction* function, PexDebugFunctionInfo* debInfo) {
+  {
+    optimizer::PexOptFunction func { alloc, file, function, debInfo };
+    if (inliner)
+      inliner->run(func);
+    passManager.run(func);
+    func.lower();
+  }
+  alloc->reset();
+}
+
+// Each job optimizes copies of its functions in a file of its own, and the
+// results are copied back in order, merging the strings each job added just
+// like PapyrusState does when building in parallel, so the file ends up the
+// same as when optimizing one function after the other.
+void PexOptimizer::optimizeStatesInParallel(PexFile* file, PexObject* object, CapricaJobManager* jobManager) {
+  // Nothing may read the strings of the file while they're being added to,
+  // so the copies are all made up front.
+  std::vector<FunctionOptimizeJob> jobs {};
+  for (auto s : object->states) {
+    for (auto f : s->functions) {
+      if (f->isNative)
+        continue;
+      if (jobs.empty() || jobs.back().functions.size() == FunctionsPerJob) {
+        auto& j = jobs.emplace_back();
+        j.alloc = new allocators::ChainedPool(1024 * 16);
+        j.file = j.alloc->make<PexFile>(j.alloc);
+        j.file->setGameAndVersion(file->gameID);
       }
+      auto& j = jobs.back();
+      j.functions.push_back(f);
+      j.copies.push_back(
+          f->copy(j.alloc, [&](const PexString& str) { return j.file->getString(file->getStringValue(str)); }));
+      j.debugInfos.push_back(file->tryFindFunctionDebugInfo(object, s, f, "", PexDebugFunctionType::Normal));
     }
   }
 
-  size_t curInstrNum = 0;
-  for (auto& i : optimizedInstructions) {
-    i->instructionNum = curInstrNum;
-    if (i->instr)
-      curInstrNum++;
+  for (auto& j : jobs) {
+    j.job = CapricaFunctionJob::make([&j] {
+      auto pool = optimizerPoolCache.acquire();
+      PexOptimizer opt { pool };
+      for (size_t i = 0; i < j.copies.size(); i++)
+        opt.optimize(j.file, j.copies[i], j.debugInfos[i]);
+      optimizerPoolCache.release(pool);
+    });
+    jobManager->queueJob(j.job);
   }
 
-  IntrusiveLinkedList<PexInstruction> newInstructions {};
-  std::vector<uint16_t> newLineInfo {};
-  newLineInfo.reserve(curInstrNum);
-  for (auto& i : optimizedInstructions) {
-    if (i->instr) {
-      newLineInfo.push_back(i->lineNumber);
-      newInstructions.push_back(i->instr);
-      if (i->instr->isBranch())
-        i->instr->setBranchTarget((int)i->branchTarget->instructionNum - (int)i->instructionNum);
+  for (auto& j : jobs) {
+    try {
+      j.job->awaitResult();
+    } catch (...) {
+      // The rest still refer to the jobs, so they have to be done first.
+      for (auto& other : jobs)
+        other.job->await();
+      throw;
     }
-  }
 
-  function->instructions = std::move(newInstructions);
-  if (debInfo)
-    debInfo->instructionLineMap = std::move(newLineInfo);
-
-  for (auto& i : optimizedInstructions)
-    delete i;
+    auto stringMap = file->mergeStringsFrom(j.file);
+    const auto mapString = [&](const PexString& str) { return stringMap[str.index]; };
+    for (size_t i = 0; i < j.functions.size(); i++) {
+      auto optimized = j.copies[i]->copy(file->alloc, mapString);
+      j.functions[i]->locals = std::move(optimized->locals);
+      j.functions[i]->instructions = std::move(optimized->instructions);
+      j.functions[i]->operands = std::move(optimized->operands);
+    }
+    delete j.alloc;
+    j.alloc = nullptr;
+  }
 }
 
 }}
@@ -1,27 +1,58 @@
 #pragma once
 
+#include <optional>
+#include <string>
+
+#include <common/CapricaConfig.h>
+#include <common/CapricaJobManager.h>
+#include <common/allocators/ChainedPool.h>
+
 #include <pex/PexFile.h>
+#include <pex/optimizer/PexInliner.h>
+#include <pex/optimizer/PexOptPassManager.h>
 
 namespace caprica { namespace pex {
+
 struct PexOptimizer final {
-  static void optimize(PexFile* file) {
-    PexOptimizer opt {};
-    for (auto o : file->objects)
-      opt.optimize(file, o);
-  }
+  // When a job manager is given, the functions in the states of big objects
+  // are split up between its workers.
+  static void optimize(PexFile* file, CapricaJobManager* jobManager);
 
 private:
-  PexOptimizer() = default;
+  // How many functions each job optimizes when optimizing in parallel.
+  static constexpr size_t FunctionsPerJob = 32;
+
+  allocators::ChainedPool* alloc;
+  optimizer::PexOptPassManager passManager {};
+  std::optional<optimizer::PexInliner> inliner {};
+
+  explicit PexOptimizer(allocators::ChainedPool* a) : alloc(a) { }
   ~PexOptimizer() = default;
 
-  void optimize(PexFile* file, PexObject* object) {
+  void optimize(PexFile* file, PexObject* object, CapricaJobManager* jobManager) {
+    if (conf::CodeGeneration::enableInlining)
+      inliner.emplace(alloc, file, object);
+    size_t stateFunctionCount = 0;
     for (auto s : object->states)
-      optimize(file, object, s);
-  }
-
-  void optimize(PexFile* file, PexObject* object, PexState* state) {
-    for (auto f : state->functions)
-      optimize(file, object, state, f, "", PexDebugFunctionType::Normal);
+      stateFunctionCount += s->functions.size();
+    // What gets inlined depends on the callee having been optimized already,
+    // so only functions that can't see each other are done in parallel.
+    if (jobManager && stateFunctionCount > FunctionsPerJob && !(inliner && inliner->hasCandidates())) {
+      optimizeStatesInParallel(file, object, jobManager);
+    } else {
+      for (auto s : object->states) {
+        for (auto f : s->functions)
+          optimize(file, object, s, f, "", PexDebugFunctionType::Normal);
+      }
+    }
+    for (auto p : object->properties) {
+      auto propName = file->getStringValue(p->name).to_string();
+      if (p->readFunction)
+        optimize(file, object, nullptr, p->readFunction, propName, PexDebugFunctionType::Getter);
+      if (p->writeFunction)
+        optimize(file, object, nullptr, p->writeFunction, propName, PexDebugFunctionType::Setter);
+    }
+    inliner.reset();
   }
 
   void optimize(PexFile* file,
@@ -30,5 +61,8 @@ private:
                 PexFunction* function,
                 const std::string& propertyName,
                 PexDebugFunctionType functionType);
+  void optimize(PexFile* file, PexFunction* function, PexDebugFunctionInfo* debInfo);
+  void optimizeStatesInParallel(PexFile* file, PexObject* object, CapricaJobManager* jobManager);
 };
+
 }}
@@ -61,18 +61,16 @@ void PexProperty::write(PexWriter& wtr) const {
 
 void PexProperty::writeAsm(const PexFile* file, const PexObject* obj, PexAsmWriter& wtr) const {
   // TODO: Handle the property group info in the debug info.
-  wtr.write(".property %s %s",
-            file->getStringValue(name).to_string().c_str(),
-            file->getStringValue(typeName).to_string().c_str());
+  wtr.write(".property {} {}", file->getStringValue(name), file->getStringValue(typeName));
   if (isAuto)
     wtr.write(" auto");
   wtr.writeln();
   wtr.ident++;
 
   wtr.writeKV<PexUserFlags>("userFlags", userFlags);
-  wtr.writeKV<std::string>("docString", file->getStringValue(documentationString).to_string());
+  wtr.writeKV<std::string_view>("docString", file->getStringValue(documentationString).to_string_view());
   if (isAuto) {
-    wtr.writeln(".autoVar %s", file->getStringValue(autoVar).to_string().c_str());
+    wtr.writeln(".autoVar {}", file->getStringValue(autoVar));
   } else {
     if (isReadable) {
       readFunction
@@ -25,7 +25,7 @@ void PexState::write(PexWriter& wtr) const {
 void PexState::writeAsm(const PexFile* file, const PexObject* obj, PexAsmWriter& wtr) const {
   wtr.write(".state");
   if (file->getStringValue(name) != "")
-    wtr.write(" %s", file->getStringValue(name).to_string().c_str());
+    wtr.write(" {}", file->getStringValue(name));
   wtr.writeln();
   wtr.ident++;
 
@@ -7,7 +7,9 @@
 namespace caprica { namespace pex {
 
 struct PexString {
-  size_t index { (size_t)-1 };
+  // A pex string table never has more than 64k entries, so 32 bits keep a
+  // PexValue down to 8 bytes.
+  uint32_t index { (uint32_t)-1 };
 
   explicit PexString() = default;
   PexString(const PexString&) = default;
@@ -22,7 +24,7 @@ struct PexString {
 
   bool operator!=(const PexString& other) const noexcept { return index != other.index; }
 
-  bool valid() const noexcept { return index != -1; }
+  bool valid() const noexcept { return index != (uint32_t)-1; }
 };
 
 struct IntrusivePexString final : public PexString {
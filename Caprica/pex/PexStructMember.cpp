@@ -25,9 +25,7 @@ void PexStructMember::write(PexWriter& wtr) const {
 }
 
 void PexStructMember::writeAsm(const PexFile* file, PexAsmWriter& wtr) const {
-  wtr.write(".variable %s %s",
-            file->getStringValue(name).to_string().c_str(),
-            file->getStringValue(typeName).to_string().c_str());
+  wtr.write(".variable {} {}", file->getStringValue(name), file->getStringValue(typeName));
   if (isConst)
     wtr.write(" const");
   wtr.writeln();
@@ -36,7 +34,7 @@ void PexStructMember::writeAsm(const PexFile* file, PexAsmWriter& wtr) const {
   wtr.write(".initialValue ");
   defaultValue.writeAsm(file, wtr);
   wtr.writeln();
-  wtr.writeKV<std::string>("docString", file->getStringValue(documentationString).to_string());
+  wtr.writeKV<std::string_view>("docString", file->getStringValue(documentationString).to_string_view());
   wtr.ident--;
   wtr.writeln(".endVariable");
 }
@@ -12,16 +12,16 @@ void PexValue::writeAsm(const PexFile* file, PexAsmWriter& wtr) const {
       wtr.write("None");
       return;
     case PexValueType::Identifier:
-      wtr.write("%s", file->getStringValue(val.s).to_string().c_str());
+      wtr.write(file->getStringValue(val.s).to_string_view());
       return;
     case PexValueType::String:
-      wtr.write("\"%s\"", PexAsmWriter::escapeString(file->getStringValue(val.s).to_string()).c_str());
+      wtr.writeEscapedString(file->getStringValue(val.s).to_string_view());
       return;
     case PexValueType::Integer:
-      wtr.write("%i", (int)val.i);
+      wtr.write("{}", (int)val.i);
       return;
     case PexValueType::Float:
-      wtr.write("%f", val.f);
+      wtr.write("{:f}", val.f);
       return;
     case PexValueType::Bool:
       if (val.b)
@@ -3,8 +3,6 @@
 #include <cassert>
 #include <cstdint>
 
-#include <common/IntrusiveLinkedList.h>
-
 #include <pex/PexAsmWriter.h>
 #include <pex/PexLabel.h>
 #include <pex/PexLocalVariable.h>
@@ -28,14 +26,13 @@ enum class PexValueType : uint8_t {
 };
 
 struct PexTemporaryVariableRef {
+  // What a PexValue refers to the temp var by, an index into the temp var
+  // refs of the function being built.
+  uint32_t id;
   PexString type {};
   PexLocalVariable* var { nullptr };
 
-  explicit PexTemporaryVariableRef(const PexString& tp) : type(tp) { }
-
-private:
-  friend IntrusiveLinkedList<PexTemporaryVariableRef>;
-  PexTemporaryVariableRef* next { nullptr };
+  explicit PexTemporaryVariableRef(uint32_t refId, const PexString& tp) : id(refId), type(tp) { }
 };
 
 struct PexValue {
@@ -45,16 +42,16 @@ struct PexValue {
     int32_t i;
     float f;
     bool b;
-    PexLabel* l;
-    PexTemporaryVariableRef* tmpVar;
+    // Labels and temp vars only exist while a function is being built, so
+    // they are referred to by their id rather than a pointer.
+    uint32_t labelId;
+    uint32_t tmpVarId;
 
-    ValueData() : tmpVar(nullptr) { }
+    ValueData() : tmpVarId(0) { }
     ValueData(PexString str) : s(str) { }
     ValueData(int32_t it) : i(it) { }
     ValueData(float fl) : f(fl) { }
     ValueData(bool bl) : b(bl) { }
-    ValueData(PexLabel* label) : l(label) { }
-    ValueData(PexTemporaryVariableRef* ref) : tmpVar(ref) { }
   } val;
 
   struct TemporaryVariable {
@@ -65,20 +62,27 @@ struct PexValue {
     ~TemporaryVariable() = default;
   };
   struct Identifier {
+    static constexpr uint32_t NoTmpVar = (uint32_t)-1;
+
     PexString name;
-    PexTemporaryVariableRef* tmpVar { nullptr };
+    uint32_t tmpVarId { NoTmpVar };
 
     Identifier() = delete;
     Identifier(PexString str) : name(str) { }
     Identifier(PexLocalVariable* var) : name(var->name) { }
-    Identifier(PexTemporaryVariableRef* v) : tmpVar(v) { }
-    Identifier(const TemporaryVariable& var) : tmpVar(var.var) { }
+    Identifier(PexTemporaryVariableRef* v) : tmpVarId(v->id) { }
+    Identifier(const TemporaryVariable& var) : tmpVarId(var.var->id) { }
     Identifier(const Identifier&) = default;
     ~Identifier() = default;
 
+    bool isTmpVar() const { return tmpVarId != NoTmpVar; }
+
     static Identifier fromVar(const PexValue& var) {
-      if (var.type == PexValueType::TemporaryVar)
-        return Identifier(var.val.tmpVar);
+      if (var.type == PexValueType::TemporaryVar) {
+        auto id = Identifier(PexString());
+        id.tmpVarId = var.val.tmpVarId;
+        return id;
+      }
       assert(var.type == PexValueType::Identifier);
       return Identifier(var.val.s);
     }
@@ -108,13 +112,13 @@ struct PexValue {
   struct Invalid { };
 
   explicit PexValue() {};
-  PexValue(PexLabel* lab) : type(PexValueType::Label), val(lab) { }
+  PexValue(PexLabel* lab) : type(PexValueType::Label) { val.labelId = lab->id; }
   PexValue(PexLocalVariable* var) : type(PexValueType::Identifier), val(var->name) { }
-  PexValue(const TemporaryVariable& val) : type(PexValueType::TemporaryVar), val(val.var) { }
+  PexValue(const TemporaryVariable& tmp) : type(PexValueType::TemporaryVar) { val.tmpVarId = tmp.var->id; }
   PexValue(const Identifier& id) : type(PexValueType::Identifier), val(id.name) {
-    if (id.tmpVar != nullptr) {
+    if (id.isTmpVar()) {
       type = PexValueType::TemporaryVar;
-      val.tmpVar = id.tmpVar;
+      val.tmpVarId = id.tmpVarId;
     }
   }
   PexValue(const Integer& val) : type(PexValueType::Integer), val(val.i) { }
@@ -133,14 +137,7 @@ struct PexValue {
   bool operator==(const PexValue& other) const;
   bool operator!=(const PexValue& other) const { return !(*this == other); }
 };
-
-struct IntrusivePexValue final : public PexValue {
-  IntrusivePexValue(const PexValue& str) : PexValue(str) { }
-  IntrusivePexValue(PexValue&& str) : PexValue(str) { }
-
-private:
-  friend IntrusiveLinkedList<IntrusivePexValue>;
-  IntrusivePexValue* next { nullptr };
-};
+// Every instruction's operands live in its function's pool, so keep them small.
+static_assert(sizeof(PexValue) == 8, "PexValue should be 8 bytes!");
 
 }}
@@ -0,0 +1,262 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+#include <common/CaselessStringComparer.h>
+#include <common/identifier_ref.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+namespace {
+
+// A hand written linear search, as the optimizer leaves it:
+//   preheader:  ASSIGN i 0
+//               [ARRAYLENGTH len arr]
+//   header:     [ARRAYLENGTH len arr]
+//               COMPARELT c i len
+//               JUMPF c notFound
+//   body:       ARRAYGETELEMENT e arr i
+//               COMPAREEQ c e value
+//               JUMPF c latch          (or JUMPT c found)
+//   latch:      IADD i i 1
+//               JUMP header
+// with found being whatever the body falls through to otherwise.
+// Searches on a struct member aren't replaced, as ArrayFindStruct doesn't
+// have to treat a None element the way STRUCTGET does.
+struct SearchLoop final {
+  PexOptBasicBlock* header { nullptr };
+  PexOptBasicBlock* body { nullptr };
+  PexOptBasicBlock* latch { nullptr };
+  PexOptBasicBlock* found { nullptr };
+  PexOptBasicBlock* notFound { nullptr };
+  PexOptVariable* index { nullptr };
+  PexOptVariable* condition { nullptr };
+  PexValue array {};
+  PexValue value {};
+  uint16_t lineNumber { 0 };
+};
+
+}
+
+// Finds the last instruction in the block that writes the variable.
+static PexOptInstruction* findLastDef(PexOptFunction& func, PexOptBasicBlock* block, const PexOptVariable* var) {
+  for (auto it = block->instructions.rbegin(); it != block->instructions.rend(); ++it) {
+    auto dest = PexOptFunction::tryGetDest(*it);
+    if (dest && func.tryGetVariable(*dest) == var)
+      return *it;
+  }
+  return nullptr;
+}
+
+static bool isWrittenAfter(PexOptFunction& func, PexOptInstruction* o, const PexOptVariable* var) {
+  auto& instrs = o->block->instructions;
+  for (auto it = std::find(instrs.begin(), instrs.end(), o) + 1; it != instrs.end(); ++it) {
+    auto dest = PexOptFunction::tryGetDest(*it);
+    if (dest && func.tryGetVariable(*dest) == var)
+      return true;
+  }
+  return false;
+}
+
+// Whether the find opcodes compare values of this type the same way CmpEq
+// does. Floats aren't trusted to, and a Var could hold anything.
+static bool hasExactEquality(const identifier_ref& type) {
+  return !idEq(type, "Float") && !idEq(type, "Var") && !type.ends_with("[]");
+}
+
+static bool matchSearchLoop(PexOptFunction& func, PexOptBasicBlock* header, SearchLoop& loop) {
+  const auto opIs = [](const PexOptInstruction* o, PexOpCode op) { return o->opCode == op; };
+  const auto var = [&](const PexValue& val) { return func.tryGetVariable(val); };
+  const auto typeOf = [&](const PexOptVariable* v) { return func.file->getStringValue(v->type); };
+
+  auto& hInstrs = header->instructions;
+  if (hInstrs.size() != 2 && hInstrs.size() != 3)
+    return false;
+  PexOptInstruction* lengthInstr = hInstrs.size() == 3 ? hInstrs[0] : nullptr;
+  auto cmp = hInstrs[hInstrs.size() - 2];
+  auto exitBranch = hInstrs.back();
+  if ((lengthInstr && !opIs(lengthInstr, PexOpCode::ArrayLength)) || !opIs(cmp, PexOpCode::CmpLt) ||
+      !opIs(exitBranch, PexOpCode::JmpF)) {
+    return false;
+  }
+  auto cond = var(cmp->args[0]);
+  auto index = var(cmp->args[1]);
+  auto len = var(cmp->args[2]);
+  if (!cond || !index || !len || var(exitBranch->args[0]) != cond || !idEq(typeOf(index), "Int"))
+    return false;
+
+  auto headerPos = std::find(func.blocks.begin(), func.blocks.end(), header);
+  if (headerPos + 2 >= func.blocks.end())
+    return false;
+  auto body = *(headerPos + 1);
+  auto afterBody = *(headerPos + 2);
+  auto& bInstrs = body->instructions;
+  if (bInstrs.size() != 3)
+    return false;
+  auto get = bInstrs[0];
+  auto eq = bInstrs[1];
+  auto branch = bInstrs[2];
+  if (!opIs(get, PexOpCode::ArrayGetElement) || !opIs(eq, PexOpCode::CmpEq) ||
+      (!opIs(branch, PexOpCode::JmpF) && !opIs(branch, PexOpCode::JmpT))) {
+    return false;
+  }
+  auto array = var(get->args[1]);
+  auto element = var(get->args[0]);
+  if (!array || !element || var(get->args[2]) != index)
+    return false;
+  auto compared = element;
+  auto eqCond = var(eq->args[0]);
+  if (!eqCond || var(branch->args[0]) != eqCond)
+    return false;
+  const PexValue* value = nullptr;
+  if (var(eq->args[1]) == compared)
+    value = &eq->args[2];
+  else if (var(eq->args[2]) == compared)
+    value = &eq->args[1];
+  else
+    return false;
+
+  PexOptBasicBlock* found;
+  PexOptBasicBlock* latch;
+  if (opIs(branch, PexOpCode::JmpF)) {
+    latch = branch->branchTarget;
+    found = afterBody;
+  } else {
+    found = branch->branchTarget;
+    latch = afterBody;
+  }
+  auto& lInstrs = latch->instructions;
+  if (lInstrs.size() != 2 || !opIs(lInstrs[0], PexOpCode::IAdd) || !opIs(lInstrs[1], PexOpCode::Jmp) ||
+      lInstrs[1]->branchTarget != header || var(lInstrs[0]->args[0]) != index ||
+      var(lInstrs[0]->args[1]) != index || lInstrs[0]->args[2].type != PexValueType::Integer ||
+      lInstrs[0]->args[2].val.i != 1) {
+    return false;
+  }
+
+  func.ensureDataFlow();
+  if (header->predecessors.size() != 2 || body->predecessors.size() != 1 || latch->predecessors.size() != 1 ||
+      latch->predecessors[0] != body || found == header || found == latch) {
+    return false;
+  }
+  auto preheader = header->predecessors[0] == latch ? header->predecessors[1] : header->predecessors[0];
+  if (preheader == body || preheader == latch || preheader == header)
+    return false;
+
+  // Everything the loop writes, other than the index, is scratch that
+  // nothing after it may read.
+  std::vector<const PexOptVariable*> scratch { cond, element, eqCond };
+  if (lengthInstr)
+    scratch.push_back(len);
+  for (auto v : scratch) {
+    if (v == index || v == array || header->liveIn.contains(v->id) || found->liveIn.contains(v->id) ||
+        exitBranch->branchTarget->liveIn.contains(v->id)) {
+      return false;
+    }
+  }
+  // The index is -1 rather than the length when nothing is found.
+  if (array == index || exitBranch->branchTarget->liveIn.contains(index->id))
+    return false;
+  if (!lengthInstr && (len == index || std::find(scratch.begin(), scratch.end(), len) != scratch.end()))
+    return false;
+  if (value->type == PexValueType::Identifier) {
+    auto v = var(*value);
+    if (!v || v == index || std::find(scratch.begin(), scratch.end(), v) != scratch.end() ||
+        !func.haveSameType(v, compared)) {
+      return false;
+    }
+  } else {
+    auto type = typeOf(compared);
+    const bool typeMatches = (value->type == PexValueType::Integer && idEq(type, "Int")) ||
+                             (value->type == PexValueType::Bool && idEq(type, "Bool")) ||
+                             (value->type == PexValueType::String && idEq(type, "String"));
+    if (!typeMatches)
+      return false;
+  }
+
+  auto arrayType = typeOf(array);
+  auto elementType = typeOf(element);
+  const bool isStructArray = elementType.to_string_view().find('#') != std::string_view::npos;
+  if (!arrayType.ends_with("[]") || !idEq(arrayType.substr(0, arrayType.size() - 2), elementType) ||
+      isStructArray || !hasExactEquality(elementType)) {
+    return false;
+  }
+
+  // The search has to start from a known, non-negative index, and the
+  // length has to be that of the array being searched. The header is kept,
+  // so a None or empty array still never gets to the find.
+  auto init = findLastDef(func, preheader, index);
+  if (!init || !opIs(init, PexOpCode::Assign) || init->args[1].type != PexValueType::Integer ||
+      init->args[1].val.i < 0) {
+    return false;
+  }
+  if (!lengthInstr) {
+    auto lengthDef = findLastDef(func, preheader, len);
+    if (!lengthDef || !opIs(lengthDef, PexOpCode::ArrayLength) || var(lengthDef->args[1]) != array ||
+        isWrittenAfter(func, lengthDef, array)) {
+      return false;
+    }
+  } else if (var(lengthInstr->args[0]) != len || var(lengthInstr->args[1]) != array) {
+    return false;
+  }
+
+  loop.header = header;
+  loop.body = body;
+  loop.latch = latch;
+  loop.found = found;
+  loop.notFound = exitBranch->branchTarget;
+  loop.index = index;
+  loop.condition = cond;
+  loop.array = get->args[1];
+  loop.value = *value;
+  loop.lineNumber = cmp->lineNumber;
+  return true;
+}
+
+// Replaces hand written linear searches over an array with the find opcode
+// that does the same thing natively. The bounds check in the header stays,
+// and the body becomes:
+//   body:       ARRAYFINDELEMENT arr i value i
+//               COMPARELT c i 0
+//               JUMPT c notFound
+//   latch:      JUMP found
+bool recognizeArraySearches(PexOptFunction& func) {
+  bool changed = false;
+  for (size_t i = 0; i < func.blocks.size(); i++) {
+    SearchLoop loop {};
+    if (!matchSearchLoop(func, func.blocks[i], loop))
+      continue;
+
+    const auto emit = [&](PexOptBasicBlock* b, PexOpCode op, std::initializer_list<PexValue> args) {
+      auto o = func.createInstruction(op, args, b, loop.lineNumber);
+      b->instructions.push_back(o);
+      return o;
+    };
+    for (auto b : { loop.body, loop.latch }) {
+      for (auto o : b->instructions)
+        o->kill();
+    }
+
+    auto indexVal = PexValue(PexValue::Identifier(loop.index->name));
+    auto condVal = PexValue(PexValue::Identifier(loop.condition->name));
+    emit(loop.body, PexOpCode::ArrayFindElement, { loop.array, indexVal, loop.value, indexVal });
+    emit(loop.body, PexOpCode::CmpLt, { condVal, indexVal, PexValue(PexValue::Integer(0)) });
+    auto notFound = emit(loop.body, PexOpCode::JmpT, { condVal, PexValue(PexValue::Integer(0)) });
+    notFound->branchTarget = loop.notFound;
+    // The latch is only reached from the body, and if the body used to fall
+    // through to the found block, it still does and the latch is dead.
+    auto found = emit(loop.latch, PexOpCode::Jmp, { PexValue(PexValue::Integer(0)) });
+    found->branchTarget = loop.found;
+
+    // The matcher only looks at live instructions, and at the CFG and
+    // liveness of the function as it is now.
+    func.removeDeadInstructions();
+    func.invalidate();
+    changed = true;
+  }
+  return changed;
+}
+
+}}}
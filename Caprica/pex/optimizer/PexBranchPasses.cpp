@@ -0,0 +1,215 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <pex/optimizer/PexConstantFolder.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+static bool isConditionalBranch(PexOpCode op) {
+  return op == PexOpCode::JmpT || op == PexOpCode::JmpF;
+}
+
+static bool isSameValue(const PexOptFunction& func, const PexValue& a, const PexValue& b) {
+  if (a == b)
+    return true;
+  auto v = func.tryGetVariable(a);
+  return v && v == func.tryGetVariable(b);
+}
+
+static PexOptInstruction* firstLiveInstruction(const PexOptBasicBlock* block) {
+  for (auto o : block->instructions) {
+    if (!o->isDead())
+      return o;
+  }
+  return nullptr;
+}
+
+// Turns branches on constants into either an unconditional jump or nothing
+// at all.
+bool simplifyConstantBranches(PexOptFunction& func) {
+  bool changed = false;
+  for (auto b : func.blocks) {
+    auto term = b->terminator();
+    if (!term || !isConditionalBranch(term->opCode))
+      continue;
+
+    auto& cond = term->args[0];
+    bool isTrue;
+    if (cond.type == PexValueType::None) {
+      isTrue = false;
+    } else {
+      PexValue asBool;
+      if (!tryFoldCast(func.file, cond, "Bool", asBool))
+        continue;
+      isTrue = asBool.val.b;
+    }
+
+    if (isTrue == (term->opCode == PexOpCode::JmpT)) {
+      term->opCode = PexOpCode::Jmp;
+      term->args = term->args.subspan(1);
+    } else {
+      term->kill();
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+// NOT t x
+// JMPF t label
+// becomes
+// NOT t x
+// JMPT x label
+// leaving the NOT for dead store elimination if nothing else reads t. None
+// of this changes what's live across blocks, so the liveness stays valid.
+bool fuseNegatedBranches(PexOptFunction& func) {
+  bool changed = false;
+  for (auto b : func.blocks) {
+    auto term = b->terminator();
+    if (!term || !isConditionalBranch(term->opCode))
+      continue;
+
+    PexOptInstruction* prev = nullptr;
+    for (size_t i = b->instructions.size() - 1; i-- > 0;) {
+      if (!b->instructions[i]->isDead()) {
+        prev = b->instructions[i];
+        break;
+      }
+    }
+    if (!prev || prev->opCode != PexOpCode::Not)
+      continue;
+    auto& dest = prev->args[0];
+    auto& src = prev->args[1];
+    if (!isSameValue(func, dest, term->args[0]))
+      continue;
+
+    if (isSameValue(func, dest, src)) {
+      // With NOT t t, the original value of t is gone by the time we
+      // branch, so the NOT itself has to go, which is only possible if
+      // nothing reads t afterwards.
+      func.ensureDataFlow();
+      auto v = func.tryGetVariable(dest);
+      if (!v || b->liveOut.contains(v->id))
+        continue;
+      prev->kill();
+    } else {
+      term->args[0] = src;
+    }
+    term->opCode = term->opCode == PexOpCode::JmpT ? PexOpCode::JmpF : PexOpCode::JmpT;
+    changed = true;
+  }
+  return changed;
+}
+
+// Retargets branches that land on another jump, or on an empty block, to
+// wherever control ends up going. A conditional branch can also be threaded
+// through a branch on the same condition, as its outcome is already known.
+bool threadJumps(PexOptFunction& func) {
+  std::unordered_map<const PexOptBasicBlock*, size_t> layoutIndex {};
+  for (size_t i = 0; i < func.blocks.size(); i++)
+    layoutIndex.emplace(func.blocks[i], i);
+  const auto nextInLayout = [&](const PexOptBasicBlock* block) -> PexOptBasicBlock* {
+    if (block == func.exitBlock())
+      return nullptr;
+    return func.blocks[layoutIndex[block] + 1];
+  };
+
+  bool changed = false;
+  for (auto b : func.blocks) {
+    auto term = b->terminator();
+    if (!term || !term->branchTarget)
+      continue;
+
+    auto target = term->branchTarget;
+    // Bounded, so that a loop made only of jumps can't hang us.
+    for (size_t hops = 0; hops < func.blocks.size(); hops++) {
+      auto first = firstLiveInstruction(target);
+      PexOptBasicBlock* next = nullptr;
+      if (!first) {
+        next = nextInLayout(target);
+      } else if (first->opCode == PexOpCode::Jmp) {
+        next = first->branchTarget;
+      } else if (isConditionalBranch(term->opCode) && isConditionalBranch(first->opCode) &&
+                 isSameValue(func, term->args[0], first->args[0])) {
+        next = first->opCode == term->opCode ? first->branchTarget : nextInLayout(target);
+      }
+      if (!next || next == target)
+        break;
+      target = next;
+    }
+
+    if (target != term->branchTarget) {
+      term->branchTarget = target;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool removeUnreachableBlocks(PexOptFunction& func) {
+  func.ensureCFG();
+  std::unordered_set<const PexOptBasicBlock*> reachable {};
+  std::vector<PexOptBasicBlock*> stack { func.entryBlock() };
+  reachable.insert(func.entryBlock());
+  while (!stack.empty()) {
+    auto b = stack.back();
+    stack.pop_back();
+    for (auto s : b->successors) {
+      if (reachable.insert(s).second)
+        stack.push_back(s);
+    }
+  }
+
+  // The exit block has to stay even when nothing reaches it.
+  const auto exit = func.exitBlock();
+  std::vector<PexOptBasicBlock*> kept {};
+  kept.reserve(func.blocks.size());
+  for (auto b : func.blocks) {
+    if (b == exit || reachable.count(b)) {
+      kept.push_back(b);
+    } else {
+      for (auto o : b->instructions)
+        o->kill();
+    }
+  }
+  if (kept.size() == func.blocks.size())
+    return false;
+  func.blocks = std::move(kept);
+  return true;
+}
+
+// Folds a block into the one before it when that's the only way to reach it,
+// so that the block-local passes can see across the boundary.
+bool mergeBlocks(PexOptFunction& func) {
+  bool changed = false;
+  for (size_t i = 0; i + 2 < func.blocks.size();) {
+    func.ensureCFG();
+    auto a = func.blocks[i];
+    auto b = func.blocks[i + 1];
+    auto term = a->terminator();
+    if (!a->fallsThrough() || b->predecessors.size() != 1 || (term && term->branchTarget != b)) {
+      i++;
+      continue;
+    }
+
+    // Whichever way a conditional branch here goes, it ends up in b.
+    if (term)
+      term->kill();
+    for (auto o : b->instructions) {
+      if (o->isDead())
+        continue;
+      o->block = a;
+      a->instructions.push_back(o);
+    }
+    b->instructions.clear();
+    func.blocks.erase(func.blocks.begin() + i + 1);
+    func.invalidate();
+    changed = true;
+  }
+  return changed;
+}
+
+}}}
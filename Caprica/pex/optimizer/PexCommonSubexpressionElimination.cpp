@@ -0,0 +1,195 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <common/CaselessStringComparer.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+namespace {
+
+struct AvailableExpression final {
+  PexOptInstruction* instr { nullptr };
+  // The variable still holding the result.
+  PexOptVariable* holder { nullptr };
+  // Whether the result depends on something other than our own variables,
+  // like an array element or an object variable, that a call could change.
+  bool readsMemory { false };
+};
+
+}
+
+// Only the first few expressions in a block are remembered, to keep the
+// lookups cheap in huge blocks.
+static constexpr size_t MaxAvailableExpressions = 64;
+
+static bool isCandidate(PexOpCode op) {
+  switch (op) {
+    case PexOpCode::IAdd:
+    case PexOpCode::FAdd:
+    case PexOpCode::ISub:
+    case PexOpCode::FSub:
+    case PexOpCode::IMul:
+    case PexOpCode::FMul:
+    case PexOpCode::IDiv:
+    case PexOpCode::FDiv:
+    case PexOpCode::IMod:
+    case PexOpCode::INeg:
+    case PexOpCode::FNeg:
+    case PexOpCode::Not:
+    case PexOpCode::CmpEq:
+    case PexOpCode::CmpLt:
+    case PexOpCode::CmpLte:
+    case PexOpCode::CmpGt:
+    case PexOpCode::CmpGte:
+    case PexOpCode::StrCat:
+    case PexOpCode::Cast:
+    case PexOpCode::Is:
+    case PexOpCode::ArrayLength:
+    case PexOpCode::ArrayGetElement:
+    case PexOpCode::StructGet:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool isCommutative(PexOpCode op) {
+  return op == PexOpCode::IAdd || op == PexOpCode::FAdd || op == PexOpCode::IMul || op == PexOpCode::FMul ||
+         op == PexOpCode::CmpEq;
+}
+
+// Whether the instruction can't change an array, a struct or an object
+// variable other than its own destination.
+static bool preservesMemory(PexOpCode op) {
+  switch (op) {
+    case PexOpCode::ArrayLength:
+    case PexOpCode::ArrayGetElement:
+    case PexOpCode::ArrayFindElement:
+    case PexOpCode::ArrayRFindElement:
+    case PexOpCode::ArrayFindStruct:
+    case PexOpCode::ArrayRFindStruct:
+    case PexOpCode::StructGet:
+    case PexOpCode::Jmp:
+    case PexOpCode::JmpT:
+    case PexOpCode::JmpF:
+    case PexOpCode::Return:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Replaces an instruction computing the same thing as one earlier in the
+// block, whose result is still in a variable, with a copy of that variable.
+// Copy propagation and dead store elimination take care of the rest.
+bool eliminateCommonSubexpressions(PexOptFunction& func) {
+  bool changed = false;
+  std::vector<AvailableExpression> available {};
+
+  const auto sameOperand = [&](const PexValue& a, const PexValue& b) {
+    auto va = func.tryGetVariable(a);
+    auto vb = func.tryGetVariable(b);
+    if (va || vb)
+      return va == vb;
+    return a == b;
+  };
+  const auto isOwnValue = [&](const PexValue& val) {
+    return val.type != PexValueType::Identifier || func.tryGetVariable(val) ||
+           idEq(func.file->getStringValue(val.val.s), "self");
+  };
+
+  for (auto b : func.blocks) {
+    available.clear();
+    for (auto o : b->instructions) {
+      if (o->isDead())
+        continue;
+      auto destIdx = PexInstruction::getDestArgIndexForOpCode(o->opCode);
+      auto destVal = PexOptFunction::tryGetDest(o);
+      auto dest = destVal ? func.tryGetVariable(*destVal) : nullptr;
+
+      const auto sameOperands = [&](const PexOptInstruction* other, bool swapped) {
+        for (size_t i = 0; i < o->args.size(); i++) {
+          if ((int32_t)i == destIdx)
+            continue;
+          auto j = i;
+          if (swapped)
+            j = i == 1 ? 2 : i == 2 ? 1 : i;
+          if (!sameOperand(o->args[i], other->args[j]))
+            return false;
+        }
+        return true;
+      };
+
+      if (dest && isCandidate(o->opCode)) {
+        auto match = std::find_if(available.begin(), available.end(), [&](const AvailableExpression& e) {
+          return e.instr->opCode == o->opCode && e.instr->args.size() == o->args.size() &&
+                 func.haveSameType(e.holder, dest) &&
+                 (sameOperands(e.instr, false) || (isCommutative(o->opCode) && sameOperands(e.instr, true)));
+        });
+        if (match != available.end()) {
+          if (match->holder == dest) {
+            o->kill();
+          } else {
+            func.replaceInstruction(o,
+                                    PexOpCode::Assign,
+                                    { *destVal, PexValue(PexValue::Identifier(match->holder->name)) });
+          }
+          changed = true;
+          if (o->isDead())
+            continue;
+        }
+      }
+
+      // Anything that might write memory, which includes every call, forgets
+      // all that was read from it.
+      if (!preservesMemory(o->opCode) && !PexOptFunction::isPure(o)) {
+        available.erase(std::remove_if(available.begin(),
+                                       available.end(),
+                                       [](const AvailableExpression& e) { return e.readsMemory; }),
+                        available.end());
+      }
+      if (!destVal)
+        continue;
+      if (!dest) {
+        // Writing an object variable.
+        available.erase(std::remove_if(available.begin(),
+                                       available.end(),
+                                       [](const AvailableExpression& e) { return e.readsMemory; }),
+                        available.end());
+        continue;
+      }
+      available.erase(std::remove_if(available.begin(),
+                                     available.end(),
+                                     [&](const AvailableExpression& e) {
+                                       if (e.holder == dest)
+                                         return true;
+                                       bool usesDest = false;
+                                       PexOptFunction::forEachUse(e.instr, [&](PexValue& val) {
+                                         usesDest |= func.tryGetVariable(val) == dest;
+                                       });
+                                       return usesDest;
+                                     }),
+                      available.end());
+
+      if (!isCandidate(o->opCode) || available.size() == MaxAvailableExpressions)
+        continue;
+      AvailableExpression e {};
+      e.instr = o;
+      e.holder = dest;
+      e.readsMemory = o->opCode == PexOpCode::ArrayLength || o->opCode == PexOpCode::ArrayGetElement ||
+                      o->opCode == PexOpCode::StructGet;
+      bool usesDest = false;
+      PexOptFunction::forEachUse(o, [&](PexValue& val) {
+        usesDest |= func.tryGetVariable(val) == dest;
+        e.readsMemory |= !isOwnValue(val);
+      });
+      if (!usesDest)
+        available.push_back(e);
+    }
+  }
+  return changed;
+}
+
+}}}
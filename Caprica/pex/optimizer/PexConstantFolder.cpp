@@ -0,0 +1,257 @@
+#include <pex/optimizer/PexConstantFolder.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include <common/CaselessStringComparer.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+static PexValue makeInt(int32_t i) {
+  return PexValue(PexValue::Integer(i));
+}
+
+static PexValue makeBool(bool b) {
+  return PexValue(PexValue::Bool(b));
+}
+
+static bool tryMakeFloat(float f, PexValue& result) {
+  if (!std::isfinite(f))
+    return false;
+  result = PexValue(PexValue::Float(f));
+  return true;
+}
+
+bool isConstantValue(const PexValue& val) {
+  switch (val.type) {
+    case PexValueType::String:
+    case PexValueType::Integer:
+    case PexValueType::Float:
+    case PexValueType::Bool:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool tryFoldUnaryOp(PexFile*, PexOpCode op, const PexValue& arg, PexValue& result) {
+  switch (op) {
+    case PexOpCode::Not:
+      if (arg.type == PexValueType::Bool) {
+        result = makeBool(!arg.val.b);
+        return true;
+      }
+      if (arg.type == PexValueType::Integer) {
+        result = makeBool(arg.val.i == 0);
+        return true;
+      }
+      return false;
+    case PexOpCode::INeg:
+      if (arg.type != PexValueType::Integer)
+        return false;
+      // Negating INT_MIN wraps around in the VM.
+      result = makeInt((int32_t)(0u - (uint32_t)arg.val.i));
+      return true;
+    case PexOpCode::FNeg:
+      if (arg.type != PexValueType::Float)
+        return false;
+      return tryMakeFloat(-arg.val.f, result);
+    default:
+      return false;
+  }
+}
+
+bool tryFoldBinaryOp(PexFile* file, PexOpCode op, const PexValue& arg1, const PexValue& arg2, PexValue& result) {
+  if (!isConstantValue(arg1) || arg1.type != arg2.type)
+    return false;
+
+  if (arg1.type == PexValueType::Integer) {
+    // Do the math unsigned, so that overflow wraps the same way it does in
+    // the VM rather than being undefined.
+    auto a = arg1.val.i;
+    auto b = arg2.val.i;
+    switch (op) {
+      case PexOpCode::IAdd:
+        result = makeInt((int32_t)((uint32_t)a + (uint32_t)b));
+        return true;
+      case PexOpCode::ISub:
+        result = makeInt((int32_t)((uint32_t)a - (uint32_t)b));
+        return true;
+      case PexOpCode::IMul:
+        result = makeInt((int32_t)((uint32_t)a * (uint32_t)b));
+        return true;
+      case PexOpCode::IDiv:
+      case PexOpCode::IMod:
+        if (b == 0 || (a == std::numeric_limits<int32_t>::min() && b == -1))
+          return false;
+        result = makeInt(op == PexOpCode::IDiv ? a / b : a % b);
+        return true;
+      case PexOpCode::CmpEq:
+        result = makeBool(a == b);
+        return true;
+      case PexOpCode::CmpLt:
+        result = makeBool(a < b);
+        return true;
+      case PexOpCode::CmpLte:
+        result = makeBool(a <= b);
+        return true;
+      case PexOpCode::CmpGt:
+        result = makeBool(a > b);
+        return true;
+      case PexOpCode::CmpGte:
+        result = makeBool(a >= b);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  if (arg1.type == PexValueType::Float) {
+    auto a = arg1.val.f;
+    auto b = arg2.val.f;
+    switch (op) {
+      case PexOpCode::FAdd:
+        return tryMakeFloat(a + b, result);
+      case PexOpCode::FSub:
+        return tryMakeFloat(a - b, result);
+      case PexOpCode::FMul:
+        return tryMakeFloat(a * b, result);
+      case PexOpCode::FDiv:
+        if (b == 0.0f)
+          return false;
+        return tryMakeFloat(a / b, result);
+      case PexOpCode::CmpEq:
+        result = makeBool(a == b);
+        return true;
+      case PexOpCode::CmpLt:
+        result = makeBool(a < b);
+        return true;
+      case PexOpCode::CmpLte:
+        result = makeBool(a <= b);
+        return true;
+      case PexOpCode::CmpGt:
+        result = makeBool(a > b);
+        return true;
+      case PexOpCode::CmpGte:
+        result = makeBool(a >= b);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  if (arg1.type == PexValueType::Bool) {
+    if (op != PexOpCode::CmpEq)
+      return false;
+    result = makeBool(arg1.val.b == arg2.val.b);
+    return true;
+  }
+
+  if (arg1.type == PexValueType::String) {
+    auto a = file->getStringValue(arg1.val.s);
+    auto b = file->getStringValue(arg2.val.s);
+    switch (op) {
+      case PexOpCode::StrCat: {
+        if (a.size() + b.size() > std::numeric_limits<uint16_t>::max())
+          return false;
+        std::string str;
+        str.reserve(a.size() + b.size());
+        str.append(a.data(), a.size());
+        str.append(b.data(), b.size());
+        result.type = PexValueType::String;
+        result.val.s = file->getString(str);
+        return true;
+      }
+      case PexOpCode::CmpEq:
+        // The VM compares strings without regard to case, but what that
+        // means outside of printable ASCII is up to it.
+        if (!isPrintableAscii(a.to_string_view()) || !isPrintableAscii(b.to_string_view()))
+          return false;
+        result = makeBool(caselessEq(a.to_string_view(), b.to_string_view()));
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  return false;
+}
+
+bool tryFoldCast(PexFile* file, const PexValue& src, const identifier_ref& targetType, PexValue& result) {
+  if (!isConstantValue(src))
+    return false;
+
+  if (idEq(targetType, "Int")) {
+    switch (src.type) {
+      case PexValueType::Integer:
+        result = src;
+        return true;
+      case PexValueType::Bool:
+        result = makeInt(src.val.b ? 1 : 0);
+        return true;
+      case PexValueType::Float:
+        // Truncates, but anything out of range is up to the VM.
+        if (!std::isfinite(src.val.f) || src.val.f >= 2147483648.0f || src.val.f < -2147483648.0f)
+          return false;
+        result = makeInt((int32_t)src.val.f);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  if (idEq(targetType, "Float")) {
+    switch (src.type) {
+      case PexValueType::Float:
+        result = src;
+        return true;
+      case PexValueType::Integer:
+        return tryMakeFloat((float)src.val.i, result);
+      case PexValueType::Bool:
+        return tryMakeFloat(src.val.b ? 1.0f : 0.0f, result);
+      default:
+        return false;
+    }
+  }
+
+  if (idEq(targetType, "Bool")) {
+    switch (src.type) {
+      case PexValueType::Bool:
+        result = src;
+        return true;
+      case PexValueType::Integer:
+        result = makeBool(src.val.i != 0);
+        return true;
+      case PexValueType::Float:
+        result = makeBool(src.val.f != 0.0f);
+        return true;
+      case PexValueType::String:
+        result = makeBool(!file->getStringValue(src.val.s).empty());
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  if (idEq(targetType, "String")) {
+    // Only integers have a formatting we can reproduce exactly; floats and
+    // bools are left for the VM to format.
+    switch (src.type) {
+      case PexValueType::String:
+        result = src;
+        return true;
+      case PexValueType::Integer:
+        result.type = PexValueType::String;
+        result.val.s = file->getString(std::to_string(src.val.i));
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  return false;
+}
+
+}}}
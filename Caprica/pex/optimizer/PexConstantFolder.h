@@ -0,0 +1,20 @@
+#pragma once
+
+#include <common/identifier_ref.h>
+
+#include <pex/PexFile.h>
+#include <pex/PexInstruction.h>
+#include <pex/PexValue.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+// These compute exactly what the VM would for constant operands. They return
+// false whenever that can't be known at compile time, eg. for a division by
+// zero, or a string conversion whose formatting belongs to the VM.
+
+bool isConstantValue(const PexValue& val);
+bool tryFoldUnaryOp(PexFile* file, PexOpCode op, const PexValue& arg, PexValue& result);
+bool tryFoldBinaryOp(PexFile* file, PexOpCode op, const PexValue& arg1, const PexValue& arg2, PexValue& result);
+bool tryFoldCast(PexFile* file, const PexValue& src, const identifier_ref& targetType, PexValue& result);
+
+}}}
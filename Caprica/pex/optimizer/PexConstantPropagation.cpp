@@ -0,0 +1,104 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <pex/optimizer/PexConstantFolder.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+static bool isCall(PexOpCode op) {
+  return op == PexOpCode::CallMethod || op == PexOpCode::CallParent || op == PexOpCode::CallStatic;
+}
+
+static bool tryFold(PexOptFunction& func, const PexOptInstruction* instr, PexValue& result) {
+  switch (instr->opCode) {
+    case PexOpCode::Not:
+    case PexOpCode::INeg:
+    case PexOpCode::FNeg:
+      return tryFoldUnaryOp(func.file, instr->opCode, instr->args[1], result);
+
+    case PexOpCode::IAdd:
+    case PexOpCode::FAdd:
+    case PexOpCode::ISub:
+    case PexOpCode::FSub:
+    case PexOpCode::IMul:
+    case PexOpCode::FMul:
+    case PexOpCode::IDiv:
+    case PexOpCode::FDiv:
+    case PexOpCode::IMod:
+    case PexOpCode::CmpEq:
+    case PexOpCode::CmpLt:
+    case PexOpCode::CmpLte:
+    case PexOpCode::CmpGt:
+    case PexOpCode::CmpGte:
+    case PexOpCode::StrCat:
+      return tryFoldBinaryOp(func.file, instr->opCode, instr->args[1], instr->args[2], result);
+
+    case PexOpCode::Cast: {
+      // The destination's type is what we are casting to, so it has to be
+      // one of ours.
+      auto dest = func.tryGetVariable(instr->args[0]);
+      if (!dest)
+        return false;
+      return tryFoldCast(func.file, instr->args[1], func.file->getStringValue(dest->type), result);
+    }
+
+    default:
+      return false;
+  }
+}
+
+// Within each block, replaces reads of variables that are known to hold a
+// constant with that constant, and turns operations on constants into plain
+// assignments of the result.
+bool propagateConstants(PexOptFunction& func) {
+  bool changed = false;
+  std::vector<bool> isKnown(func.variables.size());
+  std::vector<PexValue> knownValues(func.variables.size());
+
+  const auto trySubstitute = [&](PexValue& val) {
+    auto v = func.tryGetVariable(val);
+    if (v && isKnown[v->id]) {
+      val = knownValues[v->id];
+      changed = true;
+    }
+  };
+
+  for (auto b : func.blocks) {
+    std::fill(isKnown.begin(), isKnown.end(), false);
+    for (auto o : b->instructions) {
+      if (o->isDead())
+        continue;
+
+      for (size_t i = 0; i < o->args.size(); i++) {
+        if (o->args[i].type == PexValueType::Identifier &&
+            PexOptFunction::getArgKind(o->opCode, i) == PexOptArgKind::Use &&
+            PexOptFunction::acceptsConstant(o->opCode, i)) {
+          trySubstitute(o->args[i]);
+        }
+      }
+      if (isCall(o->opCode)) {
+        for (auto& v : o->variadicArgs)
+          trySubstitute(v);
+      }
+
+      PexValue folded;
+      if (tryFold(func, o, folded)) {
+        func.replaceInstruction(o, PexOpCode::Assign, { o->args[0], folded });
+        changed = true;
+      }
+
+      if (auto dest = PexOptFunction::tryGetDest(o)) {
+        if (auto v = func.tryGetVariable(*dest)) {
+          isKnown[v->id] = o->opCode == PexOpCode::Assign && isConstantValue(o->args[1]);
+          if (isKnown[v->id])
+            knownValues[v->id] = o->args[1];
+        }
+      }
+    }
+  }
+  return changed;
+}
+
+}}}
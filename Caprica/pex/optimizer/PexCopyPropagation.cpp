@@ -0,0 +1,86 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+#include <vector>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+// Within each block, replaces reads of a variable that was just assigned from
+// another one of ours with reads of the original. Object variables and the
+// like are left alone, as a call can change them behind our back.
+bool propagateCopies(PexOptFunction& func) {
+  bool changed = false;
+  std::vector<PexOptVariable*> copyOf(func.variables.size());
+
+  for (auto b : func.blocks) {
+    std::fill(copyOf.begin(), copyOf.end(), nullptr);
+    for (auto o : b->instructions) {
+      if (o->isDead())
+        continue;
+
+      PexOptFunction::forEachUse(o, [&](PexValue& val) {
+        auto v = func.tryGetVariable(val);
+        if (v && copyOf[v->id]) {
+          val = PexValue(PexValue::Identifier(copyOf[v->id]->name));
+          changed = true;
+        }
+      });
+
+      auto destVal = PexOptFunction::tryGetDest(o);
+      if (!destVal)
+        continue;
+      auto dest = func.tryGetVariable(*destVal);
+      if (!dest)
+        continue;
+      copyOf[dest->id] = nullptr;
+      for (auto& c : copyOf) {
+        if (c == dest)
+          c = nullptr;
+      }
+
+      if (o->opCode == PexOpCode::Assign) {
+        auto src = func.tryGetVariable(o->args[1]);
+        if (src && src != dest && func.haveSameType(src, dest))
+          copyOf[dest->id] = src;
+      }
+    }
+  }
+  return changed;
+}
+
+// Writes results straight into the variable a temporary was about to be
+// copied into, when the temporary isn't needed afterwards:
+//   IADD ::temp0 a b
+//   ASSIGN c ::temp0
+// becomes
+//   IADD c a b
+bool coalesceCopies(PexOptFunction& func) {
+  bool changed = false;
+  for (auto b : func.blocks) {
+    PexOptInstruction* pendingAssign = nullptr;
+    PexOptVariable* pendingTemp = nullptr;
+    func.walkLiveness(b, [&](PexOptInstruction* o, const PexOptVarSet& live) {
+      if (pendingAssign) {
+        auto destVal = PexOptFunction::tryGetDest(o);
+        if (destVal && func.tryGetVariable(*destVal) == pendingTemp) {
+          *destVal = pendingAssign->args[0];
+          pendingAssign->kill();
+          changed = true;
+        }
+        pendingAssign = nullptr;
+      }
+
+      if (o->opCode != PexOpCode::Assign)
+        return;
+      auto temp = func.tryGetVariable(o->args[1]);
+      auto target = func.tryGetVariable(o->args[0]);
+      if (temp && temp->isTemp && target && target != temp && !live.contains(temp->id) &&
+          func.haveSameType(temp, target)) {
+        pendingAssign = o;
+        pendingTemp = temp;
+      }
+    });
+  }
+  return changed;
+}
+
+}}}
@@ -0,0 +1,23 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+// Removes pure instructions whose result is never read.
+bool eliminateDeadStores(PexOptFunction& func) {
+  bool changed = false;
+  for (auto b : func.blocks) {
+    func.walkLiveness(b, [&](PexOptInstruction* o, const PexOptVarSet& live) {
+      auto destVal = PexOptFunction::tryGetDest(o);
+      if (!destVal)
+        return;
+      auto dest = func.tryGetVariable(*destVal);
+      if (dest && !live.contains(dest->id) && PexOptFunction::isPure(o)) {
+        o->kill();
+        changed = true;
+      }
+    });
+  }
+  return changed;
+}
+
+}}}
@@ -0,0 +1,186 @@
+#include <pex/optimizer/PexInliner.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+PexInliner::PexInliner(allocators::ChainedPool* alloc, PexFile* file, PexObject* object)
+    : alloc(alloc), file(file), object(object) {
+  for (auto s : object->states) {
+    for (auto f : s->functions) {
+      if (f->isGlobal && !f->isNative && f->instructions.size() <= MaxCalleeInstructions)
+        candidates.emplace(file->getStringValue(f->name), f);
+    }
+  }
+}
+
+bool PexInliner::run(PexOptFunction& func) {
+  if (candidates.empty())
+    return false;
+
+  // Inlining splits blocks, so find the calls up front.
+  std::vector<PexOptInstruction*> calls {};
+  for (auto b : func.blocks) {
+    for (auto o : b->instructions) {
+      if (!o->isDead() && o->opCode == PexOpCode::CallStatic && tryGetCandidate(o))
+        calls.push_back(o);
+    }
+  }
+
+  size_t inlinedCount = 0;
+  for (auto call : calls) {
+    if (inlinedCount == MaxInlinedCallsPerFunction)
+      break;
+    auto callee = tryGetCandidate(call);
+    if (callee == func.function)
+      continue;
+    PexOptFunction calleeFunc { alloc, file, callee, nullptr };
+    if (!canInline(call, calleeFunc))
+      continue;
+    inlineCall(func, call, calleeFunc);
+    inlinedCount++;
+  }
+  if (inlinedCount)
+    func.invalidate();
+  return inlinedCount != 0;
+}
+
+PexFunction* PexInliner::tryGetCandidate(const PexOptInstruction* call) const {
+  auto& type = call->args[0];
+  auto& name = call->args[1];
+  if (type.type != PexValueType::Identifier || name.type != PexValueType::Identifier)
+    return nullptr;
+  if (!idEq(file->getStringValue(type.val.s), file->getStringValue(object->name)))
+    return nullptr;
+  auto f = candidates.find(file->getStringValue(name.val.s));
+  return f == candidates.end() ? nullptr : f->second;
+}
+
+bool PexInliner::canInline(const PexOptInstruction* call, PexOptFunction& callee) const {
+  if (call->variadicArgs.size() != callee.function->parameters.size())
+    return false;
+
+  for (auto b : callee.blocks) {
+    for (auto o : b->instructions) {
+      switch (o->opCode) {
+        // Anything that can run other script code might be latent, so only
+        // leaf functions are inlined.
+        case PexOpCode::CallMethod:
+        case PexOpCode::CallParent:
+        case PexOpCode::CallStatic:
+        case PexOpCode::PropGet:
+        case PexOpCode::PropSet:
+        case PexOpCode::LockGuards:
+        case PexOpCode::UnlockGuards:
+        case PexOpCode::TryLockGuards:
+          return false;
+        default:
+          break;
+      }
+
+      // Everything it touches has to be its own, so that it can be renamed.
+      for (size_t i = 0; i < o->args.size(); i++) {
+        auto& a = o->args[i];
+        if (a.type == PexValueType::Identifier && PexOptFunction::getArgKind(o->opCode, i) != PexOptArgKind::Name &&
+            !callee.tryGetVariable(a)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  // Locals start out with their default value on every call, which an
+  // inlined copy can't count on.
+  callee.ensureDataFlow();
+  bool readsUninitializedLocal = false;
+  callee.entryBlock()->liveIn.forEach([&](size_t id) {
+    if (!callee.variables[id]->isParameter)
+      readsUninitializedLocal = true;
+  });
+  if (readsUninitializedLocal)
+    return false;
+
+  // Falling off the end returns None, which is only what a function that
+  // doesn't return anything would.
+  if (!callee.exitBlock()->predecessors.empty() &&
+      !idEq(file->getStringValue(callee.function->returnTypeName), "None")) {
+    return false;
+  }
+  return true;
+}
+
+void PexInliner::inlineCall(PexOptFunction& func, PexOptInstruction* call, PexOptFunction& callee) {
+  auto block = call->block;
+  auto index = (size_t)(std::find(block->instructions.begin(), block->instructions.end(), call) -
+                        block->instructions.begin());
+  auto after = func.splitBlock(block, index + 1);
+  call->kill();
+
+  // Everything inlined is attributed to the line of the call.
+  const auto line = call->lineNumber;
+  const auto append = [](PexOptBasicBlock* b, PexOptInstruction* o) {
+    b->instructions.push_back(o);
+    return o;
+  };
+  const auto emit = [&](PexOptBasicBlock* b, PexOpCode op, std::initializer_list<PexValue> args) {
+    return append(b, func.createInstruction(op, args, b, line));
+  };
+
+  // The parameters are the first variables, in order.
+  std::vector<PexOptVariable*> renamed(callee.variables.size());
+  for (auto v : callee.variables)
+    renamed[v->id] = func.createTemp(v->type);
+  size_t paramIndex = 0;
+  for (auto& a : call->variadicArgs)
+    emit(block, PexOpCode::Assign, { PexValue(PexValue::Identifier(renamed[paramIndex++]->name)), a });
+
+  const auto rename = [&](const PexValue& val) {
+    if (auto v = callee.tryGetVariable(val))
+      return PexValue(PexValue::Identifier(renamed[v->id]->name));
+    return val;
+  };
+
+  // The callee's exit is where the call used to return to.
+  std::unordered_map<const PexOptBasicBlock*, PexOptBasicBlock*> blockMap {};
+  blockMap.emplace(callee.exitBlock(), after);
+  std::vector<PexOptBasicBlock*> newBlocks {};
+  for (auto b : callee.blocks) {
+    if (b == callee.exitBlock())
+      continue;
+    newBlocks.push_back(func.createBlock());
+    blockMap.emplace(b, newBlocks.back());
+  }
+  func.blocks.insert(std::find(func.blocks.begin(), func.blocks.end(), after), newBlocks.begin(), newBlocks.end());
+
+  const bool returnsValue = !idEq(file->getStringValue(callee.function->returnTypeName), "None");
+  const auto& dest = call->args[2];
+  for (auto b : callee.blocks) {
+    if (b == callee.exitBlock())
+      continue;
+    auto newBlock = blockMap[b];
+    for (auto o : b->instructions) {
+      if (o->opCode == PexOpCode::Return) {
+        if (returnsValue)
+          emit(newBlock, PexOpCode::Assign, { dest, rename(o->args[0]) });
+        auto jmp = emit(newBlock, PexOpCode::Jmp, { PexValue(PexValue::Integer(0)) });
+        jmp->branchTarget = after;
+        continue;
+      }
+
+      std::vector<PexValue> args {};
+      for (size_t i = 0; i < o->args.size(); i++) {
+        if (PexOptFunction::getArgKind(o->opCode, i) == PexOptArgKind::Name)
+          args.push_back(o->args[i]);
+        else
+          args.push_back(rename(o->args[i]));
+      }
+      auto copy = append(newBlock, func.createInstruction(o->opCode, args, {}, newBlock, line));
+      if (o->branchTarget)
+        copy->branchTarget = blockMap[o->branchTarget];
+    }
+  }
+}
+
+}}}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <common/CaselessStringComparer.h>
+#include <common/allocators/ChainedPool.h>
+
+#include <pex/PexFile.h>
+#include <pex/PexFunction.h>
+#include <pex/PexObject.h>
+#include <pex/optimizer/PexOptFunction.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+// Inlines calls to small global functions of the same object. Globals are
+// the only functions that can't be overridden by a child script or a state,
+// and anything in another script could be swapped out by the game, so
+// nothing else is ever considered.
+struct PexInliner final {
+  explicit PexInliner(allocators::ChainedPool* alloc, PexFile* file, PexObject* object);
+  PexInliner(const PexInliner&) = delete;
+  ~PexInliner() = default;
+
+  bool run(PexOptFunction& func);
+  bool hasCandidates() const noexcept { return !candidates.empty(); }
+
+private:
+  // Callees larger than this aren't worth the code growth.
+  static constexpr size_t MaxCalleeInstructions = 16;
+  // Stop once this many calls have been inlined into a single function.
+  static constexpr size_t MaxInlinedCallsPerFunction = 32;
+
+  allocators::ChainedPool* alloc;
+  PexFile* file;
+  PexObject* object;
+  caseless_unordered_identifier_ref_map<PexFunction*> candidates {};
+
+  PexFunction* tryGetCandidate(const PexOptInstruction* call) const;
+  bool canInline(const PexOptInstruction* call, PexOptFunction& callee) const;
+  void inlineCall(PexOptFunction& func, PexOptInstruction* call, PexOptFunction& callee);
+};
+
+}}}
@@ -0,0 +1,377 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <common/CapricaConfig.h>
+#include <common/CaselessStringComparer.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+namespace {
+
+// The dominator tree of the reachable blocks, built with the algorithm from
+// "A Simple, Fast Dominance Algorithm" by Cooper, Harvey and Kennedy.
+struct DominatorTree final {
+  // The reachable blocks in reverse post-order.
+  std::vector<PexOptBasicBlock*> order {};
+
+  explicit DominatorTree(PexOptFunction& func) {
+    func.ensureCFG();
+
+    std::unordered_set<const PexOptBasicBlock*> visited {};
+    std::vector<std::pair<PexOptBasicBlock*, size_t>> stack {};
+    visited.insert(func.entryBlock());
+    stack.emplace_back(func.entryBlock(), 0);
+    while (!stack.empty()) {
+      auto& [b, next] = stack.back();
+      if (next < b->successors.size()) {
+        auto s = b->successors[next++];
+        if (visited.insert(s).second)
+          stack.emplace_back(s, 0);
+        continue;
+      }
+      order.push_back(b);
+      stack.pop_back();
+    }
+    std::reverse(order.begin(), order.end());
+    for (size_t i = 0; i < order.size(); i++)
+      indexOf.emplace(order[i], i);
+
+    idom.assign(order.size(), NoIndex);
+    idom[0] = 0;
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (size_t i = 1; i < order.size(); i++) {
+        auto newIdom = NoIndex;
+        for (auto p : order[i]->predecessors) {
+          auto f = indexOf.find(p);
+          if (f == indexOf.end() || idom[f->second] == NoIndex)
+            continue;
+          newIdom = newIdom == NoIndex ? f->second : intersect(f->second, newIdom);
+        }
+        if (newIdom != idom[i]) {
+          idom[i] = newIdom;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  bool isReachable(const PexOptBasicBlock* b) const { return indexOf.count(b) != 0; }
+
+  bool dominates(const PexOptBasicBlock* a, const PexOptBasicBlock* b) const {
+    auto ai = indexOf.at(a);
+    auto bi = indexOf.at(b);
+    while (bi > ai)
+      bi = idom[bi];
+    return bi == ai;
+  }
+
+private:
+  static constexpr size_t NoIndex = ~(size_t)0;
+
+  std::unordered_map<const PexOptBasicBlock*, size_t> indexOf {};
+  std::vector<size_t> idom {};
+
+  size_t intersect(size_t a, size_t b) const {
+    while (a != b) {
+      while (a > b)
+        a = idom[a];
+      while (b > a)
+        b = idom[b];
+    }
+    return a;
+  }
+};
+
+struct Loop final {
+  PexOptBasicBlock* header { nullptr };
+  // In reverse post-order, so a block comes before any block it dominates.
+  std::vector<PexOptBasicBlock*> blocks {};
+  std::unordered_set<const PexOptBasicBlock*> contains {};
+};
+
+// Finds the natural loops, innermost first. Loops sharing a header are
+// treated as one.
+static std::vector<Loop> findLoops(const DominatorTree& doms) {
+  std::unordered_map<const PexOptBasicBlock*, size_t> loopIndex {};
+  std::vector<Loop> loops {};
+  for (auto b : doms.order) {
+    for (auto h : b->successors) {
+      if (!doms.dominates(h, b))
+        continue;
+      auto f = loopIndex.find(h);
+      if (f == loopIndex.end()) {
+        f = loopIndex.emplace(h, loops.size()).first;
+        loops.emplace_back();
+        loops.back().header = h;
+        loops.back().contains.insert(h);
+      }
+      auto& loop = loops[f->second];
+      std::vector<PexOptBasicBlock*> worklist { b };
+      while (!worklist.empty()) {
+        auto cur = worklist.back();
+        worklist.pop_back();
+        if (!loop.contains.insert(cur).second)
+          continue;
+        for (auto p : cur->predecessors) {
+          if (doms.isReachable(p))
+            worklist.push_back(p);
+        }
+      }
+    }
+  }
+
+  for (auto& loop : loops) {
+    for (auto b : doms.order) {
+      if (loop.contains.count(b))
+        loop.blocks.push_back(b);
+    }
+  }
+  std::stable_sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) {
+    return a.blocks.size() < b.blocks.size();
+  });
+  return loops;
+}
+
+// The block that control enters the loop from, creating one if there isn't
+// a block that only leads to the header.
+static PexOptBasicBlock* getPreheader(PexOptFunction& func, const Loop& loop) {
+  std::vector<PexOptBasicBlock*> outside {};
+  for (auto p : loop.header->predecessors) {
+    if (!loop.contains.count(p))
+      outside.push_back(p);
+  }
+  if (loop.header != func.entryBlock() && outside.size() == 1 && outside[0]->successors.size() == 1) {
+    auto term = outside[0]->terminator();
+    if (!term || term->opCode == PexOpCode::Jmp)
+      return outside[0];
+  }
+
+  // The new block goes right before the header, which only works if
+  // nothing in the loop falls through into the header.
+  auto pos = std::find(func.blocks.begin(), func.blocks.end(), loop.header);
+  if (pos != func.blocks.begin() && loop.contains.count(*(pos - 1)) && (*(pos - 1))->fallsThrough())
+    return nullptr;
+  auto preheader = func.createBlock();
+  func.blocks.insert(pos, preheader);
+  for (auto p : outside) {
+    auto term = p->terminator();
+    if (term && term->branchTarget == loop.header)
+      term->branchTarget = preheader;
+  }
+  func.invalidate();
+  return preheader;
+}
+
+static bool isCollectionCountCall(PexOptFunction& func, const PexOptInstruction* instr) {
+  if (instr->opCode != PexOpCode::CallMethod || instr->variadicArgs.size() != 0 ||
+      instr->args[0].type != PexValueType::Identifier) {
+    return false;
+  }
+  auto name = func.file->getStringValue(instr->args[0].val.s);
+  return idEq(name, "GetCount") || idEq(name, "GetSize");
+}
+
+// Whether every use of the collection in the loop, or of any local that's
+// been assigned to or from it, is a call to one of the methods a ForEach
+// loop uses to read it.
+static bool onlyReadsCollection(PexOptFunction& func, const Loop& loop, PexOptVariable* collection) {
+  std::unordered_set<const PexOptVariable*> aliases { collection };
+  std::vector<PexOptVariable*> worklist { collection };
+  while (!worklist.empty()) {
+    auto v = worklist.back();
+    worklist.pop_back();
+    for (auto list : { &v->defs, &v->uses }) {
+      for (auto o : *list) {
+        if (o->isDead() || o->opCode != PexOpCode::Assign)
+          continue;
+        for (auto& a : o->args) {
+          auto other = func.tryGetVariable(a);
+          if (other && aliases.insert(other).second)
+            worklist.push_back(other);
+        }
+      }
+    }
+  }
+
+  for (auto b : loop.blocks) {
+    for (auto o : b->instructions) {
+      if (o->isDead())
+        continue;
+      bool isReadOnlyCall = false;
+      if (o->opCode == PexOpCode::CallMethod && o->args[0].type == PexValueType::Identifier &&
+          aliases.count(func.tryGetVariable(o->args[1]))) {
+        auto name = func.file->getStringValue(o->args[0].val.s);
+        isReadOnlyCall = idEq(name, "GetAt") || idEq(name, "GetCount") || idEq(name, "GetSize");
+      }
+      bool usesCollection = false;
+      PexOptFunction::forEachUse(o, [&](PexValue& val) {
+        usesCollection |= aliases.count(func.tryGetVariable(val)) != 0;
+      });
+      if (usesCollection && !isReadOnlyCall)
+        return false;
+    }
+  }
+  return true;
+}
+
+enum class Hoistability {
+  No,
+  // It can be executed even when the loop wouldn't have reached it.
+  Always,
+  // It has to be reached by every trip through the loop.
+  IfAlwaysRun,
+};
+
+static bool hoistFromLoop(PexOptFunction& func, const DominatorTree& doms, const Loop& loop) {
+  func.ensureDataFlow();
+
+  std::vector<size_t> loopDefCount(func.variables.size(), 0);
+  bool hasCalls = false;
+  bool mutatesArrays = false;
+  std::vector<PexOptBasicBlock*> exitingBlocks {};
+  for (auto b : loop.blocks) {
+    for (auto o : b->instructions) {
+      if (o->isDead())
+        continue;
+      if (auto dest = PexOptFunction::tryGetDest(o)) {
+        if (auto v = func.tryGetVariable(*dest))
+          loopDefCount[v->id]++;
+      }
+      switch (o->opCode) {
+        case PexOpCode::CallMethod:
+        case PexOpCode::CallParent:
+        case PexOpCode::CallStatic:
+        case PexOpCode::PropGet:
+        case PexOpCode::PropSet:
+          hasCalls = true;
+          break;
+        case PexOpCode::ArrayAdd:
+        case PexOpCode::ArrayInsert:
+        case PexOpCode::ArrayRemoveLast:
+        case PexOpCode::ArrayRemove:
+        case PexOpCode::ArrayClear:
+          mutatesArrays = true;
+          break;
+        default:
+          break;
+      }
+    }
+    if (std::any_of(b->successors.begin(), b->successors.end(), [&](const PexOptBasicBlock* s) {
+          return !loop.contains.count(s);
+        })) {
+      exitingBlocks.push_back(b);
+    }
+  }
+
+  const auto isInvariant = [&](const PexValue& val) {
+    if (val.type != PexValueType::Identifier)
+      return true;
+    if (auto v = func.tryGetVariable(val))
+      return loopDefCount[v->id] == 0;
+    // Object variables can be changed by any call, or by another thread.
+    return idEq(func.file->getStringValue(val.val.s), "self");
+  };
+
+  const auto getHoistability = [&](const PexOptInstruction* instr) {
+    if (instr->opCode == PexOpCode::Assign)
+      return Hoistability::No;
+    if (PexOptFunction::isPure(instr))
+      return Hoistability::Always;
+    // The length of an array only changes when something adds or removes
+    // elements, and a call could do that to any array it can see.
+    if (instr->opCode == PexOpCode::ArrayLength && !hasCalls && !mutatesArrays)
+      return Hoistability::IfAlwaysRun;
+    // Nothing here can tell what a call to another script does, so this is
+    // only done when asked for.
+    if (conf::CodeGeneration::enableCollectionCountHoisting && isCollectionCountCall(func, instr)) {
+      auto collection = func.tryGetVariable(instr->args[1]);
+      if (collection && onlyReadsCollection(func, loop, collection))
+        return Hoistability::IfAlwaysRun;
+    }
+    return Hoistability::No;
+  };
+
+  PexOptBasicBlock* preheader = nullptr;
+  bool changed = false;
+  for (auto b : loop.blocks) {
+    const bool alwaysRuns = std::all_of(exitingBlocks.begin(), exitingBlocks.end(), [&](const PexOptBasicBlock* e) {
+      return doms.dominates(b, e);
+    });
+    for (auto o : b->instructions) {
+      if (o->isDead() || o == b->terminator())
+        continue;
+      auto destVal = PexOptFunction::tryGetDest(o);
+      auto dest = destVal ? func.tryGetVariable(*destVal) : nullptr;
+      if (!dest)
+        continue;
+      auto hoistability = getHoistability(o);
+      if (hoistability == Hoistability::No || (hoistability == Hoistability::IfAlwaysRun && !alwaysRuns))
+        continue;
+      bool operandsInvariant = true;
+      PexOptFunction::forEachUse(o, [&](PexValue& val) { operandsInvariant &= isInvariant(val); });
+      if (!operandsInvariant)
+        continue;
+
+      if (!preheader) {
+        preheader = getPreheader(func, loop);
+        if (!preheader)
+          return changed;
+      }
+      auto insertPos = preheader->instructions.end();
+      if (preheader->terminator())
+        --insertPos;
+
+      // If this is the only write to the destination in the loop, and the
+      // loop doesn't read the value it had before, the instruction can be
+      // moved as is. Otherwise the result goes to a new temp, which the
+      // destination gets assigned from where the instruction used to be.
+      if (loopDefCount[dest->id] == 1 && !loop.header->liveIn.contains(dest->id)) {
+        auto hoisted = func.createInstruction(o->opCode, o->args, o->variadicArgs, preheader, o->lineNumber);
+        preheader->instructions.insert(insertPos, hoisted);
+        o->kill();
+        loopDefCount[dest->id] = 0;
+      } else {
+        auto temp = func.createTemp(dest->type);
+        auto tempVal = PexValue(PexValue::Identifier(temp->name));
+        auto hoisted = func.createInstruction(o->opCode, o->args, o->variadicArgs, preheader, o->lineNumber);
+        *PexOptFunction::tryGetDest(hoisted) = tempVal;
+        preheader->instructions.insert(insertPos, hoisted);
+        func.replaceInstruction(o, PexOpCode::Assign, { *destVal, tempVal });
+      }
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}
+
+// Moves computations that give the same result on every trip through a loop
+// out in front of it.
+bool hoistLoopInvariants(PexOptFunction& func) {
+  bool changed = false;
+  // Hoisting changes the CFG, so the loops are found again after each one
+  // that something was hoisted out of.
+  for (bool hoisted = true; hoisted;) {
+    hoisted = false;
+    DominatorTree doms { func };
+    for (auto& loop : findLoops(doms)) {
+      if (hoistFromLoop(func, doms, loop)) {
+        func.removeDeadInstructions();
+        func.invalidate();
+        hoisted = changed = true;
+        break;
+      }
+    }
+  }
+  return changed;
+}
+
+}}}
@@ -0,0 +1,472 @@
+#include <pex/optimizer/PexOptFunction.h>
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <common/CapricaReportingContext.h>
+#include <common/CaselessStringComparer.h>
+
+#include <pex/PexFunctionBuilder.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+PexOptInstruction* PexOptBasicBlock::terminator() const {
+  if (instructions.empty())
+    return nullptr;
+  auto last = instructions.back();
+  if (last->isDead())
+    return nullptr;
+  if (last->isBranch() || last->opCode == PexOpCode::Return)
+    return last;
+  return nullptr;
+}
+
+bool PexOptBasicBlock::fallsThrough() const {
+  auto term = terminator();
+  if (!term)
+    return true;
+  return term->opCode != PexOpCode::Jmp && term->opCode != PexOpCode::Return;
+}
+
+PexOptFunction::PexOptFunction(allocators::ChainedPool* alloc,
+                               PexFile* file,
+                               PexFunction* function,
+                               PexDebugFunctionInfo* debInfo)
+    : file(file), function(function), debugInfo(debInfo), alloc(alloc) {
+  buildVariables();
+  buildBlocks();
+}
+
+PexOptBasicBlock* PexOptFunction::createBlock() {
+  return alloc->make<PexOptBasicBlock>(nextBlockID++);
+}
+
+PexOptInstruction* PexOptFunction::createInstruction(PexOpCode op,
+                                                     std::span<const PexValue> args,
+                                                     std::span<const PexValue> variadicArgs,
+                                                     PexOptBasicBlock* block,
+                                                     uint16_t line) {
+  auto o = alloc->make<PexOptInstruction>(op, allocateArgs(args), allocateArgs(variadicArgs), line);
+  o->block = block;
+  return o;
+}
+
+void PexOptFunction::replaceInstruction(PexOptInstruction* o, PexOpCode op, std::initializer_list<PexValue> args) {
+  o->opCode = op;
+  o->args = allocateArgs(std::span<const PexValue>(args.begin(), args.size()));
+  o->variadicArgs = {};
+}
+
+std::span<PexValue> PexOptFunction::allocateArgs(std::span<const PexValue> args) {
+  if (args.empty())
+    return {};
+  auto buf = (PexValue*)alloc->allocate(sizeof(PexValue) * args.size());
+  std::uninitialized_copy(args.begin(), args.end(), buf);
+  return { buf, args.size() };
+}
+
+PexOptVariable* PexOptFunction::createTemp(const PexString& type) {
+  auto loc = file->alloc->make<PexLocalVariable>();
+  loc->name = file->getString("::temp" + std::to_string(nextTempID++));
+  loc->type = type;
+  function->locals.push_back(loc);
+
+  auto v = alloc->make<PexOptVariable>();
+  v->id = variables.size();
+  v->name = loc->name;
+  v->type = type;
+  v->isTemp = true;
+  variables.push_back(v);
+  variableMap[loc->name.index] = v;
+  dataFlowValid = false;
+  return v;
+}
+
+PexOptBasicBlock* PexOptFunction::splitBlock(PexOptBasicBlock* block, size_t index) {
+  auto newBlock = createBlock();
+  for (size_t i = index; i < block->instructions.size(); i++) {
+    block->instructions[i]->block = newBlock;
+    newBlock->instructions.push_back(block->instructions[i]);
+  }
+  block->instructions.resize(index);
+  blocks.insert(std::find(blocks.begin(), blocks.end(), block) + 1, newBlock);
+  invalidate();
+  return newBlock;
+}
+
+void PexOptFunction::buildVariables() {
+  caseless_unordered_identifier_ref_map<PexOptVariable*> byName {};
+  const auto add = [&](const PexString& name, const PexString& type, bool isParameter) {
+    auto nameStr = file->getStringValue(name);
+    if (byName.count(nameStr))
+      return;
+    auto v = alloc->make<PexOptVariable>();
+    v->id = variables.size();
+    v->name = name;
+    v->type = type;
+    v->isParameter = isParameter;
+    v->isTemp = !isParameter && nameStr.starts_with("::temp");
+    if (v->isTemp) {
+      size_t tempID = 0;
+      auto digits = nameStr.to_string_view().substr(6);
+      if (std::from_chars(digits.data(), digits.data() + digits.size(), tempID).ec == std::errc {})
+        nextTempID = std::max(nextTempID, tempID + 1);
+    }
+    variables.push_back(v);
+    byName.emplace(nameStr, v);
+    variableMap.emplace(name.index, v);
+  };
+  for (auto p : function->parameters)
+    add(p->name, p->type, true);
+  for (auto l : function->locals)
+    add(l->name, l->type, false);
+
+  // Identifiers are caseless, but string indexes aren't, so every spelling
+  // that's actually used has to be mapped.
+  const auto mapValue = [&](const PexValue& v) {
+    if (v.type != PexValueType::Identifier || variableMap.count(v.val.s.index))
+      return;
+    auto f = byName.find(file->getStringValue(v.val.s));
+    variableMap.emplace(v.val.s.index, f == byName.end() ? nullptr : f->second);
+  };
+  for (auto& a : function->operands)
+    mapValue(a);
+}
+
+void PexOptFunction::buildBlocks() {
+  const auto instructionCount = function->instructions.size();
+  std::vector<bool> isLeader(instructionCount + 1, false);
+  for (size_t i = 0; i < instructionCount; i++) {
+    auto& cur = function->instructions[i];
+    if (cur.isBranch()) {
+      auto target = (int64_t)i + cur.branchTarget(function->operands);
+      if (target < 0 || target > (int64_t)instructionCount)
+        CapricaReportingContext::logicalFatal("Branch target out of range in function '{}'!",
+                                              file->getStringValue(function->name));
+      isLeader[(size_t)target] = true;
+    }
+    if (cur.isBranch() || cur.opCode == PexOpCode::Return)
+      isLeader[i + 1] = true;
+  }
+
+  std::vector<PexOptBasicBlock*> blockAt(instructionCount + 1, nullptr);
+  blocks.push_back(createBlock());
+  blockAt[0] = blocks.back();
+  for (size_t i = 1; i < instructionCount; i++) {
+    if (isLeader[i]) {
+      blocks.push_back(createBlock());
+      blockAt[i] = blocks.back();
+    }
+  }
+  blocks.push_back(createBlock());
+  blockAt[instructionCount] = blocks.back();
+
+  PexOptBasicBlock* curBlock = nullptr;
+  for (size_t i = 0; i < instructionCount; i++) {
+    auto& cur = function->instructions[i];
+    if (blockAt[i])
+      curBlock = blockAt[i];
+    uint16_t line = 0;
+    if (debugInfo && i < debugInfo->instructionLineMap.size())
+      line = debugInfo->instructionLineMap[i];
+    auto o = alloc->make<PexOptInstruction>(cur.opCode,
+                                            cur.args(function->operands),
+                                            cur.variadicArgs(function->operands),
+                                            line);
+    o->block = curBlock;
+    if (cur.isBranch())
+      o->branchTarget = blockAt[i + cur.branchTarget(function->operands)];
+    curBlock->instructions.push_back(o);
+  }
+}
+
+void PexOptFunction::ensureCFG() {
+  if (cfgValid)
+    return;
+
+  for (auto b : blocks) {
+    b->predecessors.clear();
+    b->successors.clear();
+  }
+  const auto addEdge = [](PexOptBasicBlock* from, PexOptBasicBlock* to) {
+    if (std::find(from->successors.begin(), from->successors.end(), to) != from->successors.end())
+      return;
+    from->successors.push_back(to);
+    to->predecessors.push_back(from);
+  };
+  for (size_t i = 0; i < blocks.size(); i++) {
+    auto term = blocks[i]->terminator();
+    if (term && term->branchTarget)
+      addEdge(blocks[i], term->branchTarget);
+    if (blocks[i]->fallsThrough() && i + 1 < blocks.size())
+      addEdge(blocks[i], blocks[i + 1]);
+  }
+  cfgValid = true;
+}
+
+void PexOptFunction::ensureDataFlow() {
+  if (dataFlowValid)
+    return;
+  ensureCFG();
+
+  for (auto v : variables) {
+    v->defs.clear();
+    v->uses.clear();
+  }
+
+  // The variables read before being written in each block, and the ones
+  // written in it.
+  std::vector<PexOptVarSet> upwardUses(blocks.size());
+  std::vector<PexOptVarSet> kills(blocks.size());
+  for (size_t i = 0; i < blocks.size(); i++) {
+    auto b = blocks[i];
+    upwardUses[i].resize(variables.size());
+    kills[i].resize(variables.size());
+    b->liveIn.resize(variables.size());
+    b->liveOut.resize(variables.size());
+    for (auto o : b->instructions) {
+      if (o->isDead())
+        continue;
+      forEachUse(o, [&](PexValue& val) {
+        if (auto v = tryGetVariable(val)) {
+          v->uses.push_back(o);
+          if (!kills[i].contains(v->id))
+            upwardUses[i].insert(v->id);
+        }
+      });
+      if (auto dest = tryGetDest(o)) {
+        if (auto v = tryGetVariable(*dest)) {
+          v->defs.push_back(o);
+          kills[i].insert(v->id);
+        }
+      }
+    }
+  }
+
+  // Blocks are mostly laid out in control-flow order, so walking them
+  // backwards converges quickly.
+  PexOptVarSet newIn {};
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = blocks.size(); i-- > 0;) {
+      auto b = blocks[i];
+      for (auto s : b->successors)
+        b->liveOut.unionWith(s->liveIn);
+      newIn = b->liveOut;
+      newIn.subtract(kills[i]);
+      newIn.unionWith(upwardUses[i]);
+      if (newIn != b->liveIn) {
+        b->liveIn = newIn;
+        changed = true;
+      }
+    }
+  }
+  dataFlowValid = true;
+}
+
+PexOptVariable* PexOptFunction::tryGetVariable(const PexValue& val) const {
+  if (val.type != PexValueType::Identifier)
+    return nullptr;
+  auto f = variableMap.find(val.val.s.index);
+  if (f == variableMap.end())
+    return nullptr;
+  return f->second;
+}
+
+bool PexOptFunction::haveSameType(const PexOptVariable* a, const PexOptVariable* b) const {
+  return a->type == b->type || idEq(file->getStringValue(a->type), file->getStringValue(b->type));
+}
+
+PexOptArgKind PexOptFunction::getArgKind(PexOpCode op, size_t argIndex) {
+  switch (op) {
+    case PexOpCode::CallMethod:
+      return argIndex == 0 ? PexOptArgKind::Name : argIndex == 2 ? PexOptArgKind::Def : PexOptArgKind::Use;
+    case PexOpCode::CallParent:
+      return argIndex == 0 ? PexOptArgKind::Name : PexOptArgKind::Def;
+    case PexOpCode::CallStatic:
+      return argIndex < 2 ? PexOptArgKind::Name : PexOptArgKind::Def;
+    case PexOpCode::PropGet:
+      return argIndex == 0 ? PexOptArgKind::Name : argIndex == 2 ? PexOptArgKind::Def : PexOptArgKind::Use;
+    case PexOpCode::PropSet:
+      return argIndex == 0 ? PexOptArgKind::Name : PexOptArgKind::Use;
+    case PexOpCode::StructGet:
+      return argIndex == 2 ? PexOptArgKind::Name : argIndex == 0 ? PexOptArgKind::Def : PexOptArgKind::Use;
+    case PexOpCode::StructSet:
+      return argIndex == 1 ? PexOptArgKind::Name : PexOptArgKind::Use;
+    case PexOpCode::Is:
+      return argIndex == 2 ? PexOptArgKind::Name : argIndex == 0 ? PexOptArgKind::Def : PexOptArgKind::Use;
+    case PexOpCode::LockGuards:
+    case PexOpCode::UnlockGuards:
+      return PexOptArgKind::Name;
+    default:
+      if ((int32_t)argIndex == PexInstruction::getDestArgIndexForOpCode(op))
+        return PexOptArgKind::Def;
+      return PexOptArgKind::Use;
+  }
+}
+
+template <typename T>
+static constexpr bool isValueArg = std::is_same<T, PexValue>::value;
+
+static bool isValueArgAt(size_t argIndex, std::initializer_list<bool> argIsValue) {
+  return argIndex < argIsValue.size() && argIsValue.begin()[argIndex];
+}
+
+// Use the opcodes descriptions from the function builder to manage this.
+bool PexOptFunction::acceptsConstant(PexOpCode op, size_t argIndex) {
+  switch (op) {
+#define OP_ARG1(name, opcode, destArgIdx, t1, n1) \
+  case PexOpCode::opcode:                         \
+    return isValueArgAt(argIndex, { isValueArg<t1> });
+#define OP_ARG2(name, opcode, destArgIdx, t1, n1, t2, n2) \
+  case PexOpCode::opcode:                                 \
+    return isValueArgAt(argIndex, { isValueArg<t1>, isValueArg<t2> });
+#define OP_ARG3(name, opcode, destArgIdx, t1, n1, t2, n2, t3, n3) \
+  case PexOpCode::opcode:                                         \
+    return isValueArgAt(argIndex, { isValueArg<t1>, isValueArg<t2>, isValueArg<t3> });
+#define OP_ARG4(name, opcode, destArgIdx, t1, n1, t2, n2, t3, n3, t4, n4) \
+  case PexOpCode::opcode:                                                 \
+    return isValueArgAt(argIndex, { isValueArg<t1>, isValueArg<t2>, isValueArg<t3>, isValueArg<t4> });
+#define OP_ARG5(name, opcode, destArgIdx, t1, n1, t2, n2, t3, n3, t4, n4, t5, n5)                        \
+  case PexOpCode::opcode:                                                                                \
+    return isValueArgAt(argIndex,                                                                        \
+                        { isValueArg<t1>, isValueArg<t2>, isValueArg<t3>, isValueArg<t4>, isValueArg<t5> });
+#define OP_ARG6(name, opcode, destArgIdx, t1, n1, t2, n2, t3, n3, t4, n4, t5, n5, t6, n6)       \
+  case PexOpCode::opcode:                                                                       \
+    return isValueArgAt(                                                                        \
+        argIndex,                                                                               \
+        { isValueArg<t1>, isValueArg<t2>, isValueArg<t3>, isValueArg<t4>, isValueArg<t5>, isValueArg<t6> });
+    OPCODES(OP_ARG1, OP_ARG2, OP_ARG3, OP_ARG4, OP_ARG5, OP_ARG6)
+#undef OP_ARG1
+#undef OP_ARG2
+#undef OP_ARG3
+#undef OP_ARG4
+#undef OP_ARG5
+#undef OP_ARG6
+    default:
+      return false;
+  }
+}
+
+// A divisor that can't make the division fail. -1 is out, as dividing the
+// smallest int by it overflows.
+static bool isSafeDivisor(const PexValue& val) {
+  return (val.type == PexValueType::Integer && val.val.i != 0 && val.val.i != -1) ||
+         (val.type == PexValueType::Float && val.val.f != 0);
+}
+
+bool PexOptFunction::isPure(const PexOptInstruction* o) {
+  switch (o->opCode) {
+    case PexOpCode::Assign:
+    case PexOpCode::IAdd:
+    case PexOpCode::FAdd:
+    case PexOpCode::ISub:
+    case PexOpCode::FSub:
+    case PexOpCode::IMul:
+    case PexOpCode::FMul:
+    case PexOpCode::INeg:
+    case PexOpCode::FNeg:
+    case PexOpCode::Not:
+    case PexOpCode::CmpEq:
+    case PexOpCode::CmpLt:
+    case PexOpCode::CmpLte:
+    case PexOpCode::CmpGt:
+    case PexOpCode::CmpGte:
+    case PexOpCode::StrCat:
+    case PexOpCode::Cast:
+    case PexOpCode::Is:
+      return true;
+
+    case PexOpCode::IDiv:
+    case PexOpCode::FDiv:
+    case PexOpCode::IMod:
+      return isSafeDivisor(o->args[2]);
+
+    default:
+      return false;
+  }
+}
+
+PexValue* PexOptFunction::tryGetDest(PexOptInstruction* o) {
+  auto idx = PexInstruction::getDestArgIndexForOpCode(o->opCode);
+  if (idx == -1 || (size_t)idx >= o->args.size() || o->args[idx].type != PexValueType::Identifier)
+    return nullptr;
+  return &o->args[idx];
+}
+
+void PexOptFunction::removeDeadInstructions() {
+  for (auto b : blocks) {
+    auto e = std::remove_if(b->instructions.begin(), b->instructions.end(), [](PexOptInstruction* o) {
+      return o->isDead();
+    });
+    if (e != b->instructions.end()) {
+      b->instructions.erase(e, b->instructions.end());
+      invalidate();
+    }
+  }
+}
+
+void PexOptFunction::lower() {
+  removeDeadInstructions();
+  if (!exitBlock()->instructions.empty())
+    CapricaReportingContext::logicalFatal("The exit block of a function must be empty!");
+
+  size_t instructionCount = 0;
+  for (auto b : blocks) {
+    b->loweredIndex = instructionCount;
+    instructionCount += b->instructions.size();
+  }
+
+  // The arguments may still be in the old operand pool, so the new one is
+  // built on the side.
+  std::vector<PexInstruction> newInstructions {};
+  std::vector<PexValue> newOperands {};
+  std::vector<uint16_t> newLineInfo {};
+  newInstructions.reserve(instructionCount);
+  newOperands.reserve(function->operands.size());
+  newLineInfo.reserve(instructionCount);
+  for (auto b : blocks) {
+    for (auto o : b->instructions) {
+      if (o->isBranch()) {
+        if (!o->branchTarget)
+          CapricaReportingContext::logicalFatal("A branch lost its target during optimization!");
+        auto& target = o->args[PexInstruction::getBranchTargetArgIndex(o->opCode)];
+        assert(target.type == PexValueType::Integer);
+        target.val.i = (int)o->branchTarget->loweredIndex - (int)newInstructions.size();
+      }
+      newLineInfo.push_back(o->lineNumber);
+      newInstructions.push_back(PexInstruction(newOperands, o->opCode, o->args, o->variadicArgs));
+    }
+  }
+
+  function->instructions = std::move(newInstructions);
+  function->operands = std::move(newOperands);
+  if (debugInfo)
+    debugInfo->instructionLineMap = std::move(newLineInfo);
+
+  std::vector<bool> isReferenced(variables.size(), false);
+  for (auto& a : function->operands) {
+    if (auto v = tryGetVariable(a))
+      isReferenced[v->id] = true;
+  }
+  std::vector<PexLocalVariable*> keptLocals {};
+  for (auto l : function->locals) {
+    auto v = variableMap.find(l->name.index);
+    if (v == variableMap.end() || !v->second->isTemp || isReferenced[v->second->id])
+      keptLocals.push_back(l);
+  }
+  if (keptLocals.size() != function->locals.size()) {
+    IntrusiveLinkedList<PexLocalVariable> newLocals {};
+    for (auto l : keptLocals)
+      newLocals.push_back(l);
+    function->locals = std::move(newLocals);
+  }
+}
+
+}}}
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <common/allocators/ChainedPool.h>
+
+#include <pex/PexDebugFunctionInfo.h>
+#include <pex/PexFile.h>
+#include <pex/PexFunction.h>
+#include <pex/PexInstruction.h>
+#include <pex/PexString.h>
+#include <pex/PexValue.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+struct PexOptBasicBlock;
+struct PexOptInstruction;
+
+// A dense set of variable ids.
+struct PexOptVarSet final {
+  void resize(size_t count) { bits.assign((count + 63) / 64, 0); }
+  void clear() { std::fill(bits.begin(), bits.end(), 0); }
+
+  bool contains(size_t id) const { return (bits[id >> 6] >> (id & 63)) & 1; }
+  void insert(size_t id) { bits[id >> 6] |= (uint64_t)1 << (id & 63); }
+  void erase(size_t id) { bits[id >> 6] &= ~((uint64_t)1 << (id & 63)); }
+
+  // Returns true if anything was added to this set.
+  bool unionWith(const PexOptVarSet& other) {
+    bool changed = false;
+    for (size_t i = 0; i < bits.size(); i++) {
+      auto n = bits[i] | other.bits[i];
+      changed |= n != bits[i];
+      bits[i] = n;
+    }
+    return changed;
+  }
+  void subtract(const PexOptVarSet& other) {
+    for (size_t i = 0; i < bits.size(); i++)
+      bits[i] &= ~other.bits[i];
+  }
+
+  template <typename F>
+  void forEach(F&& func) const {
+    for (size_t i = 0; i < bits.size(); i++) {
+      auto word = bits[i];
+      while (word) {
+        auto bit = (size_t)std::countr_zero(word);
+        func(i * 64 + bit);
+        word &= word - 1;
+      }
+    }
+  }
+
+  bool operator==(const PexOptVarSet& other) const { return bits == other.bits; }
+  bool operator!=(const PexOptVarSet& other) const { return bits != other.bits; }
+
+private:
+  std::vector<uint64_t> bits {};
+};
+
+enum class PexOptArgKind : uint8_t {
+  // Not a variable at all, eg. a function, property or type name.
+  Name,
+  Use,
+  Def,
+};
+
+// A parameter or local of the function being optimized. Anything else an
+// identifier can refer to (self, object variables, etc.) isn't tracked.
+struct PexOptVariable final {
+  size_t id { 0 };
+  PexString name {};
+  PexString type {};
+  bool isParameter { false };
+  // One of the ::temp locals allocated by the function builder.
+  bool isTemp { false };
+  std::vector<PexOptInstruction*> defs {};
+  std::vector<PexOptInstruction*> uses {};
+
+  explicit PexOptVariable() = default;
+  PexOptVariable(const PexOptVariable&) = delete;
+  ~PexOptVariable() = default;
+};
+
+struct PexOptInstruction final {
+  PexOpCode opCode { PexOpCode::Nop };
+  // The instructions the function started out with use its operand pool in
+  // place, anything added later gets its arguments from the optimizer's
+  // pool. Either way they stay put until the function is lowered.
+  std::span<PexValue> args {};
+  std::span<PexValue> variadicArgs {};
+  PexOptBasicBlock* block { nullptr };
+  // Only set for branches.
+  PexOptBasicBlock* branchTarget { nullptr };
+  uint16_t lineNumber { 0 };
+
+  explicit PexOptInstruction(PexOpCode op,
+                             std::span<PexValue> arguments,
+                             std::span<PexValue> varArguments,
+                             uint16_t line)
+      : opCode(op), args(arguments), variadicArgs(varArguments), lineNumber(line) { }
+  PexOptInstruction(const PexOptInstruction&) = delete;
+  ~PexOptInstruction() = default;
+
+  bool isBranch() const { return PexInstruction::isBranch(opCode); }
+  bool isDead() const { return dead; }
+
+  // The instruction is only actually removed once the pass that killed it
+  // has finished running.
+  void kill() {
+    dead = true;
+    branchTarget = nullptr;
+  }
+
+private:
+  bool dead { false };
+};
+
+struct PexOptBasicBlock final {
+  size_t id { 0 };
+  std::vector<PexOptInstruction*> instructions {};
+  std::vector<PexOptBasicBlock*> predecessors {};
+  std::vector<PexOptBasicBlock*> successors {};
+  PexOptVarSet liveIn {};
+  PexOptVarSet liveOut {};
+
+  explicit PexOptBasicBlock(size_t i) : id(i) { }
+  PexOptBasicBlock(const PexOptBasicBlock&) = delete;
+  ~PexOptBasicBlock() = default;
+
+  // The branch or return ending this block, if there is one.
+  PexOptInstruction* terminator() const;
+  // Whether control can reach the block laid out after this one.
+  bool fallsThrough() const;
+
+private:
+  friend struct PexOptFunction;
+  size_t loweredIndex { 0 };
+};
+
+// A function split into basic blocks, with the control-flow graph, use-def
+// chains and liveness built on demand.
+struct PexOptFunction final {
+  PexFile* file;
+  PexFunction* function;
+  PexDebugFunctionInfo* debugInfo;
+  // The blocks in the order they will be written. The last one is always an
+  // empty exit block, which is where branches to the end of the function go.
+  std::vector<PexOptBasicBlock*> blocks {};
+  std::vector<PexOptVariable*> variables {};
+
+  explicit PexOptFunction(allocators::ChainedPool* alloc,
+                          PexFile* file,
+                          PexFunction* function,
+                          PexDebugFunctionInfo* debInfo);
+  PexOptFunction(const PexOptFunction&) = delete;
+  ~PexOptFunction() = default;
+
+  PexOptBasicBlock* entryBlock() const { return blocks.front(); }
+  PexOptBasicBlock* exitBlock() const { return blocks.back(); }
+
+  // The new block is not part of the layout until it's inserted into blocks.
+  PexOptBasicBlock* createBlock();
+  // The new instruction is not part of the block until it's inserted into
+  // its instructions.
+  PexOptInstruction* createInstruction(PexOpCode op,
+                                       std::span<const PexValue> args,
+                                       std::span<const PexValue> variadicArgs,
+                                       PexOptBasicBlock* block,
+                                       uint16_t line);
+  PexOptInstruction*
+  createInstruction(PexOpCode op, std::initializer_list<PexValue> args, PexOptBasicBlock* block, uint16_t line) {
+    return createInstruction(op, std::span<const PexValue>(args.begin(), args.size()), {}, block, line);
+  }
+  // Turns the instruction into a different one. The arguments it had are
+  // left as they were.
+  void replaceInstruction(PexOptInstruction* o, PexOpCode op, std::initializer_list<PexValue> args);
+  // Adds a new temporary local of the given type to the function.
+  PexOptVariable* createTemp(const PexString& type);
+  // Moves the instructions from index onwards into a new block, laid out
+  // right after this one.
+  PexOptBasicBlock* splitBlock(PexOptBasicBlock* block, size_t index);
+
+  // Must be called by anything that changes the instructions or the layout,
+  // so that the analyses get rebuilt when they are next needed.
+  void invalidate() {
+    cfgValid = false;
+    dataFlowValid = false;
+  }
+  void ensureCFG();
+  // Builds the use-def chains and liveness, and the CFG if needed.
+  void ensureDataFlow();
+
+  PexOptVariable* tryGetVariable(const PexValue& val) const;
+  bool haveSameType(const PexOptVariable* a, const PexOptVariable* b) const;
+
+  static PexOptArgKind getArgKind(PexOpCode op, size_t argIndex);
+  // Whether a literal may be used in place of a variable for this argument.
+  // Call arguments always accept them.
+  static bool acceptsConstant(PexOpCode op, size_t argIndex);
+  static PexValue* tryGetDest(PexOptInstruction* o);
+  // Whether the only effect of the instruction is writing its destination.
+  // Anything that can call into script code or log an error at runtime, like
+  // property access or indexing an array, isn't.
+  static bool isPure(const PexOptInstruction* o);
+  template <typename F>
+  static void forEachUse(PexOptInstruction* o, F&& func) {
+    for (size_t i = 0; i < o->args.size(); i++) {
+      if (o->args[i].type == PexValueType::Identifier && getArgKind(o->opCode, i) == PexOptArgKind::Use)
+        func(o->args[i]);
+    }
+    if (!variadicArgsAreUses(o->opCode))
+      return;
+    for (auto& v : o->variadicArgs) {
+      if (v.type == PexValueType::Identifier)
+        func(v);
+    }
+  }
+
+  // Walks the block backwards, passing each instruction along with the set of
+  // variables that are live right after it. The callback may kill the
+  // instruction it was given, in which case its uses don't become live.
+  template <typename F>
+  void walkLiveness(PexOptBasicBlock* block, F&& func) {
+    ensureDataFlow();
+    PexOptVarSet live = block->liveOut;
+    for (size_t i = block->instructions.size(); i-- > 0;) {
+      auto o = block->instructions[i];
+      if (o->isDead())
+        continue;
+      func(o, (const PexOptVarSet&)live);
+      if (o->isDead())
+        continue;
+      if (auto dest = tryGetDest(o)) {
+        if (auto v = tryGetVariable(*dest))
+          live.erase(v->id);
+      }
+      forEachUse(o, [&](PexValue& val) {
+        if (auto v = tryGetVariable(val))
+          live.insert(v->id);
+      });
+    }
+  }
+
+  void removeDeadInstructions();
+  // Writes the instructions and line numbers back to the function, and drops
+  // any temporaries that are no longer referenced from its locals.
+  void lower();
+
+private:
+  allocators::ChainedPool* alloc;
+  std::unordered_map<size_t, PexOptVariable*> variableMap {};
+  size_t nextBlockID { 0 };
+  size_t nextTempID { 0 };
+  bool cfgValid { false };
+  bool dataFlowValid { false };
+
+  static bool variadicArgsAreUses(PexOpCode op) {
+    return op != PexOpCode::LockGuards && op != PexOpCode::UnlockGuards && op != PexOpCode::TryLockGuards;
+  }
+
+  std::span<PexValue> allocateArgs(std::span<const PexValue> args);
+  void buildBlocks();
+  void buildVariables();
+};
+
+}}}
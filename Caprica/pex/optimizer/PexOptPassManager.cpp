@@ -0,0 +1,41 @@
+#include <pex/optimizer/PexOptPassManager.h>
+
+#include <pex/optimizer/PexOptPasses.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+PexOptPassManager::PexOptPassManager() {
+  addPass({ "propagate-constants", propagateConstants });
+  addPass({ "hoist-loop-invariants", hoistLoopInvariants });
+  addPass({ "eliminate-common-subexpressions", eliminateCommonSubexpressions });
+  addPass({ "coalesce-copies", coalesceCopies });
+  addPass({ "propagate-copies", propagateCopies });
+  addPass({ "eliminate-dead-stores", eliminateDeadStores });
+  addPass({ "reuse-temps", reuseTemps });
+  addPass({ "remove-redundant-casts", removeRedundantCasts });
+  addPass({ "simplify-constant-branches", simplifyConstantBranches });
+  addPass({ "fuse-negated-branches", fuseNegatedBranches });
+  addPass({ "thread-jumps", threadJumps });
+  addPass({ "remove-unreachable-blocks", removeUnreachableBlocks });
+  addPass({ "merge-blocks", mergeBlocks });
+  addPass({ "recognize-array-searches", recognizeArraySearches });
+  addPass({ "remove-self-assignments", removeSelfAssignments });
+  addPass({ "remove-jumps-to-next", removeJumpsToNext });
+}
+
+void PexOptPassManager::run(PexOptFunction& func) const {
+  for (size_t round = 0; round < MaxRounds; round++) {
+    bool changed = false;
+    for (auto& pass : passes) {
+      if (pass.run(func)) {
+        func.removeDeadInstructions();
+        func.invalidate();
+        changed = true;
+      }
+    }
+    if (!changed)
+      return;
+  }
+}
+
+}}}
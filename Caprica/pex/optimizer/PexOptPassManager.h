@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include <pex/optimizer/PexOptFunction.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+struct PexOptPass final {
+  std::string_view name;
+  // Returns true if the function was changed.
+  bool (*run)(PexOptFunction& func);
+};
+
+struct PexOptPassManager final {
+  explicit PexOptPassManager();
+  PexOptPassManager(const PexOptPassManager&) = delete;
+  ~PexOptPassManager() = default;
+
+  void addPass(const PexOptPass& pass) { passes.push_back(pass); }
+
+  // Runs the passes in order, then starts over for as long as any of them
+  // still finds something to do.
+  void run(PexOptFunction& func) const;
+
+private:
+  // Passes can enable each other, but a function shouldn't need more rounds
+  // than this to settle.
+  static constexpr size_t MaxRounds = 8;
+
+  std::vector<PexOptPass> passes {};
+};
+
+}}}
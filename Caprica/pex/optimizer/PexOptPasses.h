@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pex/optimizer/PexOptFunction.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+// PexPeepholePasses.cpp
+bool removeSelfAssignments(PexOptFunction& func);
+bool removeRedundantCasts(PexOptFunction& func);
+bool removeJumpsToNext(PexOptFunction& func);
+
+// PexConstantPropagation.cpp
+bool propagateConstants(PexOptFunction& func);
+
+// PexCommonSubexpressionElimination.cpp
+bool eliminateCommonSubexpressions(PexOptFunction& func);
+
+// PexCopyPropagation.cpp
+bool propagateCopies(PexOptFunction& func);
+bool coalesceCopies(PexOptFunction& func);
+
+// PexDeadStoreElimination.cpp
+bool eliminateDeadStores(PexOptFunction& func);
+
+// PexLoopInvariantCodeMotion.cpp
+bool hoistLoopInvariants(PexOptFunction& func);
+
+// PexTempAllocation.cpp
+bool reuseTemps(PexOptFunction& func);
+
+// PexArraySearchIdioms.cpp
+bool recognizeArraySearches(PexOptFunction& func);
+
+// PexBranchPasses.cpp
+bool simplifyConstantBranches(PexOptFunction& func);
+bool fuseNegatedBranches(PexOptFunction& func);
+bool threadJumps(PexOptFunction& func);
+bool removeUnreachableBlocks(PexOptFunction& func);
+bool mergeBlocks(PexOptFunction& func);
+
+}}}
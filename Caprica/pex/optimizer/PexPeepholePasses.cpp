@@ -0,0 +1,56 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+bool removeSelfAssignments(PexOptFunction& func) {
+  bool changed = false;
+  for (auto b : func.blocks) {
+    for (auto o : b->instructions) {
+      if (!o->isDead() && o->opCode == PexOpCode::Assign && o->args[0] == o->args[1]) {
+        o->kill();
+        changed = true;
+      }
+    }
+  }
+  return changed;
+}
+
+// A cast between two variables of the same type is just a copy.
+bool removeRedundantCasts(PexOptFunction& func) {
+  bool changed = false;
+  for (auto b : func.blocks) {
+    for (auto o : b->instructions) {
+      if (o->isDead() || o->opCode != PexOpCode::Cast)
+        continue;
+      auto dest = func.tryGetVariable(o->args[0]);
+      auto src = func.tryGetVariable(o->args[1]);
+      if (dest && src && func.haveSameType(dest, src)) {
+        o->opCode = PexOpCode::Assign;
+        changed = true;
+      }
+    }
+  }
+  return changed;
+}
+
+bool removeJumpsToNext(PexOptFunction& func) {
+  bool changed = false;
+  for (size_t i = 0; i < func.blocks.size(); i++) {
+    auto term = func.blocks[i]->terminator();
+    if (!term || term->opCode != PexOpCode::Jmp)
+      continue;
+    // Only empty blocks may lie between the jump and its target.
+    for (size_t j = i + 1; j < func.blocks.size(); j++) {
+      if (func.blocks[j] == term->branchTarget) {
+        term->kill();
+        changed = true;
+        break;
+      }
+      if (!func.blocks[j]->instructions.empty())
+        break;
+    }
+  }
+  return changed;
+}
+
+}}}
@@ -0,0 +1,76 @@
+#include <pex/optimizer/PexOptPasses.h>
+
+#include <vector>
+
+namespace caprica { namespace pex { namespace optimizer {
+
+// The function builder hands out a fresh temporary for nearly every
+// intermediate value. This merges temporaries of the same type whose
+// lifetimes don't overlap, so that the unused ones can be dropped from the
+// function's locals when it's lowered.
+bool reuseTemps(PexOptFunction& func) {
+  const auto variableCount = func.variables.size();
+  std::vector<PexOptVarSet> interference(variableCount);
+  for (auto& s : interference)
+    s.resize(variableCount);
+
+  // A temporary interferes with everything that's live where it's written.
+  for (auto b : func.blocks) {
+    func.walkLiveness(b, [&](PexOptInstruction* o, const PexOptVarSet& live) {
+      auto destVal = PexOptFunction::tryGetDest(o);
+      if (!destVal)
+        return;
+      auto dest = func.tryGetVariable(*destVal);
+      if (!dest || !dest->isTemp)
+        return;
+      live.forEach([&](size_t id) {
+        if (id == dest->id)
+          return;
+        interference[dest->id].insert(id);
+        interference[id].insert(dest->id);
+      });
+    });
+  }
+
+  // Each temporary is merged into the first compatible one before it.
+  // Anything read before it's written relies on its default value, so can't
+  // share with anything else.
+  const auto& entryLive = func.entryBlock()->liveIn;
+  std::vector<PexOptVariable*> replacement(variableCount, nullptr);
+  std::vector<PexOptVariable*> representatives {};
+  bool changed = false;
+  for (auto v : func.variables) {
+    if (!v->isTemp || entryLive.contains(v->id) || (v->defs.empty() && v->uses.empty()))
+      continue;
+    for (auto r : representatives) {
+      if (!interference[r->id].contains(v->id) && func.haveSameType(r, v)) {
+        replacement[v->id] = r;
+        interference[r->id].unionWith(interference[v->id]);
+        changed = true;
+        break;
+      }
+    }
+    if (!replacement[v->id])
+      representatives.push_back(v);
+  }
+  if (!changed)
+    return false;
+
+  const auto rename = [&](PexValue& val) {
+    auto v = func.tryGetVariable(val);
+    if (v && replacement[v->id])
+      val = PexValue(PexValue::Identifier(replacement[v->id]->name));
+  };
+  for (auto b : func.blocks) {
+    for (auto o : b->instructions) {
+      if (o->isDead())
+        continue;
+      PexOptFunction::forEachUse(o, rename);
+      if (auto destVal = PexOptFunction::tryGetDest(o))
+        rename(*destVal);
+    }
+  }
+  return true;
+}
+
+}}}
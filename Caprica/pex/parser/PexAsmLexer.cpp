@@ -1,6 +1,7 @@
 #include <pex/parser/PexAsmLexer.h>
 
 #include <cctype>
+#include <charconv>
 #include <string_view>
 #include <unordered_map>
 
@@ -159,10 +160,10 @@ StartOver:
       return setTok(TokenType::EOL, baseLoc);
 
     case '.': {
-      std::ostringstream str;
+      auto start = strm;
       while (isalpha(peekChar()))
-        str.put(char(getChar()));
-      auto ident = str.str();
+        getChar();
+      auto ident = viewFrom(start);
       auto f = dotIdentifierMap.find(ident);
       if (f == dotIdentifierMap.end())
         reportingContext.fatal(baseLoc, "Unknown directive '.{}'!", ident);
@@ -180,16 +181,18 @@ StartOver:
     case '7':
     case '8':
     case '9': {
-      std::ostringstream str;
-      str.put(char(c));
+      auto start = strm - 1;
 
       // It's hex.
       if (c == '0' && peekChar() == 'x') {
-        str.put(char(getChar()));
+        getChar();
+        auto digits = strm;
         while (isxdigit(peekChar()))
-          str.put(char(getChar()));
+          getChar();
 
-        auto i = std::stoul(str.str(), nullptr, 16);
+        uint64_t i = 0;
+        if (std::from_chars(digits, strm, i, 16).ec != std::errc())
+          reportingContext.fatal(baseLoc, "Invalid hex integer '{}'!", viewFrom(start));
         auto tok = Token(TokenType::Integer, baseLoc);
         tok.iValue = (int32_t)i;
         return setTok(tok);
@@ -197,34 +200,37 @@ StartOver:
 
       // Either normal int or float.
       while (isdigit(peekChar()))
-        str.put(char(getChar()));
+        getChar();
 
       // It's a float.
       if (peekChar() == '.') {
-        str.put(char(getChar()));
+        getChar();
         while (isdigit(peekChar()))
-          str.put(char(getChar()));
+          getChar();
 
         // Allow e+ notation.
         if (peekChar() == 'e') {
-          str.put(char(getChar()));
+          getChar();
           if (getChar() != '+')
             reportingContext.fatal(location, "Unexpected character 'e'!");
-          str.put('+');
 
           while (isdigit(peekChar()))
-            str.put(char(getChar()));
+            getChar();
         }
 
-        auto f = std::stof(str.str());
+        float f = 0;
+        if (std::from_chars(start, strm, f).ec != std::errc())
+          reportingContext.fatal(baseLoc, "Invalid float '{}'!", viewFrom(start));
         auto tok = Token(TokenType::Float, baseLoc);
         tok.fValue = f;
         return setTok(tok);
       }
 
-      auto i = std::stoull(str.str());
+      int64_t i = 0;
+      if (std::from_chars(start, strm, i).ec != std::errc())
+        reportingContext.fatal(baseLoc, "Invalid integer '{}'!", viewFrom(start));
       auto tok = Token(TokenType::Integer, baseLoc);
-      tok.iValue = (int64_t)i;
+      tok.iValue = i;
       return setTok(tok);
     }
 
@@ -282,23 +288,22 @@ StartOver:
     case 'X':
     case 'Y':
     case 'Z': {
-      std::ostringstream str;
-      str.put(char(c));
+      auto start = strm - 1;
 
       // We allow the characters for types in this as well.
       while (isalnum(peekChar()) || peekChar() == '_' || peekChar() == ':' || peekChar() == '#' || peekChar() == '[' ||
              peekChar() == ']') {
-        str.put(char(getChar()));
+        getChar();
       }
 
-      auto ident = str.str();
       auto tok = Token(TokenType::Identifier, baseLoc);
-      tok.sValue = ident;
+      tok.sValue = viewFrom(start);
       return setTok(tok);
     }
 
     case '"': {
-      std::ostringstream str;
+      auto start = strm;
+      size_t charsRequired = 0;
 
       while (peekChar() != '"' && peekChar() != '\r' && peekChar() != '\n' && peekChar() != -1) {
         if (peekChar() == '\\') {
@@ -306,16 +311,9 @@ StartOver:
           auto escapeChar = getChar();
           switch (escapeChar) {
             case 'n':
-              str.put('\n');
-              break;
             case 't':
-              str.put('\t');
-              break;
             case '\\':
-              str.put('\\');
-              break;
             case '"':
-              str.put('"');
               break;
             case -1:
               reportingContext.fatal(location, "Unexpected EOF before the end of the string.");
@@ -323,16 +321,42 @@ StartOver:
               reportingContext.fatal(location, "Unrecognized escape sequence: '\\{}'", (char)escapeChar);
           }
         } else {
-          str.put(char(getChar()));
+          getChar();
         }
+        charsRequired++;
       }
+      auto str = viewFrom(start);
 
       if (peekChar() != '"')
         reportingContext.fatal(location, "Unclosed string!");
       getChar();
 
       auto tok = Token(TokenType::String, baseLoc);
-      tok.sValue = str.str();
+      if (charsRequired != str.size()) {
+        // Only strings with escape sequences need a copy.
+        auto buf = alloc.allocate(charsRequired);
+        for (size_t i = 0, i2 = 0; i < charsRequired; i++) {
+          if (str[i2] != '\\') {
+            buf[i] = str[i2++];
+            continue;
+          }
+          switch (str[i2 + 1]) {
+            case 'n':
+              buf[i] = '\n';
+              break;
+            case 't':
+              buf[i] = '\t';
+              break;
+            default:
+              buf[i] = str[i2 + 1];
+              break;
+          }
+          i2 += 2;
+        }
+        tok.sValue = std::string_view(buf, charsRequired);
+      } else {
+        tok.sValue = str;
+      }
       return setTok(tok);
     }
 
@@ -1,13 +1,17 @@
 #pragma once
 
 #include <cstring>
-#include <fstream>
 #include <functional>
-#include <sstream>
 #include <string>
+#include <string_view>
 
+#include <fmt/format.h>
+
+#include <common/allocators/ChainedPool.h>
 #include <common/CapricaFileLocation.h>
 #include <common/CapricaReportingContext.h>
+#include <common/CapricaStats.h>
+#include <common/UtilMacros.h>
 
 namespace caprica { namespace pex { namespace parser {
 
@@ -84,7 +88,9 @@ struct PexAsmLexer {
   struct Token final {
     TokenType type { TokenType::Unknown };
     CapricaFileLocation location {};
-    std::string sValue { "" };
+    // Either points into the file being lexed, or, for strings with escape
+    // sequences, into the lexer's pool.
+    std::string_view sValue {};
     int64_t iValue {};
     float fValue {};
 
@@ -95,19 +101,13 @@ struct PexAsmLexer {
     std::string prettyString() const {
       switch (type) {
         case TokenType::Identifier:
-          return "Identifier(" + sValue + ")";
+          return fmt::format("Identifier({})", sValue);
         case TokenType::String:
-          return "String(\"" + sValue + "\")";
-        case TokenType::Integer: {
-          std::ostringstream str;
-          str << "Integer(" << iValue << ")";
-          return str.str();
-        }
-        case TokenType::Float: {
-          std::ostringstream str;
-          str << "Float(" << fValue << ")";
-          return str.str();
-        }
+          return fmt::format("String(\"{}\")", sValue);
+        case TokenType::Integer:
+          return fmt::format("Integer({})", iValue);
+        case TokenType::Float:
+          return fmt::format("Float({})", fValue);
         default:
           return std::string(prettyTokenType(type));
       }
@@ -116,8 +116,11 @@ struct PexAsmLexer {
     static std::string_view prettyTokenType(TokenType tp);
   };
 
-  explicit PexAsmLexer(CapricaReportingContext& repCtx, const std::string& file)
-      : filename(file), strm(file, std::ifstream::binary), cur(TokenType::Unknown), reportingContext(repCtx) {
+  explicit PexAsmLexer(CapricaReportingContext& repCtx, const std::string& file, std::string_view data)
+      : reportingContext(repCtx), filename(file), cur(TokenType::Unknown) {
+    CapricaStats::lexedFilesCount++;
+    strm = data.data();
+    strmLen = data.size();
     consume(); // set the first token.
   }
   PexAsmLexer(const PexAsmLexer&) = delete;
@@ -131,14 +134,30 @@ protected:
   void consume();
 
 private:
-  std::ifstream strm;
+  const char* strm { nullptr };
+  size_t strmI { 0 };
+  size_t strmLen { 0 };
   CapricaFileLocation location {};
+  // Only used for strings that had to be unescaped.
+  allocators::ChainedPool alloc { 1024 * 4 };
 
+  ALWAYS_INLINE
   int getChar() {
+    if (strmI >= strmLen)
+      return -1;
     location.startOffset++;
-    return strm.get();
+    strmI++;
+    return (unsigned char)*strm++;
+  }
+
+  ALWAYS_INLINE
+  int peekChar() {
+    if (strmI >= strmLen)
+      return -1;
+    return (unsigned char)*strm;
   }
-  int peekChar() { return strm.peek(); }
+
+  std::string_view viewFrom(const char* start) const { return std::string_view(start, (size_t)(strm - start)); }
   void setTok(TokenType tp, CapricaFileLocation loc);
   void setTok(Token& tok);
 };
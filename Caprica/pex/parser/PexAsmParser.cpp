@@ -2,13 +2,23 @@
 
 #include <vector>
 
+#include <common/CapricaConfig.h>
 #include <common/CaselessStringComparer.h>
 
 namespace caprica { namespace pex { namespace parser {
 
+// Only the line numbers make it into the assembly, so a function with code
+// but no lines is one that never had debug info, like GetState in Skyrim.
+static bool hasDebugInfo(const PexFunction* func, const PexDebugFunctionInfo* debInf) {
+  return !debInf->instructionLineMap.empty() || func->instructions.empty();
+}
+
 PexFile* PexAsmParser::parseFile() {
   alloc = new allocators::ChainedPool(1024 * 4);
   auto file = alloc->make<PexFile>(alloc);
+  // The assembly doesn't record the version, so it's the one of the game
+  // being compiled for.
+  file->setGameAndVersion(conf::Papyrus::game);
 
   while (cur.type != TokenType::END) {
     switch (cur.type) {
@@ -240,7 +250,7 @@ PexFile* PexAsmParser::parseFile() {
                           debInf->objectName = obj->name;
                           debInf->functionName = prop->name;
                         }
-                        std::string funcName;
+                        std::string_view funcName;
                         auto func = parseFunction(file, debInf, funcName);
                         if (idEq(funcName, "get")) {
                           prop->isReadable = true;
@@ -258,7 +268,7 @@ PexFile* PexAsmParser::parseFile() {
                               "Unknown function definition in .property '{}'! Expected either 'get' or 'set'!",
                               funcName);
                         }
-                        if (debInf)
+                        if (debInf && hasDebugInfo(func, debInf))
                           file->debugInfo->functions.push_back(debInf);
                         break;
                       }
@@ -349,10 +359,10 @@ PexFile* PexAsmParser::parseFile() {
                       debInf->stateName = state->name;
                       debInf->objectName = obj->name;
                     }
-                    std::string funcName;
+                    std::string_view funcName;
                     auto func = parseFunction(file, debInf, funcName);
                     func->name = file->getString(funcName);
-                    if (debInf) {
+                    if (debInf && hasDebugInfo(func, debInf)) {
                       debInf->functionName = func->name;
                       file->debugInfo->functions.push_back(debInf);
                     }
@@ -379,17 +389,17 @@ PexFile* PexAsmParser::parseFile() {
   return file;
 }
 
-PexFunction* PexAsmParser::parseFunction(PexFile* file, PexDebugFunctionInfo* debInfo, std::string& funcNameOut) {
+PexFunction* PexAsmParser::parseFunction(PexFile* file, PexDebugFunctionInfo* debInfo, std::string_view& funcNameOut) {
   auto func = alloc->make<PexFunction>();
   funcNameOut = expectConsumeIdent();
   if (cur.type != TokenType::EOL) {
     auto id = expectConsumeIdent();
-    if (id == "native") {
+    if (idEq(id, "native")) {
       func->isNative = true;
       if (cur.type != TokenType::EOL)
         id = expectConsumeIdent();
     }
-    if (id == "static")
+    if (idEq(id, "static"))
       func->isGlobal = true;
   }
   expectConsumeEOL();
@@ -445,6 +455,13 @@ PexFunction* PexAsmParser::parseFunction(PexFile* file, PexDebugFunctionInfo* de
         expectConsumeEOL();
 
         caseless_unordered_identifier_map<PexLabel*> labels {};
+        // Indexed by the ids the values refer to them by.
+        std::vector<PexLabel*> labelsById {};
+        const auto newLabel = [&]() {
+          auto lab = new PexLabel((uint32_t)labelsById.size());
+          labelsById.push_back(lab);
+          return lab;
+        };
         while (!maybeConsumeTokEOL(TokenType::kEndCode)) {
           auto id = expectConsumeIdent();
           if (id[id.size() - 1] == ':') {
@@ -453,7 +470,7 @@ PexFunction* PexAsmParser::parseFunction(PexFile* file, PexDebugFunctionInfo* de
             if (f != labels.end()) {
               f->second->targetIdx = func->instructions.size();
             } else {
-              auto lab = new PexLabel();
+              auto lab = newLabel();
               lab->targetIdx = func->instructions.size();
               labels.emplace(id.substr(0, id.size() - 1), lab);
             }
@@ -466,8 +483,8 @@ PexFunction* PexAsmParser::parseFunction(PexFile* file, PexDebugFunctionInfo* de
               if (f != labels.end())
                 target = f->second;
               else
-                labels.emplace(labName, target = new PexLabel());
-              func->instructions.push_back(alloc->make<PexInstruction>(PexOpCode::Jmp, PexInstructionArgs { target }));
+                labels.emplace(labName, target = newLabel());
+              func->instructions.push_back(PexInstruction(func->operands, PexOpCode::Jmp, { target }));
             } else if (idEq(id, "jumpf")) {
               auto val = expectConsumeValue(file);
               PexLabel* target { nullptr };
@@ -476,9 +493,8 @@ PexFunction* PexAsmParser::parseFunction(PexFile* file, PexDebugFunctionInfo* de
               if (f != labels.end())
                 target = f->second;
               else
-                labels.emplace(labName, target = new PexLabel());
-              func->instructions.push_back(
-                  alloc->make<PexInstruction>(PexOpCode::JmpF, PexInstructionArgs { val, target }));
+                labels.emplace(labName, target = newLabel());
+              func->instructions.push_back(PexInstruction(func->operands, PexOpCode::JmpF, { val, target }));
             } else if (idEq(id, "jumpt")) {
               auto val = expectConsumeValue(file);
               PexLabel* target { nullptr };
@@ -487,47 +503,43 @@ PexFunction* PexAsmParser::parseFunction(PexFile* file, PexDebugFunctionInfo* de
               if (f != labels.end())
                 target = f->second;
               else
-                labels.emplace(labName, target = new PexLabel());
-              func->instructions.push_back(
-                  alloc->make<PexInstruction>(PexOpCode::JmpT, PexInstructionArgs { val, target }));
+                labels.emplace(labName, target = newLabel());
+              func->instructions.push_back(PexInstruction(func->operands, PexOpCode::JmpT, { val, target }));
             } else if (idEq(id, "callmethod")) {
               auto valA = expectConsumeValue(file);
               auto valB = expectConsumeValue(file);
               auto valC = expectConsumeValue(file);
-              IntrusiveLinkedList<IntrusivePexValue> params;
+              std::vector<PexValue> params;
               while (cur.type != TokenType::LineNumer && cur.type != TokenType::EOL && cur.type != TokenType::END)
-                params.push_back(alloc->make<IntrusivePexValue>(expectConsumeValue(file)));
-              func->instructions.push_back(alloc->make<PexInstruction>(PexOpCode::CallMethod,
-                                                                       PexInstructionArgs { valA, valB, valC },
-                                                                       std::move(params)));
+                params.push_back(expectConsumeValue(file));
+              func->instructions.push_back(
+                  PexInstruction(func->operands, PexOpCode::CallMethod, { valA, valB, valC }, params));
             } else if (idEq(id, "callparent")) {
               auto valA = expectConsumeValue(file);
               auto valB = expectConsumeValue(file);
-              IntrusiveLinkedList<IntrusivePexValue> params;
+              std::vector<PexValue> params;
               while (cur.type != TokenType::LineNumer && cur.type != TokenType::EOL && cur.type != TokenType::END)
-                params.push_back(alloc->make<IntrusivePexValue>(expectConsumeValue(file)));
-              func->instructions.push_back(alloc->make<PexInstruction>(PexOpCode::CallParent,
-                                                                       PexInstructionArgs { valA, valB },
-                                                                       std::move(params)));
+                params.push_back(expectConsumeValue(file));
+              func->instructions.push_back(
+                  PexInstruction(func->operands, PexOpCode::CallParent, { valA, valB }, params));
             } else if (idEq(id, "callstatic")) {
               auto valA = expectConsumeValue(file);
               auto valB = expectConsumeValue(file);
               auto valC = expectConsumeValue(file);
-              IntrusiveLinkedList<IntrusivePexValue> params;
+              std::vector<PexValue> params;
               while (cur.type != TokenType::LineNumer && cur.type != TokenType::EOL && cur.type != TokenType::END)
-                params.push_back(alloc->make<IntrusivePexValue>(expectConsumeValue(file)));
-              func->instructions.push_back(alloc->make<PexInstruction>(PexOpCode::CallStatic,
-                                                                       PexInstructionArgs { valA, valB, valC },
-                                                                       std::move(params)));
+                params.push_back(expectConsumeValue(file));
+              func->instructions.push_back(
+                  PexInstruction(func->operands, PexOpCode::CallStatic, { valA, valB, valC }, params));
             } else {
               auto op = PexInstruction::tryParseOpCode(id);
               if (op == PexOpCode::Invalid)
                 reportingContext.error(cur.location, "Unknown op-code '{}'!", id);
 
-              PexInstructionArgs params;
+              std::vector<PexValue> params;
               while (cur.type != TokenType::LineNumer && cur.type != TokenType::EOL && cur.type != TokenType::END)
-                params.emplace_back(expectConsumeValue(file));
-              func->instructions.push_back(alloc->make<PexInstruction>(op, std::move(params)));
+                params.push_back(expectConsumeValue(file));
+              func->instructions.push_back(PexInstruction(func->operands, op, params));
             }
 
             if (maybeConsume(TokenType::LineNumer)) {
@@ -547,12 +559,13 @@ PexFunction* PexAsmParser::parseFunction(PexFile* file, PexDebugFunctionInfo* de
           }
         }
 
-        for (auto curInstr = func->instructions.begin(), end = func->instructions.end(); curInstr != end; ++curInstr) {
-          for (auto& arg : curInstr->args) {
+        for (size_t i = 0; i < func->instructions.size(); i++) {
+          for (auto& arg : func->instructions[i].args(func->operands)) {
             if (arg.type == PexValueType::Label) {
-              if (arg.val.l->targetIdx == (size_t)-1)
+              auto lab = labelsById[arg.val.labelId];
+              if (lab->targetIdx == (size_t)-1)
                 CapricaReportingContext::logicalFatal("Unresolved label!");
-              auto newVal = arg.val.l->targetIdx - curInstr.index;
+              auto newVal = lab->targetIdx - i;
               arg.type = PexValueType::Integer;
               arg.val.i = (int32_t)newVal;
             }
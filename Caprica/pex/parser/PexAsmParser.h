@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <numeric>
 #include <string>
+#include <string_view>
 
 #include <common/allocators/ChainedPool.h>
 #include <common/CapricaReportingContext.h>
@@ -13,7 +14,8 @@
 namespace caprica { namespace pex { namespace parser {
 
 struct PexAsmParser final : private PexAsmLexer {
-  explicit PexAsmParser(CapricaReportingContext& repCtx, const std::string& file) : PexAsmLexer(repCtx, file) { }
+  explicit PexAsmParser(CapricaReportingContext& repCtx, const std::string& file, std::string_view data)
+      : PexAsmLexer(repCtx, file, data) { }
   PexAsmParser(const PexAsmParser&) = delete;
   ~PexAsmParser() = default;
 
@@ -21,7 +23,7 @@ struct PexAsmParser final : private PexAsmLexer {
 
 private:
   allocators::ChainedPool* alloc { nullptr };
-  PexFunction* parseFunction(PexFile* file, PexDebugFunctionInfo* debInfo, std::string& funcNameOut);
+  PexFunction* parseFunction(PexFile* file, PexDebugFunctionInfo* debInfo, std::string_view& funcNameOut);
 
   void expect(TokenType tp) {
     if (cur.type != tp) {
@@ -68,14 +70,14 @@ private:
 
   void expectConsumeEOL() { expectConsume(TokenType::EOL); }
 
-  std::string expectConsumeIdent() {
+  std::string_view expectConsumeIdent() {
     expect(TokenType::Identifier);
-    auto val = std::move(cur.sValue);
+    auto val = cur.sValue;
     consume();
     return val;
   }
 
-  std::string expectConsumeIdentEOL() {
+  std::string_view expectConsumeIdentEOL() {
     auto val = expectConsumeIdent();
     expectConsumeEOL();
     return val;
@@ -95,14 +97,14 @@ private:
     return val;
   }
 
-  std::string expectConsumeString() {
+  std::string_view expectConsumeString() {
     expect(TokenType::String);
-    auto val = std::move(cur.sValue);
+    auto val = cur.sValue;
     consume();
     return val;
   }
 
-  std::string expectConsumeStringEOL() {
+  std::string_view expectConsumeStringEOL() {
     auto val = expectConsumeString();
     expectConsumeEOL();
     return val;
@@ -115,7 +117,7 @@ private:
   int32_t expectConsumeInteger() {
     expect(TokenType::Integer);
     auto val = cur.iValue;
-    if (val >= std::numeric_limits<int32_t>::max() || val <= std::numeric_limits<int32_t>::min())
+    if (val > std::numeric_limits<int32_t>::max() || val < std::numeric_limits<int32_t>::min())
       reportingContext.fatal(cur.location, "Integer value '{}' outside of the range of 32-bits!", val);
     consume();
     return (int32_t)val;
@@ -0,0 +1,760 @@
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <common/allocators/ChainedPool.h>
+#include <common/CaselessStringComparer.h>
+#include <common/CapricaConfig.h>
+#include <common/CapricaReportingContext.h>
+#include <common/GameID.h>
+
+#include <pex/optimizer/PexOptFunction.h>
+#include <pex/optimizer/PexOptPasses.h>
+#include <pex/parser/PexAsmParser.h>
+#include <pex/PexFile.h>
+#include <pex/PexFunction.h>
+#include <pex/PexInstruction.h>
+#include <pex/PexReader.h>
+#include <pex/PexValue.h>
+
+// Checks the optimizer against the Papyrus it is meant to preserve the
+// behaviour of.
+//
+//   CapricaTests passes
+//     Runs each branch pass on its own over small functions, checking the
+//     instructions it leaves behind, and that the function still returns
+//     the same thing for every input while running no more instructions.
+//   CapricaTests scripts <plain.pex> <optimized.pex>
+//     Runs every global function of a script compiled without and with -O
+//     over a set of inputs, checking that both give the same results, and
+//     that the optimized one runs fewer instructions overall.
+
+using namespace caprica;
+using namespace caprica::pex;
+
+namespace {
+
+// Just enough of the Papyrus VM to run functions that only do arithmetic,
+// comparisons, branches and arrays.
+struct Value final {
+  PexValueType type { PexValueType::None };
+  int32_t i { 0 };
+  float f { 0 };
+  bool b { false };
+  std::shared_ptr<std::vector<Value>> arr {};
+
+  static Value Int(int32_t v) {
+    Value ret;
+    ret.type = PexValueType::Integer;
+    ret.i = v;
+    return ret;
+  }
+  static Value Float(float v) {
+    Value ret;
+    ret.type = PexValueType::Float;
+    ret.f = v;
+    return ret;
+  }
+  static Value Bool(bool v) {
+    Value ret;
+    ret.type = PexValueType::Bool;
+    ret.b = v;
+    return ret;
+  }
+
+  bool isNumber() const { return type == PexValueType::Integer || type == PexValueType::Float; }
+  float asFloat() const { return type == PexValueType::Float ? f : (float)i; }
+
+  bool truthy() const {
+    switch (type) {
+      case PexValueType::Integer:
+        return i != 0;
+      case PexValueType::Float:
+        return f != 0;
+      case PexValueType::Bool:
+        return b;
+      case PexValueType::Identifier:
+        return arr != nullptr;
+      default:
+        return false;
+    }
+  }
+
+  std::string toString() const {
+    std::ostringstream str;
+    switch (type) {
+      case PexValueType::Integer:
+        str << "Int " << i;
+        break;
+      case PexValueType::Float:
+        str << "Float " << f;
+        break;
+      case PexValueType::Bool:
+        str << "Bool " << (b ? "True" : "False");
+        break;
+      case PexValueType::Identifier:
+        str << "[";
+        for (size_t n = 0; arr && n < arr->size(); n++)
+          str << (n ? ", " : "") << (*arr)[n].toString();
+        str << "]";
+        break;
+      default:
+        str << "None";
+        break;
+    }
+    return str.str();
+  }
+};
+
+struct RunResult final {
+  std::string value {};
+  size_t executedCount { 0 };
+};
+
+// Papyrus logs an error and carries on for most of these, which no test
+// relies on, so they just stop the run. Anything the interpreter can't run
+// is a std::runtime_error instead, and fails the test, so that it can't make
+// two versions of a function look the same.
+struct VMError final : public std::exception {
+  std::string message;
+  explicit VMError(std::string msg) : message(std::move(msg)) { }
+  const char* what() const noexcept override { return message.c_str(); }
+};
+
+struct Interpreter final {
+  // Generous enough for every test, while still catching a loop that the
+  // optimizer made infinite.
+  static constexpr size_t MaxExecutedCount = 1000000;
+
+  explicit Interpreter(const PexFile* f, const PexFunction* fn) : file(f), func(fn) { }
+
+  RunResult run(const std::vector<int32_t>& args) {
+    vars.clear();
+    types.clear();
+    size_t argIndex = 0;
+    for (auto p : func->parameters) {
+      types.emplace(p->name.index, file->getStringValue(p->type).to_string_view());
+      vars.emplace(p->name.index, Value::Int(args.at(argIndex++)));
+    }
+    for (auto l : func->locals) {
+      auto type = file->getStringValue(l->type).to_string_view();
+      types.emplace(l->name.index, type);
+      vars.emplace(l->name.index, defaultValue(type));
+    }
+
+    RunResult result {};
+    size_t pc = 0;
+    while (pc < func->instructions.size()) {
+      if (++result.executedCount > MaxExecutedCount)
+        throw VMError("The function never returned.");
+      auto& instr = func->instructions[pc];
+      auto args = instr.args(func->operands);
+      if (instr.isBranch()) {
+        bool taken = instr.opCode == PexOpCode::Jmp || get(args[0]).truthy() == (instr.opCode == PexOpCode::JmpT);
+        pc += taken ? instr.branchTarget(func->operands) : 1;
+        continue;
+      }
+      if (instr.opCode == PexOpCode::Return) {
+        result.value = get(args[0]).toString();
+        return result;
+      }
+      execute(instr.opCode, args);
+      pc++;
+    }
+    result.value = Value().toString();
+    return result;
+  }
+
+private:
+  const PexFile* file;
+  const PexFunction* func;
+  std::unordered_map<uint32_t, Value> vars {};
+  std::unordered_map<uint32_t, std::string_view> types {};
+
+  static Value defaultValue(std::string_view type) {
+    if (idEq(type, "Int"))
+      return Value::Int(0);
+    if (idEq(type, "Float"))
+      return Value::Float(0);
+    if (idEq(type, "Bool"))
+      return Value::Bool(false);
+    return Value();
+  }
+
+  Value get(const PexValue& val) const {
+    switch (val.type) {
+      case PexValueType::Identifier: {
+        auto v = vars.find(val.val.s.index);
+        if (v == vars.end())
+          throw std::runtime_error("Unknown variable '" + file->getStringValue(val.val.s).to_string() + "'.");
+        return v->second;
+      }
+      case PexValueType::Integer:
+        return Value::Int(val.val.i);
+      case PexValueType::Float:
+        return Value::Float(val.val.f);
+      case PexValueType::Bool:
+        return Value::Bool(val.val.b);
+      case PexValueType::None:
+        return Value();
+      default:
+        throw std::runtime_error("Unsupported operand.");
+    }
+  }
+
+  void set(const PexValue& dest, Value val) {
+    if (dest.type != PexValueType::Identifier || !vars.count(dest.val.s.index))
+      throw std::runtime_error("Invalid destination.");
+    vars[dest.val.s.index] = std::move(val);
+  }
+
+  std::vector<Value>& getArray(const PexValue& val) const {
+    auto v = get(val);
+    if (v.type != PexValueType::Identifier || !v.arr)
+      throw std::runtime_error("Not an array.");
+    return *v.arr;
+  }
+
+  static int32_t getIndex(const std::vector<Value>& arr, const Value& index) {
+    if (index.type != PexValueType::Integer || index.i < 0 || (size_t)index.i >= arr.size())
+      throw VMError("Array index out of range.");
+    return index.i;
+  }
+
+  static bool equal(const Value& a, const Value& b) {
+    if (a.isNumber() && b.isNumber())
+      return a.type == PexValueType::Integer && b.type == PexValueType::Integer ? a.i == b.i
+                                                                                : a.asFloat() == b.asFloat();
+    if (a.type != b.type)
+      return false;
+    if (a.type == PexValueType::Bool)
+      return a.b == b.b;
+    return a.arr == b.arr;
+  }
+
+  static int compare(const Value& a, const Value& b) {
+    if (!a.isNumber() || !b.isNumber())
+      throw std::runtime_error("Only numbers can be ordered.");
+    if (a.type == PexValueType::Integer && b.type == PexValueType::Integer)
+      return a.i < b.i ? -1 : a.i > b.i;
+    return a.asFloat() < b.asFloat() ? -1 : a.asFloat() > b.asFloat();
+  }
+
+  Value cast(const Value& val, std::string_view type) const {
+    if (idEq(type, "Int")) {
+      if (val.type == PexValueType::Float)
+        return Value::Int((int32_t)val.f);
+      if (val.type == PexValueType::Bool)
+        return Value::Int(val.b);
+      if (val.type == PexValueType::Integer)
+        return val;
+    } else if (idEq(type, "Float")) {
+      if (val.isNumber())
+        return Value::Float(val.asFloat());
+      if (val.type == PexValueType::Bool)
+        return Value::Float(val.b);
+    } else if (idEq(type, "Bool")) {
+      return Value::Bool(val.truthy());
+    }
+    throw std::runtime_error("Unsupported cast to '" + std::string(type) + "'.");
+  }
+
+  void execute(PexOpCode op, std::span<const PexValue> args) {
+    const auto intOp = [&](auto f) {
+      auto a = get(args[1]), b = get(args[2]);
+      if (a.type != PexValueType::Integer || b.type != PexValueType::Integer)
+        throw std::runtime_error("Integer operands expected.");
+      set(args[0], Value::Int((int32_t)f((uint32_t)a.i, (uint32_t)b.i, a.i, b.i)));
+    };
+    const auto floatOp = [&](auto f) { set(args[0], Value::Float(f(get(args[1]).asFloat(), get(args[2]).asFloat()))); };
+
+    switch (op) {
+      case PexOpCode::Nop:
+        return;
+      case PexOpCode::Assign:
+        return set(args[0], get(args[1]));
+      case PexOpCode::Cast:
+        return set(args[0], cast(get(args[1]), types.at(args[0].val.s.index)));
+      case PexOpCode::Not:
+        return set(args[0], Value::Bool(!get(args[1]).truthy()));
+      case PexOpCode::INeg:
+        return set(args[0], Value::Int((int32_t)(0u - (uint32_t)get(args[1]).i)));
+      case PexOpCode::FNeg:
+        return set(args[0], Value::Float(-get(args[1]).asFloat()));
+      case PexOpCode::IAdd:
+        return intOp([](uint32_t a, uint32_t b, int32_t, int32_t) { return a + b; });
+      case PexOpCode::ISub:
+        return intOp([](uint32_t a, uint32_t b, int32_t, int32_t) { return a - b; });
+      case PexOpCode::IMul:
+        return intOp([](uint32_t a, uint32_t b, int32_t, int32_t) { return a * b; });
+      case PexOpCode::IDiv:
+        return intOp([](uint32_t, uint32_t, int32_t a, int32_t b) {
+          if (b == 0)
+            throw VMError("Divide by zero.");
+          return (uint32_t)(a / b);
+        });
+      case PexOpCode::IMod:
+        return intOp([](uint32_t, uint32_t, int32_t a, int32_t b) {
+          if (b == 0)
+            throw VMError("Divide by zero.");
+          return (uint32_t)(a % b);
+        });
+      case PexOpCode::FAdd:
+        return floatOp([](float a, float b) { return a + b; });
+      case PexOpCode::FSub:
+        return floatOp([](float a, float b) { return a - b; });
+      case PexOpCode::FMul:
+        return floatOp([](float a, float b) { return a * b; });
+      case PexOpCode::FDiv:
+        return floatOp([](float a, float b) { return a / b; });
+      case PexOpCode::CmpEq:
+        return set(args[0], Value::Bool(equal(get(args[1]), get(args[2]))));
+      case PexOpCode::CmpLt:
+        return set(args[0], Value::Bool(compare(get(args[1]), get(args[2])) < 0));
+      case PexOpCode::CmpLte:
+        return set(args[0], Value::Bool(compare(get(args[1]), get(args[2])) <= 0));
+      case PexOpCode::CmpGt:
+        return set(args[0], Value::Bool(compare(get(args[1]), get(args[2])) > 0));
+      case PexOpCode::CmpGte:
+        return set(args[0], Value::Bool(compare(get(args[1]), get(args[2])) >= 0));
+      case PexOpCode::ArrayCreate: {
+        auto size = get(args[1]);
+        if (size.type != PexValueType::Integer || size.i < 0)
+          throw VMError("Invalid array size.");
+        auto type = types.at(args[0].val.s.index);
+        Value arr;
+        arr.type = PexValueType::Identifier;
+        arr.arr = std::make_shared<std::vector<Value>>(size.i, defaultValue(type.substr(0, type.size() - 2)));
+        return set(args[0], arr);
+      }
+      case PexOpCode::ArrayLength:
+        return set(args[0], Value::Int((int32_t)getArray(args[1]).size()));
+      case PexOpCode::ArrayGetElement: {
+        auto& arr = getArray(args[1]);
+        return set(args[0], arr[getIndex(arr, get(args[2]))]);
+      }
+      case PexOpCode::ArraySetElement: {
+        auto& arr = getArray(args[0]);
+        arr[getIndex(arr, get(args[1]))] = get(args[2]);
+        return;
+      }
+      case PexOpCode::ArrayFindElement:
+      case PexOpCode::ArrayRFindElement: {
+        auto& arr = getArray(args[0]);
+        auto value = get(args[2]);
+        auto start = get(args[3]).i;
+        int32_t found = -1;
+        if (op == PexOpCode::ArrayFindElement) {
+          for (int32_t n = std::max(start, 0); n < (int32_t)arr.size() && found < 0; n++) {
+            if (equal(arr[n], value))
+              found = n;
+          }
+        } else {
+          for (int32_t n = start < 0 ? (int32_t)arr.size() - 1 : start; n >= 0 && found < 0; n--) {
+            if (n < (int32_t)arr.size() && equal(arr[n], value))
+              found = n;
+          }
+        }
+        return set(args[1], Value::Int(found));
+      }
+      default:
+        throw std::runtime_error("Unsupported opcode " + std::string(PexInstruction::opCodeToPexAsm(op)) + ".");
+    }
+  }
+};
+
+std::string formatInstruction(const PexFile* file, const PexFunction* func, const PexInstruction& instr) {
+  std::ostringstream str;
+  str << PexInstruction::opCodeToPexAsm(instr.opCode);
+  for (auto& a : instr.args(func->operands)) {
+    str << " ";
+    switch (a.type) {
+      case PexValueType::Identifier:
+        str << file->getStringValue(a.val.s).to_string_view();
+        break;
+      case PexValueType::Integer:
+        str << a.val.i;
+        break;
+      case PexValueType::Float:
+        str << a.val.f;
+        break;
+      case PexValueType::Bool:
+        str << (a.val.b ? "True" : "False");
+        break;
+      default:
+        str << "None";
+        break;
+    }
+  }
+  return str.str();
+}
+
+std::string joinParams(const std::vector<int32_t>& args) {
+  std::string ret {};
+  for (auto a : args)
+    ret += (ret.empty() ? "" : ", ") + std::to_string(a);
+  return "(" + ret + ")";
+}
+
+// Every combination of a few interesting values, for each parameter.
+std::vector<std::vector<int32_t>> makeInputs(size_t paramCount) {
+  static constexpr int32_t values[] = { -7, -1, 0, 1, 2, 5, 12 };
+  std::vector<std::vector<int32_t>> inputs { {} };
+  for (size_t p = 0; p < paramCount; p++) {
+    std::vector<std::vector<int32_t>> next {};
+    for (auto& in : inputs) {
+      for (auto v : values) {
+        next.push_back(in);
+        next.back().push_back(v);
+      }
+    }
+    inputs = std::move(next);
+  }
+  return inputs;
+}
+
+std::vector<RunResult> runAll(const PexFile* file, const PexFunction* func) {
+  std::vector<RunResult> results {};
+  Interpreter interp { file, func };
+  for (auto& in : makeInputs(func->parameters.size())) {
+    try {
+      results.push_back(interp.run(in));
+    } catch (const VMError& e) {
+      results.push_back({ std::string("Error: ") + e.what(), 0 });
+    }
+  }
+  return results;
+}
+
+struct PassTest final {
+  std::string_view name;
+  bool (*pass)(optimizer::PexOptFunction& func);
+  std::string_view returnType;
+  std::vector<std::string_view> params;
+  std::vector<std::string_view> locals;
+  std::string_view code;
+  std::vector<std::string_view> expected;
+};
+
+// Wraps the code up as the only function of a script, so that it can go
+// through the assembly parser.
+std::string makeAssembly(const PassTest& test) {
+  std::ostringstream str;
+  str << ".info\n.source \"PassTest.psc\"\n.modifyTime 0\n.compileTime 0\n.user \"\"\n.computer \"\"\n.endInfo\n"
+      << ".userFlagsRef\n.endUserFlagsRef\n.objectTable\n.object PassTest\n.userFlags 0\n.docString \"\"\n"
+      << ".autoState\n.variableTable\n.endVariableTable\n.propertyTable\n.endPropertyTable\n.stateTable\n.state\n"
+      << ".function Test static\n.userFlags 0\n.docString \"\"\n.return " << test.returnType << "\n.paramTable\n";
+  for (auto p : test.params)
+    str << ".param " << p << "\n";
+  str << ".endParamTable\n.localTable\n";
+  for (auto l : test.locals)
+    str << ".local " << l << "\n";
+  str << ".endLocalTable\n.code\n";
+  // The parser doesn't allow blank lines in the code.
+  std::istringstream code { std::string(test.code) };
+  for (std::string line; std::getline(code, line);) {
+    if (line.find_first_not_of(' ') != std::string::npos)
+      str << line << "\n";
+  }
+  str << ".endCode\n.endFunction\n.endState\n.endStateTable\n.endObject\n.endObjectTable\n";
+  return str.str();
+}
+
+const std::vector<PassTest>& getPassTests() {
+  static const std::vector<PassTest> tests {
+    {
+        "simplify-constant-branches",
+        optimizer::simplifyConstantBranches,
+        "Int",
+        { "a Int" },
+        {},
+        R"(
+          JUMPF True label0
+          IADD a a 1
+          label0:
+          JUMPT 0 label1
+          IMULTIPLY a a 2
+          label1:
+          JUMPT 1 label2
+          RETURN 0
+          label2:
+          RETURN a
+        )",
+        { "IADD a a 1", "IMULTIPLY a a 2", "JUMP 2", "RETURN 0", "RETURN a" },
+    },
+    {
+        "fuse-negated-branches",
+        optimizer::fuseNegatedBranches,
+        "Int",
+        { "a Int" },
+        { "::temp0 Bool", "::temp1 Bool" },
+        R"(
+          COMPAREGT ::temp0 a 0
+          NOT ::temp1 ::temp0
+          JUMPF ::temp1 label0
+          RETURN 1
+          label0:
+          RETURN 2
+        )",
+        { "COMPAREGT ::temp0 a 0", "NOT ::temp1 ::temp0", "JUMPT ::temp0 2", "RETURN 1", "RETURN 2" },
+    },
+    {
+        // The NOT can only go away along with the value it overwrites.
+        "fuse-negated-branches",
+        optimizer::fuseNegatedBranches,
+        "Int",
+        { "a Int" },
+        { "::temp0 Bool" },
+        R"(
+          COMPARELT ::temp0 a 5
+          NOT ::temp0 ::temp0
+          JUMPT ::temp0 label0
+          RETURN 1
+          label0:
+          RETURN 2
+        )",
+        { "COMPARELT ::temp0 a 5", "JUMPF ::temp0 2", "RETURN 1", "RETURN 2" },
+    },
+    {
+        "thread-jumps",
+        optimizer::threadJumps,
+        "Int",
+        { "a Int" },
+        { "::temp0 Bool" },
+        R"(
+          COMPAREGT ::temp0 a 0
+          JUMPF ::temp0 label0
+          IADD a a 10
+          JUMP label1
+          label0:
+          JUMP label2
+          label1:
+          IMULTIPLY a a 2
+          label2:
+          RETURN a
+        )",
+        { "COMPAREGT ::temp0 a 0", "JUMPF ::temp0 5", "IADD a a 10", "JUMP 2", "JUMP 2", "IMULTIPLY a a 2", "RETURN a" },
+    },
+    {
+        // A branch on a condition that was just tested goes the same way.
+        "thread-jumps",
+        optimizer::threadJumps,
+        "Int",
+        { "a Int" },
+        { "::temp0 Bool" },
+        R"(
+          COMPAREGT ::temp0 a 0
+          JUMPT ::temp0 label0
+          IADD a a 1
+          label0:
+          JUMPT ::temp0 label1
+          IMULTIPLY a a 3
+          label1:
+          RETURN a
+        )",
+        { "COMPAREGT ::temp0 a 0", "JUMPT ::temp0 4", "IADD a a 1", "JUMPT ::temp0 2", "IMULTIPLY a a 3", "RETURN a" },
+    },
+    {
+        "remove-unreachable-blocks",
+        optimizer::removeUnreachableBlocks,
+        "Int",
+        { "a Int" },
+        {},
+        R"(
+          IADD a a 1
+          JUMP label0
+          IMULTIPLY a a 100
+          ISUBTRACT a a 3
+          label0:
+          RETURN a
+        )",
+        { "IADD a a 1", "JUMP 1", "RETURN a" },
+    },
+    {
+        "merge-blocks",
+        optimizer::mergeBlocks,
+        "Int",
+        { "a Int" },
+        { "::temp0 Bool" },
+        R"(
+          COMPAREGT ::temp0 a 0
+          JUMPT ::temp0 label0
+          label0:
+          IADD a a 1
+          RETURN a
+        )",
+        { "COMPAREGT ::temp0 a 0", "IADD a a 1", "RETURN a" },
+    },
+    {
+        "remove-redundant-casts",
+        optimizer::removeRedundantCasts,
+        "Float",
+        { "a Int" },
+        { "b Int", "f Float" },
+        R"(
+          CAST b a
+          CAST f b
+          RETURN f
+        )",
+        { "ASSIGN b a", "CAST f b", "RETURN f" },
+    },
+  };
+  return tests;
+}
+
+bool runPassTest(const PassTest& test) {
+  CapricaReportingContext repCtx { "PassTest.pas" };
+  auto assembly = makeAssembly(test);
+  parser::PexAsmParser parser { repCtx, "PassTest.pas", assembly };
+  auto file = parser.parseFile();
+  auto function = file->objects.front()->states.front()->functions.front();
+
+  auto before = runAll(file, function);
+  bool changed;
+  {
+    allocators::ChainedPool alloc { 1024 * 4 };
+    optimizer::PexOptFunction func { &alloc, file, function, nullptr };
+    changed = test.pass(func);
+    func.lower();
+  }
+  auto after = runAll(file, function);
+
+  bool ok = true;
+  const auto fail = [&](const std::string& msg) {
+    std::cout << "FAIL " << test.name << ": " << msg << std::endl;
+    ok = false;
+  };
+  if (!changed)
+    fail("the pass didn't change anything");
+
+  std::vector<std::string> actual {};
+  for (auto& instr : function->instructions)
+    actual.push_back(formatInstruction(file, function, instr));
+  if (actual.size() != test.expected.size() || !std::equal(actual.begin(), actual.end(), test.expected.begin())) {
+    std::string msg = "expected";
+    for (auto e : test.expected)
+      msg += "\n    " + std::string(e);
+    msg += "\n  got";
+    for (auto& a : actual)
+      msg += "\n    " + a;
+    fail(msg);
+  }
+
+  auto inputs = makeInputs(function->parameters.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (before[i].value != after[i].value) {
+      fail("Test" + joinParams(inputs[i]) + " returned " + after[i].value + " instead of " + before[i].value);
+    } else if (after[i].executedCount > before[i].executedCount) {
+      fail("Test" + joinParams(inputs[i]) + " ran " + std::to_string(after[i].executedCount) +
+           " instructions instead of " + std::to_string(before[i].executedCount));
+    }
+  }
+  if (ok)
+    std::cout << "OK   " << test.name << std::endl;
+  return ok;
+}
+
+int runPassTests() {
+  int failed = 0;
+  for (auto& test : getPassTests()) {
+    if (!runPassTest(test))
+      failed++;
+  }
+  return failed ? 1 : 0;
+}
+
+PexFile* readPex(allocators::ChainedPool* alloc, const std::string& path) {
+  PexReader rdr { path };
+  return PexFile::read(alloc, rdr);
+}
+
+int runScriptTest(const std::string& plainPath, const std::string& optimizedPath) {
+  allocators::ChainedPool alloc { 1024 * 16 };
+  auto plain = readPex(&alloc, plainPath);
+  auto optimized = readPex(&alloc, optimizedPath);
+
+  std::unordered_map<std::string, const PexFunction*> optimizedFunctions {};
+  for (auto o : optimized->objects) {
+    for (auto s : o->states) {
+      for (auto f : s->functions)
+        optimizedFunctions.emplace(optimized->getStringValue(f->name).to_string(), f);
+    }
+  }
+
+  bool ok = true;
+  size_t plainTotal = 0;
+  size_t optimizedTotal = 0;
+  for (auto o : plain->objects) {
+    for (auto s : o->states) {
+      for (auto f : s->functions) {
+        if (!f->isGlobal || f->isNative)
+          continue;
+        auto name = plain->getStringValue(f->name).to_string();
+        auto opt = optimizedFunctions.find(name);
+        if (opt == optimizedFunctions.end()) {
+          std::cout << "FAIL " << name << ": missing from the optimized script" << std::endl;
+          ok = false;
+          continue;
+        }
+
+        auto before = runAll(plain, f);
+        auto after = runAll(optimized, opt->second);
+        auto inputs = makeInputs(f->parameters.size());
+        size_t plainCount = 0;
+        size_t optimizedCount = 0;
+        bool funcOk = true;
+        for (size_t i = 0; i < inputs.size(); i++) {
+          plainCount += before[i].executedCount;
+          optimizedCount += after[i].executedCount;
+          if (before[i].value != after[i].value) {
+            std::cout << "FAIL " << name << joinParams(inputs[i]) << " returned " << after[i].value
+                      << " instead of " << before[i].value << std::endl;
+            funcOk = false;
+          }
+        }
+        if (optimizedCount > plainCount) {
+          std::cout << "FAIL " << name << " ran " << optimizedCount << " instructions instead of " << plainCount
+                    << std::endl;
+          funcOk = false;
+        }
+        if (funcOk)
+          std::cout << "OK   " << name << ": " << plainCount << " -> " << optimizedCount << " instructions" << std::endl;
+        ok = ok && funcOk;
+        plainTotal += plainCount;
+        optimizedTotal += optimizedCount;
+      }
+    }
+  }
+  if (optimizedTotal >= plainTotal) {
+    std::cout << "FAIL the optimized script ran " << optimizedTotal << " instructions, and the plain one "
+              << plainTotal << std::endl;
+    ok = false;
+  }
+  return ok ? 0 : 1;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+  conf::Papyrus::game = GameID::Skyrim;
+  try {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "passes" && argc == 2)
+      return runPassTests();
+    if (mode == "scripts" && argc == 4)
+      return runScriptTest(argv[2], argv[3]);
+  } catch (const std::exception& e) {
+    std::cout << "FAIL " << e.what() << std::endl;
+    return 1;
+  }
+  std::cout << "Usage: CapricaTests passes" << std::endl;
+  std::cout << "       CapricaTests scripts <plain.pex> <optimized.pex>" << std::endl;
+  return 2;
+}
@@ -0,0 +1,35 @@
+# Compiles the optimizer test scripts with and without -O, and has
+# CapricaTests check that both versions of each script behave the same.
+file(GLOB scripts "${SCRIPTS_DIR}/Optimizer*.psc")
+file(REMOVE_RECURSE "${OUTPUT_DIR}")
+
+set(flags -g skyrim --ignorecwd -f "${SCRIPTS_DIR}/TESV_Papyrus_Flags.flg")
+execute_process(COMMAND "${CAPRICA}" ${flags} ${scripts} -o "${OUTPUT_DIR}/plain" RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "Compiling the scripts failed!")
+endif()
+# Only Fallout 4 gets optimized without forcing it, and compiling for it
+# would need its base scripts.
+execute_process(
+  COMMAND "${CAPRICA}" ${flags} -O --force-enable-optimizations ${scripts} -o "${OUTPUT_DIR}/optimized"
+  RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "Compiling the scripts with -O failed!")
+endif()
+
+set(failed FALSE)
+foreach (script ${scripts})
+  get_filename_component(name "${script}" NAME_WE)
+  execute_process(
+    COMMAND "${CAPRICA_TESTS}" scripts "${OUTPUT_DIR}/plain/${name}.pex" "${OUTPUT_DIR}/optimized/${name}.pex"
+    RESULT_VARIABLE result
+  )
+  if (NOT result EQUAL 0)
+    message(SEND_ERROR "${name} behaves differently when optimized!")
+    set(failed TRUE)
+  endif()
+endforeach()
+if (failed)
+  message(FATAL_ERROR "The optimized scripts don't match.")
+endif()
@@ -0,0 +1,38 @@
+# Compiles RoundTrip.psc, disassembles it and assembles the result again,
+# twice over. The assembly doesn't record the order of the string table, so
+# the compiled file can only be matched in size; from the first reassembly
+# on, the bytes and the assembly have to stay exactly the same.
+file(REMOVE_RECURSE "${OUTPUT_DIR}")
+
+function(run_caprica description)
+  execute_process(COMMAND "${CAPRICA}" -g skyrim ${ARGN} RESULT_VARIABLE result)
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "${description} failed!")
+  endif()
+endfunction()
+
+function(compare_files description first second)
+  execute_process(COMMAND "${CMAKE_COMMAND}" -E compare_files "${first}" "${second}" RESULT_VARIABLE result)
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "${description} differ: ${first} ${second}")
+  endif()
+endfunction()
+
+set(flags --ignorecwd -f "${SCRIPTS_DIR}/TESV_Papyrus_Flags.flg")
+run_caprica("Compiling RoundTrip.psc" ${flags} "${SCRIPTS_DIR}/RoundTrip.psc" -o "${OUTPUT_DIR}/compiled")
+run_caprica("Disassembling the compiled file"
+            --disassemble-pex "${OUTPUT_DIR}/compiled/RoundTrip.pex" -o "${OUTPUT_DIR}/disassembled")
+run_caprica("Assembling the disassembly" ${flags} "${OUTPUT_DIR}/disassembled/RoundTrip.pas" -o "${OUTPUT_DIR}/assembled")
+run_caprica("Disassembling the assembled file"
+            --disassemble-pex "${OUTPUT_DIR}/assembled/RoundTrip.pex" -o "${OUTPUT_DIR}/redisassembled")
+run_caprica("Assembling the second disassembly"
+            ${flags} "${OUTPUT_DIR}/redisassembled/RoundTrip.pas" -o "${OUTPUT_DIR}/reassembled")
+
+file(SIZE "${OUTPUT_DIR}/compiled/RoundTrip.pex" compiledSize)
+file(SIZE "${OUTPUT_DIR}/assembled/RoundTrip.pex" assembledSize)
+if (NOT compiledSize EQUAL assembledSize)
+  message(FATAL_ERROR "The assembled file is ${assembledSize} bytes, but the compiled one is ${compiledSize}!")
+endif()
+compare_files("The disassemblies"
+              "${OUTPUT_DIR}/disassembled/RoundTrip.pas" "${OUTPUT_DIR}/redisassembled/RoundTrip.pas")
+compare_files("The assembled files" "${OUTPUT_DIR}/assembled/RoundTrip.pex" "${OUTPUT_DIR}/reassembled/RoundTrip.pex")